@@ -430,6 +430,17 @@ extern "C" {
 
 #ifndef STBI_NO_GIF
     STBIDEF stbi_uc* stbi_load_gif_from_memory(stbi_uc const* buffer, int len, int** delays, int* x, int* y, int* z, int* comp, int req_comp);
+
+    // Frame-at-a-time GIF decoding, for animations too long to hold every frame at once.
+    // Frames come out composited as RGBA, unflipped, and stay valid until the next call to
+    // stbi_gif_stream_next. The buffer must outlive the stream.
+    typedef struct stbi_gif_stream stbi_gif_stream;
+    STBIDEF stbi_gif_stream* stbi_gif_stream_open(stbi_uc const* buffer, int len, int* x, int* y);
+    // NULL after the last frame or on a decode error; delay_ms is the frame's display time
+    STBIDEF stbi_uc const* stbi_gif_stream_next(stbi_gif_stream* stream, int* delay_ms);
+    // back to the first frame, for looping
+    STBIDEF void stbi_gif_stream_rewind(stbi_gif_stream* stream);
+    STBIDEF void stbi_gif_stream_close(stbi_gif_stream* stream);
 #endif
 
 #ifdef STBI_WINDOWS_UTF8
@@ -523,6 +534,17 @@ extern "C" {
     STBIDEF void stbi_convert_iphone_png_to_rgb_thread(int flag_true_if_should_convert);
     STBIDEF void stbi_set_flip_vertically_on_load_thread(int flag_true_if_should_flip);
 
+    // decode JPEGs at 1/denom of their size (denom 1, 2, 4 or 8, like libjpeg's scale_denom)
+    // with a reduced IDCT, rather than decoding every pixel and downsampling afterwards.
+    // dimensions round up; stbi_info still reports the full size
+    STBIDEF void stbi_set_jpeg_scale_denom(int denom);
+    STBIDEF void stbi_set_jpeg_scale_denom_thread(int denom);
+
+    // caps the instruction set the JPEG IDCT, upsampling and colour conversion kernels may
+    // use: 0 = plain C, 1 = SSE2/NEON, 2 = AVX2 (the default, when the CPU has it). every
+    // level decodes to identical pixels; this exists to test and benchmark that
+    STBIDEF void stbi_set_jpeg_simd_limit(int level);
+
     // ZLIB client - used by PNG, available for other purposes
 
     STBIDEF char* stbi_zlib_decode_malloc_guesssize(const char* buffer, int len, int initial_size, int* outlen);
@@ -772,6 +794,44 @@ static int stbi__sse2_available(void)
 #endif
 #endif
 
+// AVX2 JPEG kernels are compiled for the whole file but only used when the CPU reports
+// AVX2 at runtime, so they need per-function targeting (GCC/Clang) or VC++ 2015+.
+// define STBI_NO_AVX2 to leave them out
+#if defined(STBI_SSE2) && !defined(STBI_NO_AVX2) && !defined(STBI_NO_JPEG) && \
+    ((defined(_MSC_VER) && _MSC_VER >= 1900) || defined(__GNUC__) || defined(__clang__))
+#define STBI_AVX2
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define STBI__AVX2_TARGET
+static int stbi__avx2_available(void)
+{
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return 0;
+    __cpuid(info, 1);
+    // AVX and OSXSAVE, and the OS saving YMM state
+    if ((info[2] & 0x18000000) != 0x18000000 || (_xgetbv(0) & 6) != 6) return 0;
+    __cpuidex(info, 7, 0);
+    return (info[1] >> 5) & 1;
+}
+#else
+#include <cpuid.h>
+#define STBI__AVX2_TARGET __attribute__((target("avx2")))
+static int stbi__avx2_available(void)
+{
+    unsigned int a, b, c, d, xcr0_lo, xcr0_hi;
+    if (__get_cpuid_max(0, 0) < 7) return 0;
+    __cpuid(1, a, b, c, d);
+    if ((c & 0x18000000) != 0x18000000) return 0;
+    __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0_lo & 6) != 6) return 0;
+    __cpuid_count(7, 0, a, b, c, d);
+    return (b >> 5) & 1;
+}
+#endif
+#endif
+
 // ARM NEON
 #if defined(STBI_NO_SIMD) && defined(STBI_NEON)
 #undef STBI_NEON
@@ -1930,6 +1990,35 @@ static stbi_uc* stbi__hdr_to_ldr(float* data, int x, int y, int comp)
 //      - some SIMD kernels for common paths on targets with SSE2/NEON
 //      - uses a lot of intermediate memory, could cache poorly
 
+static int stbi__jpeg_scale_denom_global = 1;
+static int stbi__jpeg_simd_limit = 2;
+
+STBIDEF void stbi_set_jpeg_simd_limit(int level)
+{
+    stbi__jpeg_simd_limit = level;
+}
+
+STBIDEF void stbi_set_jpeg_scale_denom(int denom)
+{
+    stbi__jpeg_scale_denom_global = denom;
+}
+
+#ifndef STBI_THREAD_LOCAL
+#define stbi__jpeg_scale_denom  stbi__jpeg_scale_denom_global
+#else
+static STBI_THREAD_LOCAL int stbi__jpeg_scale_denom_local, stbi__jpeg_scale_denom_set;
+
+STBIDEF void stbi_set_jpeg_scale_denom_thread(int denom)
+{
+    stbi__jpeg_scale_denom_local = denom;
+    stbi__jpeg_scale_denom_set = 1;
+}
+
+#define stbi__jpeg_scale_denom  (stbi__jpeg_scale_denom_set               \
+                                  ? stbi__jpeg_scale_denom_local          \
+                                  : stbi__jpeg_scale_denom_global)
+#endif // STBI_THREAD_LOCAL
+
 #ifndef STBI_NO_JPEG
 
 // huffman decoding acceleration
@@ -1958,6 +2047,7 @@ typedef struct
     int img_h_max, img_v_max;
     int img_mcu_x, img_mcu_y;
     int img_mcu_w, img_mcu_h;
+    int scale_shift; // log2 of the scale denominator, blocks come out (8 >> scale_shift) wide
 
     // definition of jpeg image component
     struct
@@ -2534,6 +2624,65 @@ static void stbi__idct_block(stbi_uc* out, int out_stride, short data[64])
     }
 }
 
+// reduced-size IDCTs for scaled decoding (see stbi_set_jpeg_scale_denom). an N-point
+// IDCT of the lowest NxN coefficients gives the block low-pass filtered and resampled
+// to NxN, the same approach as libjpeg's jidctred.c. rows of the table are output
+// positions k, columns frequencies u: C(u) * cos((2k+1) u pi / 2N)
+static const int stbi__idct_4x4_table[4][4] = {
+    { stbi__f2f(0.707106781f), stbi__f2f(0.923879533f), stbi__f2f(0.707106781f), stbi__f2f(0.382683432f) },
+    { stbi__f2f(0.707106781f), stbi__f2f(0.382683432f), stbi__f2f(-0.707106781f), stbi__f2f(-0.923879533f) },
+    { stbi__f2f(0.707106781f), stbi__f2f(-0.382683432f), stbi__f2f(-0.707106781f), stbi__f2f(0.923879533f) },
+    { stbi__f2f(0.707106781f), stbi__f2f(-0.923879533f), stbi__f2f(0.707106781f), stbi__f2f(-0.382683432f) }
+};
+
+static const int stbi__idct_2x2_table[2][2] = {
+    { stbi__f2f(0.707106781f), stbi__f2f(0.707106781f) },
+    { stbi__f2f(0.707106781f), stbi__f2f(-0.707106781f) }
+};
+
+stbi_inline static void stbi__idct_reduced(stbi_uc* out, int out_stride, short data[64], const int* table, int n)
+{
+    int i, k, u, val[16];
+    stbi_uc* o;
+
+    // columns: constants are 1<<12, drop to 2 extra bits of precision like stbi__idct_block
+    for (u = 0; u < n; ++u) {
+        for (k = 0; k < n; ++k) {
+            int sum = 512;
+            for (i = 0; i < n; ++i)
+                sum += table[k * n + i] * data[i * 8 + u];
+            val[k * n + u] = sum >> 10;
+        }
+    }
+
+    // rows: 1<<12 again plus the 1<<2 kept above, and the 1/4 of the 2D IDCT, so 1<<16
+    for (k = 0, o = out; k < n; ++k, o += out_stride) {
+        for (i = 0; i < n; ++i) {
+            int sum = 32768 + (128 << 16);
+            for (u = 0; u < n; ++u)
+                sum += table[i * n + u] * val[k * n + u];
+            o[i] = stbi__clamp(sum >> 16);
+        }
+    }
+}
+
+static void stbi__idct_block_4x4(stbi_uc* out, int out_stride, short data[64])
+{
+    stbi__idct_reduced(out, out_stride, data, &stbi__idct_4x4_table[0][0], 4);
+}
+
+static void stbi__idct_block_2x2(stbi_uc* out, int out_stride, short data[64])
+{
+    stbi__idct_reduced(out, out_stride, data, &stbi__idct_2x2_table[0][0], 2);
+}
+
+static void stbi__idct_block_1x1(stbi_uc* out, int out_stride, short data[64])
+{
+    STBI_NOTUSED(out_stride);
+    // the DC coefficient is 8x the block mean
+    out[0] = stbi__clamp(((data[0] + 4) >> 3) + 128);
+}
+
 #ifdef STBI_SSE2
 // sse2 integer IDCT. not the fastest possible implementation but it
 // produces bit-identical results to the generic C version so it's
@@ -2715,6 +2864,158 @@ static void stbi__idct_simd(stbi_uc* out, int out_stride, short data[64])
 
 #endif // STBI_SSE2
 
+#ifdef STBI_AVX2
+// AVX2 version of stbi__idct_simd: rows stay 16-bit in xmm registers, but the 32-bit
+// products for all 8 columns fit one ymm register, halving the multiply/add/shift work.
+// same arithmetic and saturation as the SSE2 version, so the output is identical.
+STBI__AVX2_TARGET static void stbi__idct_avx2(stbi_uc* out, int out_stride, short data[64])
+{
+    __m128i row0, row1, row2, row3, row4, row5, row6, row7;
+    __m128i tmp;
+
+#define dct_const(x,y)  _mm256_setr_epi16((x),(y),(x),(y),(x),(y),(x),(y),(x),(y),(x),(y),(x),(y),(x),(y))
+
+// out0 = c0[even]*x + c0[odd]*y, out1 likewise with c1 (x, y 16-bit, out 32-bit)
+#define dct_rot(out0,out1, x,y,c0,c1) \
+      __m256i c0##xy = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16((x),(y))), _mm_unpackhi_epi16((x),(y)), 1); \
+      __m256i out0 = _mm256_madd_epi16(c0##xy, c0); \
+      __m256i out1 = _mm256_madd_epi16(c0##xy, c1)
+
+   // out = in << 12  (in 16-bit, out 32-bit)
+#define dct_widen(out, in) \
+      __m256i out = _mm256_slli_epi32(_mm256_cvtepi16_epi32(in), 12)
+
+   // butterfly a/b, add bias, then shift by "s" and pack. packs works per 128-bit lane,
+   // the permute puts out0 in the low half and out1 in the high half
+#define dct_bfly32o(out0, out1, a,b,bias,s) \
+      { \
+         __m256i abiased = _mm256_add_epi32(a, bias); \
+         __m256i sum = _mm256_srai_epi32(_mm256_add_epi32(abiased, b), s); \
+         __m256i dif = _mm256_srai_epi32(_mm256_sub_epi32(abiased, b), s); \
+         __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(sum, dif), 0xd8); \
+         out0 = _mm256_castsi256_si128(packed); \
+         out1 = _mm256_extracti128_si256(packed, 1); \
+      }
+
+#define dct_interleave8(a, b) \
+      tmp = a; \
+      a = _mm_unpacklo_epi8(a, b); \
+      b = _mm_unpackhi_epi8(tmp, b)
+
+#define dct_interleave16(a, b) \
+      tmp = a; \
+      a = _mm_unpacklo_epi16(a, b); \
+      b = _mm_unpackhi_epi16(tmp, b)
+
+#define dct_pass(bias,shift) \
+      { \
+         /* even part */ \
+         dct_rot(t2e,t3e, row2,row6, rot0_0,rot0_1); \
+         __m128i sum04 = _mm_add_epi16(row0, row4); \
+         __m128i dif04 = _mm_sub_epi16(row0, row4); \
+         dct_widen(t0e, sum04); \
+         dct_widen(t1e, dif04); \
+         __m256i x0 = _mm256_add_epi32(t0e, t3e); \
+         __m256i x3 = _mm256_sub_epi32(t0e, t3e); \
+         __m256i x1 = _mm256_add_epi32(t1e, t2e); \
+         __m256i x2 = _mm256_sub_epi32(t1e, t2e); \
+         /* odd part */ \
+         dct_rot(y0o,y2o, row7,row3, rot2_0,rot2_1); \
+         dct_rot(y1o,y3o, row5,row1, rot3_0,rot3_1); \
+         __m128i sum17 = _mm_add_epi16(row1, row7); \
+         __m128i sum35 = _mm_add_epi16(row3, row5); \
+         dct_rot(y4o,y5o, sum17,sum35, rot1_0,rot1_1); \
+         __m256i x4 = _mm256_add_epi32(y0o, y4o); \
+         __m256i x5 = _mm256_add_epi32(y1o, y5o); \
+         __m256i x6 = _mm256_add_epi32(y2o, y5o); \
+         __m256i x7 = _mm256_add_epi32(y3o, y4o); \
+         dct_bfly32o(row0,row7, x0,x7,bias,shift); \
+         dct_bfly32o(row1,row6, x1,x6,bias,shift); \
+         dct_bfly32o(row2,row5, x2,x5,bias,shift); \
+         dct_bfly32o(row3,row4, x3,x4,bias,shift); \
+      }
+
+    __m256i rot0_0 = dct_const(stbi__f2f(0.5411961f), stbi__f2f(0.5411961f) + stbi__f2f(-1.847759065f));
+    __m256i rot0_1 = dct_const(stbi__f2f(0.5411961f) + stbi__f2f(0.765366865f), stbi__f2f(0.5411961f));
+    __m256i rot1_0 = dct_const(stbi__f2f(1.175875602f) + stbi__f2f(-0.899976223f), stbi__f2f(1.175875602f));
+    __m256i rot1_1 = dct_const(stbi__f2f(1.175875602f), stbi__f2f(1.175875602f) + stbi__f2f(-2.562915447f));
+    __m256i rot2_0 = dct_const(stbi__f2f(-1.961570560f) + stbi__f2f(0.298631336f), stbi__f2f(-1.961570560f));
+    __m256i rot2_1 = dct_const(stbi__f2f(-1.961570560f), stbi__f2f(-1.961570560f) + stbi__f2f(3.072711026f));
+    __m256i rot3_0 = dct_const(stbi__f2f(-0.390180644f) + stbi__f2f(2.053119869f), stbi__f2f(-0.390180644f));
+    __m256i rot3_1 = dct_const(stbi__f2f(-0.390180644f), stbi__f2f(-0.390180644f) + stbi__f2f(1.501321110f));
+
+    __m256i bias_0 = _mm256_set1_epi32(512);
+    __m256i bias_1 = _mm256_set1_epi32(65536 + (128 << 17));
+
+    row0 = _mm_load_si128((const __m128i*) (data + 0 * 8));
+    row1 = _mm_load_si128((const __m128i*) (data + 1 * 8));
+    row2 = _mm_load_si128((const __m128i*) (data + 2 * 8));
+    row3 = _mm_load_si128((const __m128i*) (data + 3 * 8));
+    row4 = _mm_load_si128((const __m128i*) (data + 4 * 8));
+    row5 = _mm_load_si128((const __m128i*) (data + 5 * 8));
+    row6 = _mm_load_si128((const __m128i*) (data + 6 * 8));
+    row7 = _mm_load_si128((const __m128i*) (data + 7 * 8));
+
+    // column pass
+    dct_pass(bias_0, 10);
+
+    {
+        // 16bit 8x8 transpose
+        dct_interleave16(row0, row4);
+        dct_interleave16(row1, row5);
+        dct_interleave16(row2, row6);
+        dct_interleave16(row3, row7);
+
+        dct_interleave16(row0, row2);
+        dct_interleave16(row1, row3);
+        dct_interleave16(row4, row6);
+        dct_interleave16(row5, row7);
+
+        dct_interleave16(row0, row1);
+        dct_interleave16(row2, row3);
+        dct_interleave16(row4, row5);
+        dct_interleave16(row6, row7);
+    }
+
+    // row pass
+    dct_pass(bias_1, 17);
+
+    {
+        // pack, then 8bit 8x8 transpose
+        __m128i p0 = _mm_packus_epi16(row0, row1);
+        __m128i p1 = _mm_packus_epi16(row2, row3);
+        __m128i p2 = _mm_packus_epi16(row4, row5);
+        __m128i p3 = _mm_packus_epi16(row6, row7);
+
+        dct_interleave8(p0, p2);
+        dct_interleave8(p1, p3);
+
+        dct_interleave8(p0, p1);
+        dct_interleave8(p2, p3);
+
+        dct_interleave8(p0, p2);
+        dct_interleave8(p1, p3);
+
+        _mm_storel_epi64((__m128i*) out, p0); out += out_stride;
+        _mm_storel_epi64((__m128i*) out, _mm_shuffle_epi32(p0, 0x4e)); out += out_stride;
+        _mm_storel_epi64((__m128i*) out, p2); out += out_stride;
+        _mm_storel_epi64((__m128i*) out, _mm_shuffle_epi32(p2, 0x4e)); out += out_stride;
+        _mm_storel_epi64((__m128i*) out, p1); out += out_stride;
+        _mm_storel_epi64((__m128i*) out, _mm_shuffle_epi32(p1, 0x4e)); out += out_stride;
+        _mm_storel_epi64((__m128i*) out, p3); out += out_stride;
+        _mm_storel_epi64((__m128i*) out, _mm_shuffle_epi32(p3, 0x4e));
+    }
+
+#undef dct_const
+#undef dct_rot
+#undef dct_widen
+#undef dct_bfly32o
+#undef dct_interleave8
+#undef dct_interleave16
+#undef dct_pass
+}
+#endif // STBI_AVX2
+
 #ifdef STBI_NEON
 
 // NEON integer IDCT. should produce bit-identical
@@ -2975,7 +3276,7 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg* z)
                 for (i = 0; i < w; ++i) {
                     int ha = z->img_comp[n].ha;
                     if (!stbi__jpeg_decode_block(z, data, z->huff_dc + z->img_comp[n].hd, z->huff_ac + ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
-                    z->idct_block_kernel(z->img_comp[n].data + z->img_comp[n].w2 * j * 8 + i * 8, z->img_comp[n].w2, data);
+                    z->idct_block_kernel(z->img_comp[n].data + ((z->img_comp[n].w2 * j + i) << (3 - z->scale_shift)), z->img_comp[n].w2, data);
                     // every data block is an MCU, so countdown the restart interval
                     if (--z->todo <= 0) {
                         if (z->code_bits < 24) stbi__grow_buffer_unsafe(z);
@@ -3000,8 +3301,8 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg* z)
                         // by the basic H and V specified for the component
                         for (y = 0; y < z->img_comp[n].v; ++y) {
                             for (x = 0; x < z->img_comp[n].h; ++x) {
-                                int x2 = (i * z->img_comp[n].h + x) * 8;
-                                int y2 = (j * z->img_comp[n].v + y) * 8;
+                                int x2 = (i * z->img_comp[n].h + x) << (3 - z->scale_shift);
+                                int y2 = (j * z->img_comp[n].v + y) << (3 - z->scale_shift);
                                 int ha = z->img_comp[n].ha;
                                 if (!stbi__jpeg_decode_block(z, data, z->huff_dc + z->img_comp[n].hd, z->huff_ac + ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
                                 z->idct_block_kernel(z->img_comp[n].data + z->img_comp[n].w2 * y2 + x2, z->img_comp[n].w2, data);
@@ -3104,7 +3405,7 @@ static void stbi__jpeg_finish(stbi__jpeg* z)
                 for (i = 0; i < w; ++i) {
                     short* data = z->img_comp[n].coeff + 64 * (i + j * z->img_comp[n].coeff_w);
                     stbi__jpeg_dequantize(data, z->dequant[z->img_comp[n].tq]);
-                    z->idct_block_kernel(z->img_comp[n].data + z->img_comp[n].w2 * j * 8 + i * 8, z->img_comp[n].w2, data);
+                    z->idct_block_kernel(z->img_comp[n].data + ((z->img_comp[n].w2 * j + i) << (3 - z->scale_shift)), z->img_comp[n].w2, data);
                 }
             }
         }
@@ -3347,8 +3648,8 @@ static int stbi__process_frame_header(stbi__jpeg* z, int scan)
         //
         // img_mcu_x, img_mcu_y: <=17 bits; comp[i].h and .v are <=4 (checked earlier)
         // so these muls can't overflow with 32-bit ints (which we require)
-        z->img_comp[i].w2 = z->img_mcu_x * z->img_comp[i].h * 8;
-        z->img_comp[i].h2 = z->img_mcu_y * z->img_comp[i].v * 8;
+        z->img_comp[i].w2 = (z->img_mcu_x * z->img_comp[i].h * 8) >> z->scale_shift;
+        z->img_comp[i].h2 = (z->img_mcu_y * z->img_comp[i].v * 8) >> z->scale_shift;
         z->img_comp[i].coeff = 0;
         z->img_comp[i].raw_coeff = 0;
         z->img_comp[i].linebuf = NULL;
@@ -3358,10 +3659,10 @@ static int stbi__process_frame_header(stbi__jpeg* z, int scan)
         // align blocks for idct using mmx/sse
         z->img_comp[i].data = (stbi_uc*)(((size_t)z->img_comp[i].raw_data + 15) & ~15);
         if (z->progressive) {
-            // w2, h2 are multiples of 8 (see above)
-            z->img_comp[i].coeff_w = z->img_comp[i].w2 / 8;
-            z->img_comp[i].coeff_h = z->img_comp[i].h2 / 8;
-            z->img_comp[i].raw_coeff = stbi__malloc_mad3(z->img_comp[i].w2, z->img_comp[i].h2, sizeof(short), 15);
+            // one 8x8 block of coefficients per block, whatever size it decodes to
+            z->img_comp[i].coeff_w = z->img_mcu_x * z->img_comp[i].h;
+            z->img_comp[i].coeff_h = z->img_mcu_y * z->img_comp[i].v;
+            z->img_comp[i].raw_coeff = stbi__malloc_mad3(z->img_comp[i].coeff_w * 8, z->img_comp[i].coeff_h * 8, sizeof(short), 15);
             if (z->img_comp[i].raw_coeff == NULL)
                 return stbi__free_jpeg_components(z, i + 1, stbi__err("outofmem", "Out of memory"));
             z->img_comp[i].coeff = (short*)(((size_t)z->img_comp[i].raw_coeff + 15) & ~15);
@@ -3663,6 +3964,62 @@ static stbi_uc* stbi__resample_row_hv_2_simd(stbi_uc* out, stbi_uc* in_near, stb
 }
 #endif
 
+#ifdef STBI_AVX2
+// stbi__resample_row_hv_2_simd 16 pixels at a time
+STBI__AVX2_TARGET static stbi_uc* stbi__resample_row_hv_2_avx2(stbi_uc* out, stbi_uc* in_near, stbi_uc* in_far, int w, int hs)
+{
+    int i = 0, t0, t1;
+
+    if (w == 1) {
+        out[0] = out[1] = stbi__div4(3 * in_near[0] + in_far[0] + 2);
+        return out;
+    }
+
+    t1 = 3 * in_near[0] + in_far[0];
+    for (; i < ((w - 1) & ~15); i += 16) {
+        // vertical pass, 3*near + far = 4*near + (far - near)
+        __m256i farw = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*) (in_far + i)));
+        __m256i nearw = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*) (in_near + i)));
+        __m256i curr = _mm256_add_epi16(_mm256_slli_epi16(nearw, 2), _mm256_sub_epi16(farw, nearw));
+
+        // shift the row a pixel each way across the 128-bit lanes, filling in the
+        // neighbours of the first and last pixel
+        __m256i prv0 = _mm256_alignr_epi8(curr, _mm256_permute2x128_si256(curr, curr, 0x08), 14);
+        __m256i nxt0 = _mm256_alignr_epi8(_mm256_permute2x128_si256(curr, curr, 0x81), curr, 2);
+        __m256i prev = _mm256_insert_epi16(prv0, t1, 0);
+        __m256i next = _mm256_insert_epi16(nxt0, 3 * in_near[i + 16] + in_far[i + 16], 15);
+
+        // even pixels = 4*cur + (prev - cur), odd pixels = 4*cur + (next - cur)
+        __m256i curb = _mm256_add_epi16(_mm256_slli_epi16(curr, 2), _mm256_set1_epi16(8));
+        __m256i even = _mm256_add_epi16(_mm256_sub_epi16(prev, curr), curb);
+        __m256i odd = _mm256_add_epi16(_mm256_sub_epi16(next, curr), curb);
+
+        // interleave within each lane, which keeps the output in order after the pack
+        __m256i de0 = _mm256_srli_epi16(_mm256_unpacklo_epi16(even, odd), 4);
+        __m256i de1 = _mm256_srli_epi16(_mm256_unpackhi_epi16(even, odd), 4);
+        _mm256_storeu_si256((__m256i*) (out + i * 2), _mm256_packus_epi16(de0, de1));
+
+        t1 = 3 * in_near[i + 15] + in_far[i + 15];
+    }
+
+    t0 = t1;
+    t1 = 3 * in_near[i] + in_far[i];
+    out[i * 2] = stbi__div16(3 * t1 + t0 + 8);
+
+    for (++i; i < w; ++i) {
+        t0 = t1;
+        t1 = 3 * in_near[i] + in_far[i];
+        out[i * 2 - 1] = stbi__div16(3 * t0 + t1 + 8);
+        out[i * 2] = stbi__div16(3 * t1 + t0 + 8);
+    }
+    out[w * 2 - 1] = stbi__div4(t1 + 2);
+
+    STBI_NOTUSED(hs);
+
+    return out;
+}
+#endif
+
 static stbi_uc* stbi__resample_row_generic(stbi_uc* out, stbi_uc* in_near, stbi_uc* in_far, int w, int hs)
 {
     // resample with nearest-neighbor
@@ -3837,12 +4194,66 @@ static void stbi__YCbCr_to_RGB_simd(stbi_uc* out, stbi_uc const* y, stbi_uc cons
 }
 #endif
 
+#ifdef STBI_AVX2
+// stbi__YCbCr_to_RGB_simd 16 pixels at a time, the rest go through the SSE2 version
+STBI__AVX2_TARGET static void stbi__YCbCr_to_RGB_avx2(stbi_uc* out, stbi_uc const* y, stbi_uc const* pcb, stbi_uc const* pcr, int count, int step)
+{
+    int i = 0;
+    if (step == 4) {
+        __m128i signflip = _mm_set1_epi8(-0x80);
+        __m256i cr_const0 = _mm256_set1_epi16((short)(1.40200f * 4096.0f + 0.5f));
+        __m256i cr_const1 = _mm256_set1_epi16(-(short)(0.71414f * 4096.0f + 0.5f));
+        __m256i cb_const0 = _mm256_set1_epi16(-(short)(0.34414f * 4096.0f + 0.5f));
+        __m256i cb_const1 = _mm256_set1_epi16((short)(1.77200f * 4096.0f + 0.5f));
+        __m256i y_bias = _mm256_set1_epi16(128);
+        __m256i xw = _mm256_set1_epi16(255); // alpha channel
+
+        for (; i + 15 < count; i += 16) {
+            // widen to the same 16-bit values the SSE2 unpacks produce: y << 8 | 128, and
+            // (cr - 128) << 8, (cb - 128) << 8
+            __m128i y_bytes = _mm_loadu_si128((__m128i*) (y + i));
+            __m128i cr_biased = _mm_xor_si128(_mm_loadu_si128((__m128i*) (pcr + i)), signflip);
+            __m128i cb_biased = _mm_xor_si128(_mm_loadu_si128((__m128i*) (pcb + i)), signflip);
+            __m256i yw = _mm256_or_si256(_mm256_slli_epi16(_mm256_cvtepu8_epi16(y_bytes), 8), y_bias);
+            __m256i crw = _mm256_slli_epi16(_mm256_cvtepi8_epi16(cr_biased), 8);
+            __m256i cbw = _mm256_slli_epi16(_mm256_cvtepi8_epi16(cb_biased), 8);
+
+            // color transform
+            __m256i yws = _mm256_srli_epi16(yw, 4);
+            __m256i cr0 = _mm256_mulhi_epi16(cr_const0, crw);
+            __m256i cb0 = _mm256_mulhi_epi16(cb_const0, cbw);
+            __m256i cb1 = _mm256_mulhi_epi16(cbw, cb_const1);
+            __m256i cr1 = _mm256_mulhi_epi16(crw, cr_const1);
+            __m256i rw = _mm256_srai_epi16(_mm256_add_epi16(cr0, yws), 4);
+            __m256i gw = _mm256_srai_epi16(_mm256_add_epi16(_mm256_add_epi16(cb0, yws), cr1), 4);
+            __m256i bw = _mm256_srai_epi16(_mm256_add_epi16(yws, cb1), 4);
+
+            // back to bytes and interleave; each 128-bit lane ends up holding pixels
+            // 0-3 and 8-11, or 4-7 and 12-15
+            __m256i brb = _mm256_packus_epi16(rw, bw);
+            __m256i gxb = _mm256_packus_epi16(gw, xw);
+            __m256i t0 = _mm256_unpacklo_epi8(brb, gxb);
+            __m256i t1 = _mm256_unpackhi_epi8(brb, gxb);
+            __m256i o0 = _mm256_unpacklo_epi16(t0, t1);
+            __m256i o1 = _mm256_unpackhi_epi16(t0, t1);
+
+            _mm256_storeu_si256((__m256i*) (out + 0), _mm256_permute2x128_si256(o0, o1, 0x20));
+            _mm256_storeu_si256((__m256i*) (out + 32), _mm256_permute2x128_si256(o0, o1, 0x31));
+            out += 64;
+        }
+    }
+    stbi__YCbCr_to_RGB_simd(out, y + i, pcb + i, pcr + i, count - i, step);
+}
+#endif
+
 // set up the kernels
 static void stbi__setup_jpeg(stbi__jpeg* j)
 {
     j->idct_block_kernel = stbi__idct_block;
     j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_row;
     j->resample_row_hv_2_kernel = stbi__resample_row_hv_2;
+    if (stbi__jpeg_simd_limit < 1)
+        return;
 
 #ifdef STBI_SSE2
     if (stbi__sse2_available()) {
@@ -3852,6 +4263,14 @@ static void stbi__setup_jpeg(stbi__jpeg* j)
     }
 #endif
 
+#ifdef STBI_AVX2
+    if (stbi__jpeg_simd_limit >= 2 && stbi__avx2_available()) {
+        j->idct_block_kernel = stbi__idct_avx2;
+        j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_avx2;
+        j->resample_row_hv_2_kernel = stbi__resample_row_hv_2_avx2;
+    }
+#endif
+
 #ifdef STBI_NEON
     j->idct_block_kernel = stbi__idct_simd;
     j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_simd;
@@ -3865,6 +4284,19 @@ static void stbi__cleanup_jpeg(stbi__jpeg* j)
     stbi__free_jpeg_components(j, j->s->img_n, 0);
 }
 
+// block counts come from the full-size dimensions while decoding, everything after that
+// works on the planes the reduced IDCT filled
+static void stbi__jpeg_scale_output(stbi__jpeg* z)
+{
+    int i, round = (1 << z->scale_shift) - 1;
+    z->s->img_x = (z->s->img_x + round) >> z->scale_shift;
+    z->s->img_y = (z->s->img_y + round) >> z->scale_shift;
+    for (i = 0; i < z->s->img_n; ++i) {
+        z->img_comp[i].x = (z->s->img_x * z->img_comp[i].h + z->img_h_max - 1) / z->img_h_max;
+        z->img_comp[i].y = (z->s->img_y * z->img_comp[i].v + z->img_v_max - 1) / z->img_v_max;
+    }
+}
+
 typedef struct
 {
     resample_row_func resample;
@@ -3892,6 +4324,7 @@ static stbi_uc* load_jpeg_image(stbi__jpeg* z, int* out_x, int* out_y, int* comp
 
     // load a jpeg image from whichever source, but leave in YCbCr format
     if (!stbi__decode_jpeg_image(z)) { stbi__cleanup_jpeg(z); return NULL; }
+    if (z->scale_shift) stbi__jpeg_scale_output(z);
 
     // determine actual number of components to generate
     n = req_comp ? req_comp : z->s->img_n >= 3 ? 3 : 1;
@@ -4063,6 +4496,12 @@ static void* stbi__jpeg_load(stbi__context* s, int* x, int* y, int* comp, int re
     STBI_NOTUSED(ri);
     j->s = s;
     stbi__setup_jpeg(j);
+    switch (stbi__jpeg_scale_denom) {
+    case 2: j->scale_shift = 1; j->idct_block_kernel = stbi__idct_block_4x4; break;
+    case 4: j->scale_shift = 2; j->idct_block_kernel = stbi__idct_block_2x2; break;
+    case 8: j->scale_shift = 3; j->idct_block_kernel = stbi__idct_block_1x1; break;
+    default: break;
+    }
     result = load_jpeg_image(j, x, y, comp, req_comp);
     STBI_FREE(j);
     return result;
@@ -7150,6 +7589,89 @@ static void* stbi__load_gif_main(stbi__context* s, int** delays, int* x, int* y,
     }
 }
 
+struct stbi_gif_stream
+{
+    stbi__context s;
+    stbi__gif g;
+    stbi_uc const* buffer;
+    int len;
+    int frame;
+    stbi_uc* previous[2]; // the last two frames, "restore to previous" disposal reads the older
+};
+
+STBIDEF void stbi_gif_stream_rewind(stbi_gif_stream* stream)
+{
+    STBI_FREE(stream->g.out);
+    STBI_FREE(stream->g.history);
+    STBI_FREE(stream->g.background);
+    memset(&stream->g, 0, sizeof(stream->g));
+    stream->frame = 0;
+    stbi__start_mem(&stream->s, stream->buffer, stream->len);
+}
+
+STBIDEF stbi_gif_stream* stbi_gif_stream_open(stbi_uc const* buffer, int len, int* x, int* y)
+{
+    stbi_gif_stream* stream;
+    stbi__context s;
+    int w, h, comp;
+
+    stbi__start_mem(&s, buffer, len);
+    if (!stbi__gif_info(&s, &w, &h, &comp)) {
+        stbi__err("not GIF", "Image was not as a gif type.");
+        return NULL;
+    }
+    if (!stbi__mad3sizes_valid(4, w, h, 0)) {
+        stbi__err("too large", "GIF image is too large");
+        return NULL;
+    }
+
+    stream = (stbi_gif_stream*)stbi__malloc(sizeof(stbi_gif_stream));
+    if (!stream) {
+        stbi__err("outofmem", "Out of memory");
+        return NULL;
+    }
+    memset(stream, 0, sizeof(*stream));
+    stream->buffer = buffer;
+    stream->len = len;
+    stream->previous[0] = (stbi_uc*)stbi__malloc(4 * w * h);
+    stream->previous[1] = (stbi_uc*)stbi__malloc(4 * w * h);
+    if (!stream->previous[0] || !stream->previous[1]) {
+        stbi_gif_stream_close(stream);
+        stbi__err("outofmem", "Out of memory");
+        return NULL;
+    }
+    stbi_gif_stream_rewind(stream);
+    if (x) *x = w;
+    if (y) *y = h;
+    return stream;
+}
+
+STBIDEF stbi_uc const* stbi_gif_stream_next(stbi_gif_stream* stream, int* delay_ms)
+{
+    int comp;
+    stbi_uc* slot = stream->previous[stream->frame & 1];
+    stbi_uc* u = stbi__gif_load_next(&stream->s, &stream->g, &comp, 4, stream->frame >= 2 ? slot : 0);
+    if (u == 0 || u == (stbi_uc*)&stream->s)
+        return NULL;
+
+    // the slot held frame n-2, which this frame no longer needs
+    memcpy(slot, u, (size_t)4 * stream->g.w * stream->g.h);
+    ++stream->frame;
+    if (delay_ms) *delay_ms = stream->g.delay;
+    return slot;
+}
+
+STBIDEF void stbi_gif_stream_close(stbi_gif_stream* stream)
+{
+    if (!stream) return;
+    STBI_FREE(stream->g.out);
+    STBI_FREE(stream->g.history);
+    STBI_FREE(stream->g.background);
+    STBI_FREE(stream->previous[0]);
+    STBI_FREE(stream->previous[1]);
+    STBI_FREE(stream);
+}
+
 static void* stbi__gif_load(stbi__context* s, int* x, int* y, int* comp, int req_comp, stbi__result_info* ri)
 {
     stbi_uc* u = 0;
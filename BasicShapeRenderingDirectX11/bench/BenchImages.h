@@ -0,0 +1,612 @@
+#pragma once
+// Synthetic test images and minimal encoders for the decode benchmarks. The repo only
+// vendors the stb_image decoder, so JPEG (baseline, 4:2:0), PNG (fixed-Huffman deflate)
+// and Radiance HDR (RLE) files of any size are produced here instead of being checked in.
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Photo-like RGB: smooth gradients, some texture, hard edges and a little noise
+inline std::vector<unsigned char> MakePhotoRGB(int width, int height, unsigned int seed = 12345)
+{
+    std::vector<unsigned char> rgb((size_t)width * height * 3);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float u = (float)x / width;
+            float v = (float)y / height;
+            float wave = std::sin(u * 23.0f + std::sin(v * 7.0f) * 3.0f) * 0.5f + 0.5f;
+            bool tile = ((x / 64) + (y / 48)) % 3 == 0;
+            seed = seed * 1664525u + 1013904223u;
+            float noise = (float)(seed >> 24) / 255.0f - 0.5f;
+            float r = 0.6f * u + 0.3f * wave + (tile ? 0.2f : 0.0f) + 0.04f * noise;
+            float g = 0.5f * v + 0.4f * wave * u + 0.03f * noise;
+            float b = 0.8f - 0.5f * u * v + (tile ? -0.3f : 0.1f) + 0.05f * noise;
+            unsigned char* p = &rgb[((size_t)y * width + x) * 3];
+            p[0] = (unsigned char)std::min(255.0f, std::max(0.0f, r * 255.0f));
+            p[1] = (unsigned char)std::min(255.0f, std::max(0.0f, g * 255.0f));
+            p[2] = (unsigned char)std::min(255.0f, std::max(0.0f, b * 255.0f));
+        }
+    }
+    return rgb;
+}
+
+class ByteWriter
+{
+public:
+    std::vector<unsigned char> bytes;
+
+    void Byte(unsigned int b) { bytes.push_back((unsigned char)b); }
+    void Word(unsigned int w) { Byte(w >> 8); Byte(w); }
+    void Dword(uint32_t d) { Word(d >> 16); Word(d & 0xFFFF); }
+    void Append(const void* data, size_t size)
+    {
+        const unsigned char* p = (const unsigned char*)data;
+        bytes.insert(bytes.end(), p, p + size);
+    }
+};
+
+// ---- JPEG ------------------------------------------------------------------------------
+
+namespace jpeg {
+
+const unsigned char kZigzag[64] = {
+    0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+const unsigned char kLumaQuant[64] = {
+    16, 11, 10, 16, 24, 40, 51, 61, 12, 12, 14, 19, 26, 58, 60, 55,
+    14, 13, 16, 24, 40, 57, 69, 56, 14, 17, 22, 29, 51, 87, 80, 62,
+    18, 22, 37, 56, 68, 109, 103, 77, 24, 35, 55, 64, 81, 104, 113, 92,
+    49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99
+};
+
+const unsigned char kChromaQuant[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99, 47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99
+};
+
+// Annex K Huffman tables: code counts per length, then symbols
+const unsigned char kDcLumaBits[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+const unsigned char kDcChromaBits[16] = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+const unsigned char kDcValues[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+const unsigned char kAcLumaBits[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d };
+const unsigned char kAcLumaValues[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+const unsigned char kAcChromaBits[16] = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+const unsigned char kAcChromaValues[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+struct HuffmanTable
+{
+    unsigned short code[256];
+    unsigned char length[256];
+
+    HuffmanTable(const unsigned char bits[16], const unsigned char* values)
+    {
+        std::memset(length, 0, sizeof(length));
+        unsigned int next = 0;
+        int k = 0;
+        for (int len = 1; len <= 16; ++len) {
+            for (int i = 0; i < bits[len - 1]; ++i, ++k) {
+                code[values[k]] = (unsigned short)next++;
+                length[values[k]] = (unsigned char)len;
+            }
+            next <<= 1;
+        }
+    }
+};
+
+class BitWriter
+{
+public:
+    explicit BitWriter(ByteWriter& out) : mOut(out) {}
+
+    void Put(unsigned int bits, int count)
+    {
+        mBuffer = (mBuffer << count) | (bits & ((1u << count) - 1));
+        mCount += count;
+        while (mCount >= 8) {
+            unsigned int byte = (mBuffer >> (mCount - 8)) & 0xFF;
+            mOut.Byte(byte);
+            if (byte == 0xFF)
+                mOut.Byte(0);
+            mCount -= 8;
+        }
+        mBuffer &= (1u << mCount) - 1;
+    }
+
+    void Flush()
+    {
+        if (mCount > 0)
+            Put(0x7F, 8 - mCount);
+    }
+
+private:
+    ByteWriter& mOut;
+    uint32_t mBuffer = 0;
+    int mCount = 0;
+};
+
+inline void WriteSegmentHuffman(ByteWriter& out, int tableClass, const unsigned char bits[16], const unsigned char* values)
+{
+    int count = 0;
+    for (int i = 0; i < 16; ++i)
+        count += bits[i];
+    out.Byte(tableClass);
+    out.Append(bits, 16);
+    out.Append(values, count);
+}
+
+class Encoder
+{
+public:
+    Encoder(int quality)
+        : mDcLuma(kDcLumaBits, kDcValues), mDcChroma(kDcChromaBits, kDcValues),
+          mAcLuma(kAcLumaBits, kAcLumaValues), mAcChroma(kAcChromaBits, kAcChromaValues)
+    {
+        quality = std::min(100, std::max(1, quality));
+        int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+        for (int i = 0; i < 64; ++i) {
+            mLumaQuant[i] = (unsigned char)std::min(255, std::max(1, (kLumaQuant[i] * scale + 50) / 100));
+            mChromaQuant[i] = (unsigned char)std::min(255, std::max(1, (kChromaQuant[i] * scale + 50) / 100));
+        }
+        const float pi = 3.14159265358979f;
+        for (int u = 0; u < 8; ++u) {
+            for (int x = 0; x < 8; ++x)
+                mCos[u][x] = (u == 0 ? std::sqrt(0.125f) : 0.5f) * std::cos((2 * x + 1) * u * pi / 16.0f);
+        }
+    }
+
+    std::vector<unsigned char> Encode(const unsigned char* rgb, int width, int height)
+    {
+        ByteWriter out;
+        out.Word(0xFFD8);
+
+        out.Word(0xFFE0);
+        out.Word(16);
+        out.Append("JFIF", 5);
+        out.Byte(1); out.Byte(1); out.Byte(0);
+        out.Word(1); out.Word(1);
+        out.Byte(0); out.Byte(0);
+
+        out.Word(0xFFDB);
+        out.Word(2 + 2 * 65);
+        out.Byte(0);
+        for (int i = 0; i < 64; ++i)
+            out.Byte(mLumaQuant[kZigzag[i]]);
+        out.Byte(1);
+        for (int i = 0; i < 64; ++i)
+            out.Byte(mChromaQuant[kZigzag[i]]);
+
+        // Y sampled 2x2, Cb and Cr once per 16x16 MCU
+        out.Word(0xFFC0);
+        out.Word(17);
+        out.Byte(8);
+        out.Word(height);
+        out.Word(width);
+        out.Byte(3);
+        out.Byte(1); out.Byte(0x22); out.Byte(0);
+        out.Byte(2); out.Byte(0x11); out.Byte(1);
+        out.Byte(3); out.Byte(0x11); out.Byte(1);
+
+        out.Word(0xFFC4);
+        out.Word(2 + (1 + 16 + 12) * 2 + (1 + 16 + 162) * 2);
+        WriteSegmentHuffman(out, 0x00, kDcLumaBits, kDcValues);
+        WriteSegmentHuffman(out, 0x10, kAcLumaBits, kAcLumaValues);
+        WriteSegmentHuffman(out, 0x01, kDcChromaBits, kDcValues);
+        WriteSegmentHuffman(out, 0x11, kAcChromaBits, kAcChromaValues);
+
+        out.Word(0xFFDA);
+        out.Word(12);
+        out.Byte(3);
+        out.Byte(1); out.Byte(0x00);
+        out.Byte(2); out.Byte(0x11);
+        out.Byte(3); out.Byte(0x11);
+        out.Byte(0); out.Byte(63); out.Byte(0);
+
+        BitWriter bits(out);
+        int dc[3] = { 0, 0, 0 };
+        float y[4][64], cb[64], cr[64];
+        for (int my = 0; my < height; my += 16) {
+            for (int mx = 0; mx < width; mx += 16) {
+                std::memset(cb, 0, sizeof(cb));
+                std::memset(cr, 0, sizeof(cr));
+                for (int py = 0; py < 16; ++py) {
+                    for (int px = 0; px < 16; ++px) {
+                        int sx = std::min(mx + px, width - 1);
+                        int sy = std::min(my + py, height - 1);
+                        const unsigned char* p = rgb + ((size_t)sy * width + sx) * 3;
+                        float r = p[0], g = p[1], b = p[2];
+                        y[(py / 8) * 2 + px / 8][(py % 8) * 8 + px % 8] = 0.299f * r + 0.587f * g + 0.114f * b - 128.0f;
+                        cb[(py / 2) * 8 + px / 2] += 0.25f * (-0.168736f * r - 0.331264f * g + 0.5f * b);
+                        cr[(py / 2) * 8 + px / 2] += 0.25f * (0.5f * r - 0.418688f * g - 0.081312f * b);
+                    }
+                }
+                for (int i = 0; i < 4; ++i)
+                    EncodeBlock(bits, y[i], mLumaQuant, dc[0], mDcLuma, mAcLuma);
+                EncodeBlock(bits, cb, mChromaQuant, dc[1], mDcChroma, mAcChroma);
+                EncodeBlock(bits, cr, mChromaQuant, dc[2], mDcChroma, mAcChroma);
+            }
+        }
+        bits.Flush();
+        out.Word(0xFFD9);
+        return out.bytes;
+    }
+
+private:
+    static int Category(int value)
+    {
+        int magnitude = value < 0 ? -value : value;
+        int bits = 0;
+        while (magnitude) {
+            ++bits;
+            magnitude >>= 1;
+        }
+        return bits;
+    }
+
+    static void PutValue(BitWriter& bits, int value, int category)
+    {
+        if (category)
+            bits.Put(value < 0 ? value - 1 : value, category);
+    }
+
+    void EncodeBlock(BitWriter& bits, const float* block, const unsigned char* quant, int& previousDc, const HuffmanTable& dcTable, const HuffmanTable& acTable)
+    {
+        float rows[64], coefficients[64];
+        for (int y = 0; y < 8; ++y) {
+            for (int u = 0; u < 8; ++u) {
+                float sum = 0.0f;
+                for (int x = 0; x < 8; ++x)
+                    sum += mCos[u][x] * block[y * 8 + x];
+                rows[y * 8 + u] = sum;
+            }
+        }
+        for (int v = 0; v < 8; ++v) {
+            for (int u = 0; u < 8; ++u) {
+                float sum = 0.0f;
+                for (int y = 0; y < 8; ++y)
+                    sum += mCos[v][y] * rows[y * 8 + u];
+                coefficients[v * 8 + u] = sum;
+            }
+        }
+
+        int quantized[64];
+        for (int i = 0; i < 64; ++i) {
+            int natural = kZigzag[i];
+            quantized[i] = (int)std::lround(coefficients[natural] / quant[natural]);
+        }
+
+        int diff = quantized[0] - previousDc;
+        previousDc = quantized[0];
+        int category = Category(diff);
+        bits.Put(dcTable.code[category], dcTable.length[category]);
+        PutValue(bits, diff, category);
+
+        int run = 0;
+        for (int i = 1; i < 64; ++i) {
+            if (quantized[i] == 0) {
+                ++run;
+                continue;
+            }
+            while (run >= 16) {
+                bits.Put(acTable.code[0xF0], acTable.length[0xF0]);
+                run -= 16;
+            }
+            category = Category(quantized[i]);
+            int symbol = (run << 4) | category;
+            bits.Put(acTable.code[symbol], acTable.length[symbol]);
+            PutValue(bits, quantized[i], category);
+            run = 0;
+        }
+        if (run > 0)
+            bits.Put(acTable.code[0x00], acTable.length[0x00]);
+    }
+
+private:
+    HuffmanTable mDcLuma, mDcChroma, mAcLuma, mAcChroma;
+    unsigned char mLumaQuant[64];
+    unsigned char mChromaQuant[64];
+    float mCos[8][8];
+};
+
+} // namespace jpeg
+
+inline std::vector<unsigned char> EncodeJpeg(const unsigned char* rgb, int width, int height, int quality = 90)
+{
+    jpeg::Encoder encoder(quality);
+    return encoder.Encode(rgb, width, height);
+}
+
+// ---- PNG -------------------------------------------------------------------------------
+
+namespace png {
+
+inline uint32_t Crc32(const unsigned char* data, size_t size, uint32_t crc = 0)
+{
+    static uint32_t table[256];
+    static bool ready = false;
+    if (!ready) {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        ready = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// Deflate bits go out least significant first, Huffman codes most significant first
+class DeflateWriter
+{
+public:
+    std::vector<unsigned char> bytes;
+
+    void Bits(unsigned int value, int count)
+    {
+        mBuffer |= (uint64_t)value << mCount;
+        mCount += count;
+        while (mCount >= 8) {
+            bytes.push_back((unsigned char)mBuffer);
+            mBuffer >>= 8;
+            mCount -= 8;
+        }
+    }
+
+    void Code(unsigned int code, int length)
+    {
+        unsigned int reversed = 0;
+        for (int i = 0; i < length; ++i)
+            reversed |= ((code >> i) & 1) << (length - 1 - i);
+        Bits(reversed, length);
+    }
+
+    void Flush()
+    {
+        if (mCount > 0)
+            Bits(0, 8 - mCount);
+    }
+
+private:
+    uint64_t mBuffer = 0;
+    int mCount = 0;
+};
+
+inline void FixedLiteral(DeflateWriter& out, int symbol)
+{
+    if (symbol < 144)
+        out.Code(0x30 + symbol, 8);
+    else if (symbol < 256)
+        out.Code(0x190 + symbol - 144, 9);
+    else if (symbol < 280)
+        out.Code(symbol - 256, 7);
+    else
+        out.Code(0xC0 + symbol - 280, 8);
+}
+
+// zlib stream with one fixed-Huffman block and a single-candidate hash matcher
+inline std::vector<unsigned char> Compress(const std::vector<unsigned char>& data)
+{
+    static const int lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static const int lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static const int distBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    static const int distExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+    const int hashBits = 15;
+
+    DeflateWriter out;
+    out.Bits(0x78, 8);
+    out.Bits(0x01, 8);
+    out.Bits(1, 1);
+    out.Bits(1, 2);
+
+    std::vector<int> head((size_t)1 << hashBits, -1);
+    size_t size = data.size();
+    size_t i = 0;
+    while (i < size) {
+        int bestLength = 0;
+        size_t bestDistance = 0;
+        if (i + 3 <= size) {
+            uint32_t key = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+            uint32_t hash = (key * 2654435761u) >> (32 - hashBits);
+            int candidate = head[hash];
+            head[hash] = (int)i;
+            if (candidate >= 0 && i - candidate <= 32768) {
+                size_t limit = std::min<size_t>(258, size - i);
+                size_t length = 0;
+                while (length < limit && data[candidate + length] == data[i + length])
+                    ++length;
+                if (length >= 3) {
+                    bestLength = (int)length;
+                    bestDistance = i - candidate;
+                }
+            }
+        }
+
+        if (bestLength == 0) {
+            FixedLiteral(out, data[i]);
+            ++i;
+            continue;
+        }
+
+        int code = 28;
+        while (lengthBase[code] > bestLength)
+            --code;
+        FixedLiteral(out, 257 + code);
+        out.Bits(bestLength - lengthBase[code], lengthExtra[code]);
+
+        int dist = 29;
+        while (distBase[dist] > (int)bestDistance)
+            --dist;
+        out.Code(dist, 5);
+        out.Bits((unsigned int)bestDistance - distBase[dist], distExtra[dist]);
+        i += bestLength;
+    }
+    FixedLiteral(out, 256);
+    out.Flush();
+
+    uint32_t a = 1, b = 0;
+    for (unsigned char byte : data) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    uint32_t adler = (b << 16) | a;
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.bytes.push_back((unsigned char)(adler >> shift));
+    return out.bytes;
+}
+
+inline void Chunk(ByteWriter& out, const char* type, const std::vector<unsigned char>& data)
+{
+    out.Dword((uint32_t)data.size());
+    size_t start = out.bytes.size();
+    out.Append(type, 4);
+    out.Append(data.data(), data.size());
+    out.Dword(Crc32(&out.bytes[start], out.bytes.size() - start));
+}
+
+} // namespace png
+
+// channels is 1 (grey), 2 (grey+alpha), 3 (RGB) or 4 (RGBA); rows use the Sub filter
+inline std::vector<unsigned char> EncodePng(const unsigned char* pixels, int width, int height, int channels)
+{
+    static const unsigned char colourTypes[5] = { 0, 0, 4, 2, 6 };
+    size_t stride = (size_t)width * channels;
+    std::vector<unsigned char> filtered;
+    filtered.reserve((stride + 1) * height);
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* row = pixels + y * stride;
+        filtered.push_back(1);
+        for (size_t x = 0; x < stride; ++x)
+            filtered.push_back((unsigned char)(row[x] - (x >= (size_t)channels ? row[x - channels] : 0)));
+    }
+
+    ByteWriter header;
+    header.Dword(width);
+    header.Dword(height);
+    header.Byte(8);
+    header.Byte(colourTypes[channels]);
+    header.Byte(0);
+    header.Byte(0);
+    header.Byte(0);
+
+    ByteWriter out;
+    const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    out.Append(signature, 8);
+    png::Chunk(out, "IHDR", header.bytes);
+    png::Chunk(out, "IDAT", png::Compress(filtered));
+    png::Chunk(out, "IEND", std::vector<unsigned char>());
+    return out.bytes;
+}
+
+// ---- Radiance HDR ----------------------------------------------------------------------
+
+// Linear RGB floats to an RLE-compressed .hdr file (the width must be 8..32767 for RLE)
+inline std::vector<unsigned char> EncodeHdr(const float* rgb, int width, int height)
+{
+    ByteWriter out;
+    std::string header = "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " + std::to_string(height) + " +X " + std::to_string(width) + "\n";
+    out.Append(header.data(), header.size());
+
+    std::vector<unsigned char> planes[4];
+    for (auto& plane : planes)
+        plane.resize(width);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const float* p = rgb + ((size_t)y * width + x) * 3;
+            float maxValue = std::max(p[0], std::max(p[1], p[2]));
+            if (maxValue < 1e-32f) {
+                planes[0][x] = planes[1][x] = planes[2][x] = planes[3][x] = 0;
+                continue;
+            }
+            int exponent;
+            float scale = std::frexp(maxValue, &exponent) * 256.0f / maxValue;
+            for (int c = 0; c < 3; ++c)
+                planes[c][x] = (unsigned char)(std::max(0.0f, p[c]) * scale);
+            planes[3][x] = (unsigned char)(exponent + 128);
+        }
+
+        out.Byte(2);
+        out.Byte(2);
+        out.Word(width);
+        for (const auto& plane : planes) {
+            int x = 0;
+            while (x < width) {
+                // next run of at least 4 equal bytes, everything before it is literal
+                int runStart = x, runLength = 0;
+                while (runStart < width) {
+                    runLength = 1;
+                    while (runStart + runLength < width && runLength < 127 && plane[runStart + runLength] == plane[runStart])
+                        ++runLength;
+                    if (runLength >= 4)
+                        break;
+                    runStart += runLength;
+                }
+                if (runStart >= width)
+                    runLength = 0;
+                while (x < runStart) {
+                    int count = std::min(128, runStart - x);
+                    out.Byte(count);
+                    out.Append(&plane[x], count);
+                    x += count;
+                }
+                if (runLength >= 4) {
+                    out.Byte(128 + runLength);
+                    out.Byte(plane[runStart]);
+                    x = runStart + runLength;
+                }
+            }
+        }
+    }
+    return out.bytes;
+}
+
+// HDR version of MakePhotoRGB, spanning about eight stops
+inline std::vector<float> MakePhotoHdr(int width, int height, unsigned int seed = 12345)
+{
+    std::vector<unsigned char> ldr = MakePhotoRGB(width, height, seed);
+    std::vector<float> hdr(ldr.size());
+    for (size_t i = 0; i < ldr.size(); ++i)
+        hdr[i] = std::exp2(ldr[i] / 255.0f * 8.0f - 4.0f);
+    return hdr;
+}
+
+} // namespace bench
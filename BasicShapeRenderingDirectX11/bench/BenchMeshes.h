@@ -0,0 +1,104 @@
+#pragma once
+// Procedural test meshes for the mesh benchmarks: interleaved position + UV vertices and
+// 32-bit triangle lists, large enough to stress the optimizers without any asset files.
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace bench {
+
+const size_t kFloatsPerVertex = 5;
+const float kPi = 3.14159265f;
+
+struct TestMesh
+{
+    const char* name;
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    bool frontCounterClockwise = true;	// what the generators below produce
+};
+
+// (rings + 1) x (segments + 1) grid wrapped by position(u, v), wound so the cross product of
+// the edges points along the surface normal
+template <typename Position>
+inline void AddGrid(TestMesh& mesh, int rings, int segments, Position position)
+{
+    unsigned int base = (unsigned int)(mesh.vertices.size() / kFloatsPerVertex);
+    for (int r = 0; r <= rings; ++r) {
+        for (int s = 0; s <= segments; ++s) {
+            float u = (float)s / segments;
+            float v = (float)r / rings;
+            float p[3];
+            position(u, v, p);
+            mesh.vertices.insert(mesh.vertices.end(), { p[0], p[1], p[2], u, v });
+        }
+    }
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < segments; ++s) {
+            unsigned int a = base + r * (segments + 1) + s;
+            unsigned int b = a + segments + 1;
+            mesh.indices.insert(mesh.indices.end(), { a, a + 1, b, b, a + 1, b + 1 });
+        }
+    }
+}
+
+inline void AddSphere(TestMesh& mesh, int segments, float cx, float cy, float cz, float radius)
+{
+    AddGrid(mesh, segments / 2, segments, [=](float u, float v, float* p) {
+        float theta = u * 2.0f * kPi;
+        float phi = v * kPi;
+        p[0] = cx + radius * std::sin(phi) * std::cos(theta);
+        p[1] = cy + radius * std::cos(phi);
+        p[2] = cz + radius * std::sin(phi) * std::sin(theta);
+    });
+}
+
+inline void AddTorus(TestMesh& mesh, int segments, float major, float minor)
+{
+    AddGrid(mesh, segments / 2, segments, [=](float u, float v, float* p) {
+        float theta = u * 2.0f * kPi;
+        float phi = v * 2.0f * kPi;
+        float ring = major + minor * std::cos(phi);
+        p[0] = ring * std::cos(theta);
+        p[1] = -minor * std::sin(phi);
+        p[2] = ring * std::sin(theta);
+    });
+}
+
+// Reverses every triangle, giving the clockwise front faces the app's own meshes use
+inline void FlipWinding(TestMesh& mesh)
+{
+    for (size_t t = 0; t < mesh.indices.size(); t += 3)
+        std::swap(mesh.indices[t + 1], mesh.indices[t + 2]);
+    mesh.frontCounterClockwise = !mesh.frontCounterClockwise;
+}
+
+inline void Shuffle(TestMesh& mesh, unsigned int seed)
+{
+    std::mt19937 random(seed);
+    size_t vertexCount = mesh.vertices.size() / kFloatsPerVertex;
+    std::vector<unsigned int> order(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+        order[i] = (unsigned int)i;
+    std::shuffle(order.begin(), order.end(), random);
+    std::vector<float> vertices(mesh.vertices.size());
+    for (size_t i = 0; i < vertexCount; ++i)
+        std::copy_n(&mesh.vertices[i * kFloatsPerVertex], kFloatsPerVertex, &vertices[order[i] * kFloatsPerVertex]);
+    mesh.vertices.swap(vertices);
+
+    size_t triangleCount = mesh.indices.size() / 3;
+    std::vector<unsigned int> triangles(triangleCount);
+    for (size_t i = 0; i < triangleCount; ++i)
+        triangles[i] = (unsigned int)i;
+    std::shuffle(triangles.begin(), triangles.end(), random);
+    std::vector<unsigned int> indices;
+    indices.reserve(mesh.indices.size());
+    for (unsigned int t : triangles) {
+        for (int k = 0; k < 3; ++k)
+            indices.push_back(order[mesh.indices[t * 3 + k]]);
+    }
+    mesh.indices.swap(indices);
+}
+
+} // namespace bench
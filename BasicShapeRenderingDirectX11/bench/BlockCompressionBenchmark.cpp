@@ -0,0 +1,138 @@
+// Standalone BC1/BC3/BC7 encoder benchmark, no D3D dependency. Build on Linux from this directory:
+//   g++ -O2 -std=c++14 -pthread -I../src -I../Dependancies BlockCompressionBenchmark.cpp ../src/BlockCompressor.cpp ../src/Image.cpp ../src/ThreadPool.cpp -o BlockCompressionBenchmark
+// Usage: ./BlockCompressionBenchmark [image] [iterations]
+#include <cmath>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image/stb_image.h>
+
+#include "BlockCompressor.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static ImageData MakeTestImage(int width, int height)
+{
+    ImageData image = { width, height, 4, PixelBuffer((size_t)width * height * 4) };
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            unsigned char* p = image.data.data() + ((size_t)y * width + x) * 4;
+            p[0] = (unsigned char)(128 + 127 * std::sin(x * 0.05));
+            p[1] = (unsigned char)(128 + 127 * std::cos(y * 0.03));
+            p[2] = (unsigned char)((x ^ y) & 0xFF);
+            p[3] = (unsigned char)((x * 255) / width);
+        }
+    }
+    return image;
+}
+
+// Random RGB noise followed by one solid block per grey level, all fully opaque
+static ImageData MakeOpaqueImage()
+{
+    ImageData image = { 64, 128, 4, PixelBuffer((size_t)64 * 128 * 4) };
+    unsigned state = 12345;
+    for (int y = 0; y < 64; ++y) {
+        for (int x = 0; x < 64; ++x) {
+            unsigned char* p = image.data.data() + ((size_t)y * 64 + x) * 4;
+            for (int ch = 0; ch < 3; ++ch) {
+                state = state * 1103515245u + 12345u;
+                p[ch] = (unsigned char)(state >> 16);
+            }
+            p[3] = 255;
+        }
+    }
+    for (int y = 64; y < 128; ++y) {
+        for (int x = 0; x < 64; ++x) {
+            unsigned char* p = image.data.data() + ((size_t)y * 64 + x) * 4;
+            int grey = ((y - 64) / 4) * 16 + x / 4;
+            p[0] = p[1] = p[2] = (unsigned char)grey;
+            p[3] = 255;
+        }
+    }
+    return image;
+}
+
+// PSNR over the RGB channels, plus alpha when the format keeps it
+static double ComputePSNR(const ImageData& a, const ImageData& b, int channels)
+{
+    double error = 0.0;
+    size_t pixels = (size_t)a.width * a.height;
+    for (size_t i = 0; i < pixels; ++i) {
+        for (int ch = 0; ch < channels; ++ch) {
+            double d = (double)a.data[i * 4 + ch] - b.data[i * 4 + ch];
+            error += d * d;
+        }
+    }
+    double mse = error / (pixels * channels);
+    return mse == 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+int main(int argc, char** argv)
+{
+    ImageData source;
+    if (argc > 1) {
+        int width, height, channels;
+        unsigned char* pixels = stbi_load(argv[1], &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels) {
+            std::fprintf(stderr, "Failed to load %s\n", argv[1]);
+            return 1;
+        }
+        source = { width, height, 4, PixelBuffer(pixels, (size_t)width * height * 4, [](unsigned char* p) { stbi_image_free(p); }) };
+    }
+    else {
+        source = MakeTestImage(1024, 1024);
+    }
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 3;
+
+    ThreadPool singleThread(1);
+    ThreadPool& allThreads = ThreadPool::Default();
+    std::printf("source %dx%d, %d iterations, %zu threads\n", source.width, source.height, iterations, allThreads.GetThreadCount());
+
+    const struct { PixelFormat format; const char* name; int psnrChannels; } formats[] = {
+        { PixelFormat::BC1, "BC1", 3 },
+        { PixelFormat::BC3, "BC3", 4 },
+        { PixelFormat::BC7, "BC7", 4 },
+    };
+    const struct { CompressionQuality quality; const char* name; } qualities[] = {
+        { CompressionQuality::Fast, "fast" },
+        { CompressionQuality::High, "high" },
+    };
+    const struct { ThreadPool* pool; const char* name; } pools[] = {
+        { &singleThread, "1 thread" },
+        { &allThreads, "N threads" },
+    };
+
+    // opaque in has to stay opaque out, or alpha test and blending treat it as translucent
+    ImageData opaque = MakeOpaqueImage();
+    for (const auto& f : formats) {
+        for (const auto& q : qualities) {
+            ImageData decoded = BlockCompressor::Decompress(BlockCompressor::Compress(opaque, f.format, q.quality));
+            size_t translucent = 0;
+            for (size_t i = 0; i < (size_t)opaque.width * opaque.height; ++i)
+                translucent += decoded.data[i * 4 + 3] != 255;
+            if (translucent > 0) {
+                std::fprintf(stderr, "%s %s: %zu opaque texels decoded with alpha below 255\n", f.name, q.name, translucent);
+                return 1;
+            }
+        }
+    }
+
+    for (const auto& f : formats) {
+        for (const auto& q : qualities) {
+            for (const auto& p : pools) {
+                ImageData encoded;
+                auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < iterations; ++i)
+                    encoded = BlockCompressor::Compress(source, f.format, q.quality, *p.pool);
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+                double psnr = ComputePSNR(source, BlockCompressor::Decompress(encoded), f.psnrChannels);
+                double megapixels = (double)source.width * source.height * iterations / 1e6;
+                std::printf("%s %-4s %-9s %8.2f ms  %7.1f MP/s  PSNR %6.2f dB\n", f.name, q.name, p.name,
+                    elapsed.count() * 1000.0 / iterations, megapixels / elapsed.count(), psnr);
+            }
+        }
+    }
+    return 0;
+}
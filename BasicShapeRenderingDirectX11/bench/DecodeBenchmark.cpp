@@ -0,0 +1,241 @@
+// Image ingest benchmark: times what ImageDecoder (and so Texture::LoadImageFromFile) does
+// for JPEG, PNG and HDR inputs, split into stb_image decode, format conversion and the
+// ImageData copy, then how whole-file decoding scales from 1 to N threads. Writes JSON so
+// a pipeline change can be diffed against a saved baseline. Build on Linux from this directory:
+//   g++ -O2 -std=c++14 -pthread -I../src -I../Dependancies DecodeBenchmark.cpp ../src/ImageDecoder.cpp ../src/Image.cpp ../src/PixelConverter.cpp ../src/HalfFloat.cpp ../src/MappedFile.cpp ../src/Simd.cpp ../src/ThreadPool.cpp -o DecodeBenchmark
+// Usage: ./DecodeBenchmark [--sizes 256,1024,2048] [--threads N] [--iterations K] [--scale 1|2|4|8] [--json out.json] [image files...]
+// --scale decodes JPEGs at that fraction of their size with the reduced IDCT.
+#include "BenchImages.h"
+#include "HalfFloat.h"
+#include "ImageDecoder.h"
+#include "MappedFile.h"
+#include "PixelConverter.h"
+#include "Simd.h"
+#include "ThreadPool.h"
+#include <stb_image/stb_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Input
+{
+    std::string name;
+    std::string kind;
+    std::vector<unsigned char> bytes;
+};
+
+struct Result
+{
+    Input* input;
+    int width = 0, height = 0, channels = 0;
+    std::string format;
+    double decodeMs = 0, convertMs = 0, copyMs = 0, totalMs = 0;
+    double singleThreadMPs = 0, multiThreadMPs = 0;
+};
+
+// Median of the timed runs, after one warm-up
+static double TimeMs(int iterations, const std::function<void()>& body)
+{
+    body();
+    std::vector<double> times;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        times.push_back(elapsed.count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+static const char* FormatName(PixelFormat format)
+{
+    switch (format) {
+    case PixelFormat::R8: return "R8";
+    case PixelFormat::RG8: return "RG8";
+    case PixelFormat::RGBA16F: return "RGBA16F";
+    case PixelFormat::R11G11B10F: return "R11G11B10F";
+    default: return "RGBA8";
+    }
+}
+
+static std::string KindFromPath(const std::string& path)
+{
+    std::string extension = path.substr(path.find_last_of('.') + 1);
+    for (char& c : extension)
+        c = (char)std::tolower((unsigned char)c);
+    return extension == "jpeg" ? "jpg" : extension;
+}
+
+static Result Measure(Input& input, int iterations, size_t threads, int scale)
+{
+    Result result;
+    result.input = &input;
+    const unsigned char* bytes = input.bytes.data();
+    int size = (int)input.bytes.size();
+
+    ImageData decoded = ImageDecoder::Decode(bytes, input.bytes.size(), scale);
+    result.width = decoded.width;
+    result.height = decoded.height;
+    result.format = FormatName(decoded.format);
+    size_t pixelCount = (size_t)decoded.width * decoded.height;
+
+    // decode and convert mirror the two halves of ImageDecoder::Decode for this file type
+    int width, height, channels;
+    stbi_set_jpeg_scale_denom_thread(scale);
+    if (stbi_is_hdr_from_memory(bytes, size)) {
+        float* raw = stbi_loadf_from_memory(bytes, size, &width, &height, &channels, STBI_rgb_alpha);
+        result.channels = channels;
+        result.decodeMs = TimeMs(iterations, [&]() { stbi_image_free(stbi_loadf_from_memory(bytes, size, &width, &height, &channels, STBI_rgb_alpha)); });
+        std::vector<uint32_t> packed(pixelCount * 2);
+        if (decoded.format == PixelFormat::RGBA16F)
+            result.convertMs = TimeMs(iterations, [&]() { HalfFloat::FromFloat(raw, (uint16_t*)packed.data(), pixelCount * 4); });
+        else
+            result.convertMs = TimeMs(iterations, [&]() { HalfFloat::PackR11G11B10(raw, packed.data(), pixelCount); });
+        stbi_image_free(raw);
+    } else if (stbi_is_16_bit_from_memory(bytes, size)) {
+        stbi_us* raw = stbi_load_16_from_memory(bytes, size, &width, &height, &channels, STBI_rgb_alpha);
+        result.channels = channels;
+        result.decodeMs = TimeMs(iterations, [&]() { stbi_image_free(stbi_load_16_from_memory(bytes, size, &width, &height, &channels, STBI_rgb_alpha)); });
+        std::vector<uint16_t> halves(pixelCount * 4);
+        result.convertMs = TimeMs(iterations, [&]() { HalfFloat::FromUnorm16(raw, halves.data(), pixelCount * 4); });
+        stbi_image_free(raw);
+    } else {
+        unsigned char* raw = stbi_load_from_memory(bytes, size, &width, &height, &channels, STBI_default);
+        result.channels = channels;
+        result.decodeMs = TimeMs(iterations, [&]() { stbi_image_free(stbi_load_from_memory(bytes, size, &width, &height, &channels, STBI_default)); });
+        // other channel counts adopt stb's buffer and convert nothing
+        if (channels == 3) {
+            std::vector<unsigned char> rgba(pixelCount * 4);
+            result.convertMs = TimeMs(iterations, [&]() { PixelConverter::ExpandRGBToRGBA(raw, rgba.data(), pixelCount); });
+        }
+        stbi_image_free(raw);
+    }
+    stbi_set_jpeg_scale_denom_thread(1);
+
+    result.copyMs = TimeMs(iterations, [&]() { ImageData copy = decoded; });
+    result.totalMs = TimeMs(iterations, [&]() { ImageDecoder::Decode(bytes, input.bytes.size(), scale); });
+
+    // throughput over a batch of whole-file decodes, the caller counts as one of the threads
+    size_t jobs = std::max<size_t>(threads * 2, 4);
+    double megapixels = (double)pixelCount * jobs / 1e6;
+    double serialMs = TimeMs(1, [&]() {
+        for (size_t i = 0; i < jobs; ++i)
+            ImageDecoder::Decode(bytes, input.bytes.size(), scale);
+    });
+    result.singleThreadMPs = megapixels / (serialMs / 1000.0);
+    if (threads > 1) {
+        ThreadPool pool(threads - 1);
+        double parallelMs = TimeMs(1, [&]() { pool.ParallelFor(jobs, [&](size_t) { ImageDecoder::Decode(bytes, input.bytes.size(), scale); }); });
+        result.multiThreadMPs = megapixels / (parallelMs / 1000.0);
+    } else {
+        result.multiThreadMPs = result.singleThreadMPs;
+    }
+    return result;
+}
+
+static void WriteJson(FILE* out, const std::vector<Result>& results, size_t threads, int iterations, int scale)
+{
+    const CpuFeatures& cpu = CpuFeatures::Get();
+    std::fprintf(out, "{\n  \"benchmark\": \"decode\",\n");
+    std::fprintf(out, "  \"cpu\": { \"ssse3\": %s, \"sse41\": %s, \"avx2\": %s, \"f16c\": %s },\n",
+        cpu.HasSSSE3() ? "true" : "false", cpu.HasSSE41() ? "true" : "false",
+        cpu.HasAVX2() ? "true" : "false", cpu.HasF16C() ? "true" : "false");
+    std::fprintf(out, "  \"threads\": %zu,\n  \"iterations\": %d,\n  \"scale\": %d,\n  \"results\": [\n", threads, iterations, scale);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(out,
+            "    { \"name\": \"%s\", \"kind\": \"%s\", \"bytes\": %zu, \"width\": %d, \"height\": %d, \"channels\": %d, \"format\": \"%s\",\n"
+            "      \"decode_ms\": %.3f, \"convert_ms\": %.3f, \"copy_ms\": %.3f, \"total_ms\": %.3f,\n"
+            "      \"mpix_per_s_1t\": %.2f, \"mpix_per_s_nt\": %.2f, \"speedup\": %.2f }%s\n",
+            r.input->name.c_str(), r.input->kind.c_str(), r.input->bytes.size(), r.width, r.height, r.channels, r.format.c_str(),
+            r.decodeMs, r.convertMs, r.copyMs, r.totalMs,
+            r.singleThreadMPs, r.multiThreadMPs, r.multiThreadMPs / r.singleThreadMPs, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<int> sizes = { 256, 1024, 2048 };
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    int iterations = 5;
+    int scale = 1;
+    const char* jsonPath = nullptr;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc) {
+            sizes.clear();
+            for (const char* p = argv[++i]; *p; ) {
+                sizes.push_back(std::atoi(p));
+                while (*p && *p != ',')
+                    ++p;
+                if (*p == ',')
+                    ++p;
+            }
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--scale" && i + 1 < argc) {
+            scale = std::atoi(argv[++i]);
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    std::vector<Input> inputs;
+    for (int size : sizes) {
+        std::vector<unsigned char> rgb = bench::MakePhotoRGB(size, size);
+        std::vector<unsigned char> grey(rgb.size() / 3);
+        for (size_t i = 0; i < grey.size(); ++i)
+            grey[i] = rgb[i * 3 + 1];
+        std::vector<float> hdr = bench::MakePhotoHdr(size, size);
+        std::string suffix = "_" + std::to_string(size);
+        inputs.push_back({ "jpg" + suffix, "jpg", bench::EncodeJpeg(rgb.data(), size, size, 90) });
+        inputs.push_back({ "png_rgb" + suffix, "png", bench::EncodePng(rgb.data(), size, size, 3) });
+        inputs.push_back({ "png_grey" + suffix, "png", bench::EncodePng(grey.data(), size, size, 1) });
+        inputs.push_back({ "hdr" + suffix, "hdr", bench::EncodeHdr(hdr.data(), size, size) });
+    }
+    for (const std::string& path : files) {
+        try {
+            MappedFile file(path);
+            inputs.push_back({ path, KindFromPath(path), std::vector<unsigned char>(file.GetData(), file.GetData() + file.GetSize()) });
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "Skipping %s: %s\n", path.c_str(), e.what());
+        }
+    }
+
+    std::vector<Result> results;
+    for (Input& input : inputs) {
+        try {
+            results.push_back(Measure(input, iterations, threads, scale));
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "Skipping %s: %s\n", input.name.c_str(), e.what());
+            continue;
+        }
+        const Result& r = results.back();
+        std::fprintf(stderr, "%-22s %-10s decode %8.2f ms  convert %6.2f ms  copy %6.2f ms  total %8.2f ms  %7.1f MP/s x%zu %7.1f MP/s\n",
+            input.name.c_str(), r.format.c_str(), r.decodeMs, r.convertMs, r.copyMs, r.totalMs, r.singleThreadMPs, threads, r.multiThreadMPs);
+    }
+
+    FILE* out = jsonPath ? std::fopen(jsonPath, "w") : stdout;
+    if (!out) {
+        std::fprintf(stderr, "Could not open %s\n", jsonPath);
+        return 1;
+    }
+    WriteJson(out, results, threads, iterations, scale);
+    if (jsonPath)
+        std::fclose(out);
+    return 0;
+}
@@ -0,0 +1,61 @@
+// HDR conversion throughput, no D3D dependency. Build on Linux from this directory:
+//   g++ -O2 -std=c++14 -I../src HalfFloatBenchmark.cpp ../src/HalfFloat.cpp ../src/Simd.cpp -o HalfFloatBenchmark
+// Usage: ./HalfFloatBenchmark [megapixels] [iterations]
+#include "HalfFloat.h"
+#include "Simd.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+static void Report(const char* name, size_t pixels, int iterations, const std::function<void()>& body)
+{
+    body();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        body();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double megapixels = (double)pixels * iterations / 1e6;
+    std::printf("%-24s %8.2f ms  %8.1f MP/s\n", name, elapsed.count() * 1000.0 / iterations, megapixels / elapsed.count());
+}
+
+int main(int argc, char** argv)
+{
+    double megapixels = argc > 1 ? std::atof(argv[1]) : 4.0;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+    size_t pixels = (size_t)(megapixels * 1e6);
+
+    // RGBA spread over the range an HDR environment map covers
+    std::vector<float> rgba(pixels * 4);
+    unsigned int seed = 12345;
+    for (float& v : rgba) {
+        seed = seed * 1664525u + 1013904223u;
+        v = (float)(seed >> 8) / (float)(1u << 24) * 1000.0f * ((seed & 1) ? 1.0f : 0.001f);
+    }
+    std::vector<uint16_t> halves(pixels * 4), unorm(pixels * 4);
+    std::vector<uint32_t> packed(pixels);
+    std::vector<float> back(pixels * 4);
+    for (size_t i = 0; i < unorm.size(); ++i)
+        unorm[i] = (uint16_t)(i * 2654435761u >> 16);
+
+    const CpuFeatures& cpu = CpuFeatures::Get();
+    std::printf("%zu pixels (RGBA), %d iterations, F16C %s\n", pixels, iterations, cpu.HasF16C() ? "on" : "off");
+
+    Report("float->half sse2", pixels, iterations, [&]() { HalfFloat::FromFloatSSE2(rgba.data(), halves.data(), rgba.size()); });
+    Report("half->float sse2", pixels, iterations, [&]() { HalfFloat::ToFloatSSE2(halves.data(), back.data(), halves.size()); });
+    if (cpu.HasF16C()) {
+        std::vector<uint16_t> reference(halves.size());
+        HalfFloat::FromFloatSSE2(rgba.data(), reference.data(), rgba.size());
+        Report("float->half f16c", pixels, iterations, [&]() { HalfFloat::FromFloatF16C(rgba.data(), halves.data(), rgba.size()); });
+        Report("half->float f16c", pixels, iterations, [&]() { HalfFloat::ToFloatF16C(halves.data(), back.data(), halves.size()); });
+        bool same = std::memcmp(reference.data(), halves.data(), halves.size() * sizeof(uint16_t)) == 0;
+        std::printf("sse2 and f16c halves %s\n", same ? "match" : "DIFFER");
+    }
+    Report("unorm16->half", pixels, iterations, [&]() { HalfFloat::FromUnorm16(unorm.data(), halves.data(), unorm.size()); });
+    Report("float->r11g11b10", pixels, iterations, [&]() { HalfFloat::PackR11G11B10(rgba.data(), packed.data(), pixels); });
+    Report("r11g11b10->float", pixels, iterations, [&]() { HalfFloat::UnpackR11G11B10(packed.data(), back.data(), pixels); });
+    return 0;
+}
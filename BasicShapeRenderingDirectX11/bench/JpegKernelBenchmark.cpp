@@ -0,0 +1,117 @@
+// JPEG decode kernels in the vendored stb_image: checks that the scalar, SSE2 and AVX2
+// IDCT/upsampling/colour conversion paths decode to identical pixels, then times each.
+// Build on Linux from this directory:
+//   g++ -O2 -std=c++14 -I../src -I../Dependancies JpegKernelBenchmark.cpp ../src/Simd.cpp -o JpegKernelBenchmark
+// Usage: ./JpegKernelBenchmark [iterations] [jpeg files...]   (defaults to ../Assets/*.jpg)
+#include <cmath>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image/stb_image.h>
+
+#include "BenchImages.h"
+#include "Simd.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+struct Input
+{
+    std::string name;
+    std::vector<unsigned char> bytes;
+};
+
+static const char* kLevelNames[3] = { "scalar", "sse2", "avx2" };
+
+static std::vector<unsigned char> Decode(const Input& input, int level, int scale, int& width, int& height)
+{
+    stbi_set_jpeg_simd_limit(level);
+    stbi_set_jpeg_scale_denom(scale);
+    int channels;
+    unsigned char* pixels = stbi_load_from_memory(input.bytes.data(), (int)input.bytes.size(), &width, &height, &channels, 4);
+    std::vector<unsigned char> result;
+    if (pixels)
+        result.assign(pixels, pixels + (size_t)width * height * 4);
+    stbi_image_free(pixels);
+    stbi_set_jpeg_scale_denom(1);
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 10;
+    std::vector<std::string> paths;
+    for (int i = 2; i < argc; ++i)
+        paths.push_back(argv[i]);
+    if (paths.empty())
+        paths = { "../Assets/Wood_Tiles.jpg", "../Assets/Metal_Grill.jpg" };
+
+    std::vector<Input> inputs;
+    for (const std::string& path : paths) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::fprintf(stderr, "Skipping %s: could not open\n", path.c_str());
+            continue;
+        }
+        inputs.push_back({ path, std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()) });
+    }
+    // baseline 4:2:0 at sizes that leave every kind of partial block and row tail
+    const int sizes[][2] = { { 1, 1 }, { 17, 9 }, { 33, 31 }, { 257, 238 }, { 1000, 981 }, { 2048, 2048 } };
+    for (const auto& size : sizes) {
+        std::vector<unsigned char> rgb = bench::MakePhotoRGB(size[0], size[1]);
+        inputs.push_back({ "synthetic " + std::to_string(size[0]) + "x" + std::to_string(size[1]), bench::EncodeJpeg(rgb.data(), size[0], size[1], 90) });
+    }
+
+    const CpuFeatures& cpu = CpuFeatures::Get();
+    int maxLevel = cpu.HasAVX2() ? 2 : 1;
+    std::printf("AVX2 %s, %d iterations\n", cpu.HasAVX2() ? "on" : "off (avx2 rows skipped)", iterations);
+
+    // every SIMD level must reproduce the scalar decode exactly, scaled decodes included
+    bool allMatch = true;
+    for (const Input& input : inputs) {
+        for (int scale = 1; scale <= 8; scale *= 2) {
+            int width, height;
+            std::vector<unsigned char> reference = Decode(input, 0, scale, width, height);
+            if (reference.empty()) {
+                std::printf("%s: failed to decode\n", input.name.c_str());
+                allMatch = false;
+                break;
+            }
+            for (int level = 1; level <= maxLevel; ++level) {
+                int w, h;
+                std::vector<unsigned char> pixels = Decode(input, level, scale, w, h);
+                if (pixels != reference) {
+                    std::printf("%s 1/%d: %s DIFFERS from scalar\n", input.name.c_str(), scale, kLevelNames[level]);
+                    allMatch = false;
+                }
+            }
+        }
+    }
+    std::printf("bit-exact against scalar: %s\n\n", allMatch ? "yes" : "NO");
+
+    for (const Input& input : inputs) {
+        int width, height;
+        Decode(input, 0, 1, width, height);
+        if ((size_t)width * height < 250000)
+            continue;
+        double baseline = 0.0;
+        for (int level = 0; level <= maxLevel; ++level) {
+            Decode(input, level, 1, width, height);
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i)
+                Decode(input, level, 1, width, height);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            double ms = elapsed.count() / iterations;
+            if (level == 0)
+                baseline = ms;
+            std::printf("%-28s %-7s %8.2f ms  %7.1f MP/s  x%.2f\n", input.name.c_str(), kLevelNames[level], ms,
+                (double)width * height / (ms * 1000.0), baseline / ms);
+        }
+    }
+    stbi_set_jpeg_simd_limit(2);
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+// Meshlet building and CPU cluster culling over large procedural meshes. No D3D dependency.
+// Build on Linux from this directory:
+//   g++ -O2 -std=c++14 -I../src -I../Dependancies MeshletBenchmark.cpp ../src/MeshletBuilder.cpp ../src/ClusterCuller.cpp ../src/MeshOptimizer.cpp -o MeshletBenchmark
+// Usage: ./MeshletBenchmark [segments] [views]
+// Cameras orbit the mesh at a few distances, from far enough to see all of it to close
+// enough that most of it is off screen. "vertex work" is the distinct vertices the surviving
+// triangles reference, as a share of all vertices.
+#include "BenchMeshes.h"
+#include "ClusterCuller.h"
+#include "MeshOptimizer.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    int segments = argc > 1 ? std::atoi(argv[1]) : 1024;
+    int views = argc > 2 ? std::atoi(argv[2]) : 64;
+
+    std::vector<bench::TestMesh> meshes(2);
+    meshes[0].name = "sphere";
+    bench::AddSphere(meshes[0], segments, 0.0f, 0.0f, 0.0f, 1.0f);
+    meshes[1].name = "torus";
+    bench::AddTorus(meshes[1], segments, 0.7f, 0.3f);
+
+    const float distances[] = { 4.0f, 2.0f, 1.3f };
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+
+    for (bench::TestMesh& mesh : meshes) {
+        size_t vertexCount = mesh.vertices.size() / bench::kFloatsPerVertex;
+        MeshOptimizer::OptimizeVertexCache(mesh.indices, vertexCount);
+
+        auto start = std::chrono::steady_clock::now();
+        // the test meshes wind counter-clockwise around their outward normals
+        MeshletMesh meshlets = MeshletBuilder::Build(mesh.vertices, bench::kFloatsPerVertex, mesh.indices, true);
+        std::chrono::duration<double, std::milli> buildMs = std::chrono::steady_clock::now() - start;
+
+        size_t triangleCount = mesh.indices.size() / 3;
+        std::printf("%s: %zu triangles, %zu vertices -> %zu meshlets (%.1f triangles, %.1f vertices each), built in %.1f ms\n",
+            mesh.name, triangleCount, vertexCount, meshlets.meshlets.size(),
+            (double)triangleCount / meshlets.meshlets.size(), (double)meshlets.vertices.size() / meshlets.meshlets.size(), buildMs.count());
+
+        std::vector<unsigned int> visibleIndices;
+        std::vector<ClusterCuller::Range> ranges;
+        std::vector<bool> referenced(vertexCount);
+        for (float distance : distances) {
+            double cullSeconds = 0.0, rangeSeconds = 0.0;
+            size_t triangles = 0, vertices = 0, backface = 0, frustum = 0, rangeCount = 0;
+            for (int v = 0; v < views; ++v) {
+                float angle = 2.0f * bench::kPi * v / views;
+                glm::vec3 eye(distance * std::cos(angle), 0.4f * distance * std::sin(angle * 3.0f), distance * std::sin(angle));
+                ClusterCuller::View view(projection * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)), eye);
+
+                auto cullStart = std::chrono::steady_clock::now();
+                ClusterCuller::Stats stats = ClusterCuller::Cull(meshlets, view, visibleIndices);
+                auto rangeStart = std::chrono::steady_clock::now();
+                ClusterCuller::CullRanges(meshlets, view, ranges);
+                auto end = std::chrono::steady_clock::now();
+                cullSeconds += std::chrono::duration<double>(rangeStart - cullStart).count();
+                rangeSeconds += std::chrono::duration<double>(end - rangeStart).count();
+
+                triangles += visibleIndices.size() / 3;
+                backface += stats.backfaceCulled;
+                frustum += stats.frustumCulled;
+                rangeCount += ranges.size();
+                std::fill(referenced.begin(), referenced.end(), false);
+                for (unsigned int index : visibleIndices) {
+                    if (!referenced[index]) {
+                        referenced[index] = true;
+                        ++vertices;
+                    }
+                }
+            }
+            double meshletViews = (double)meshlets.meshlets.size() * views;
+            std::printf("  distance %.1f: triangles %5.1f%%  vertex work %5.1f%%  culled back %5.1f%% frustum %5.1f%%  "
+                "cull %6.3f ms (indices) %6.3f ms (%.0f ranges)\n",
+                distance, 100.0 * triangles / ((double)triangleCount * views), 100.0 * vertices / ((double)vertexCount * views),
+                100.0 * backface / meshletViews, 100.0 * frustum / meshletViews,
+                cullSeconds * 1000.0 / views, rangeSeconds * 1000.0 / views, (double)rangeCount / views);
+        }
+    }
+    return 0;
+}
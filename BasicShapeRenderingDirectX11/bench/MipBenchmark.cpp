@@ -0,0 +1,89 @@
+// Standalone mip generation benchmark, no D3D dependency. Build on Linux from this directory:
+//   g++ -O2 -std=c++14 -I../src -I../Dependancies MipBenchmark.cpp ../src/Image.cpp ../src/MipGenerator.cpp ../src/HalfFloat.cpp ../src/Simd.cpp -o MipBenchmark
+// Usage: ./MipBenchmark [image] [iterations]
+#include <cmath>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image/stb_image.h>
+
+#include "MipGenerator.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static ImageData MakeTestImage(int width, int height)
+{
+    ImageData image = { width, height, 4, {} };
+    image.data.resize((size_t)width * height * 4);
+    unsigned int seed = 12345;
+    for (size_t i = 0; i < image.data.size(); i += 4) {
+        size_t x = (i / 4) % width;
+        size_t y = (i / 4) / width;
+        seed = seed * 1664525u + 1013904223u;
+        image.data[i + 0] = (unsigned char)(x * 255 / width);
+        image.data[i + 1] = (unsigned char)(y * 255 / height);
+        image.data[i + 2] = (unsigned char)(seed >> 24);
+        image.data[i + 3] = 255;
+    }
+    return image;
+}
+
+int main(int argc, char** argv)
+{
+    ImageData source;
+    if (argc > 1) {
+        int width, height, channels;
+        unsigned char* pixels = stbi_load(argv[1], &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels) {
+            std::fprintf(stderr, "Failed to load %s\n", argv[1]);
+            return 1;
+        }
+        source = { width, height, 4, PixelBuffer(pixels, (size_t)width * height * 4, [](unsigned char* p) { stbi_image_free(p); }) };
+    }
+    else {
+        source = MakeTestImage(2048, 2048);
+    }
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    const CpuFeatures& cpu = CpuFeatures::Get();
+    std::printf("source %dx%d, %d iterations, AVX2 %s\n", source.width, source.height, iterations, cpu.HasAVX2() ? "on" : "off");
+
+    const struct { MipFilter filter; const char* name; } filters[] = {
+        { MipFilter::Box, "box" },
+        { MipFilter::Kaiser, "kaiser" },
+    };
+    for (const auto& f : filters) {
+        size_t levels = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i)
+            levels = MipGenerator::GenerateMips(source, f.filter).size();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        double megapixels = (double)source.width * source.height * iterations / 1e6;
+        std::printf("%-8s %2zu levels  %8.2f ms/chain  %8.1f MP/s\n", f.name, levels + 1,
+            elapsed.count() * 1000.0 / iterations, megapixels / elapsed.count());
+    }
+
+    // the downscale a quality tier applies before mips are built
+    const struct { ResizeFilter filter; const char* name; } resizeFilters[] = {
+        { ResizeFilter::Mitchell, "mitchell" },
+        { ResizeFilter::Lanczos3, "lanczos3" },
+    };
+    for (const auto& f : resizeFilters) {
+        for (int divisor = 2; divisor <= 4; divisor *= 2) {
+            int width = std::max(1, source.width / divisor);
+            int height = std::max(1, source.height / divisor);
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i)
+                MipGenerator::Resize(source, width, height, f.filter);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            double megapixels = (double)source.width * source.height * iterations / 1e6;
+            std::printf("%-8s -> %4dx%-4d  %8.2f ms/resize  %8.1f MP/s\n", f.name, width, height,
+                elapsed.count() * 1000.0 / iterations, megapixels / elapsed.count());
+        }
+    }
+    return 0;
+}
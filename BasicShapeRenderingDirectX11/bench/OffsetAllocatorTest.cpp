@@ -0,0 +1,198 @@
+// Randomized allocate/free sequences through the TLSF offset allocator, checked against a
+// plain sorted free list. No D3D dependency. Build on Linux from this directory:
+//   g++ -O2 -std=c++14 -I../src OffsetAllocatorTest.cpp ../src/OffsetAllocator.cpp -o OffsetAllocatorTest
+// Usage: ./OffsetAllocatorTest [operations] [seed]
+// The reference merges every freed range with its neighbours straight away. After each
+// operation the allocator has to agree with it on free storage and on the largest free
+// range, and an allocation has to succeed exactly when that range is big enough and land
+// inside a range the reference has free. Every round ends by freeing everything, which
+// has to coalesce back into the single range the buffer started as.
+#include "OffsetAllocator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+
+void Expect(bool ok, const char* what, int round, int operation)
+{
+    if (!ok) {
+        std::fprintf(stderr, "round %d, operation %d: %s\n", round, operation, what);
+        std::exit(1);
+    }
+}
+
+// Free ranges by offset, always merged with their neighbours
+class FreeList
+{
+public:
+    explicit FreeList(uint32_t size)
+    {
+        Insert(0, size);
+    }
+
+    // Removes [offset, offset + size), which must lie inside one free range
+    bool Take(uint32_t offset, uint32_t size)
+    {
+        auto it = mRanges.upper_bound(offset);
+        if (it == mRanges.begin())
+            return false;
+        --it;
+        uint32_t start = it->first, end = it->first + it->second;
+        if (offset + size > end)
+            return false;
+        Erase(it);
+        if (offset > start)
+            Insert(start, offset - start);
+        if (offset + size < end)
+            Insert(offset + size, end - offset - size);
+        return true;
+    }
+
+    void Give(uint32_t offset, uint32_t size)
+    {
+        auto next = mRanges.lower_bound(offset);
+        if (next != mRanges.end() && next->first == offset + size) {
+            size += next->second;
+            next = Erase(next);
+        }
+        if (next != mRanges.begin()) {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == offset) {
+                offset = prev->first;
+                size += prev->second;
+                Erase(prev);
+            }
+        }
+        Insert(offset, size);
+    }
+
+    uint32_t GetFree() const { return mFree; }
+    uint32_t GetLargest() const { return mSizes.empty() ? 0 : *mSizes.rbegin(); }
+    size_t GetRangeCount() const { return mRanges.size(); }
+
+private:
+    using Range = std::map<uint32_t, uint32_t>::iterator;
+
+    void Insert(uint32_t offset, uint32_t size)
+    {
+        mRanges[offset] = size;
+        mSizes.insert(size);
+        mFree += size;
+    }
+
+    Range Erase(Range range)
+    {
+        mSizes.erase(mSizes.find(range->second));
+        mFree -= range->second;
+        return mRanges.erase(range);
+    }
+
+    std::map<uint32_t, uint32_t> mRanges;
+    std::multiset<uint32_t> mSizes;
+    uint32_t mFree = 0;
+};
+
+struct Live {
+    OffsetAllocator::Allocation allocation;
+    uint32_t size;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int operations = argc > 1 ? std::atoi(argv[1]) : 200000;
+    unsigned seed = argc > 2 ? (unsigned)std::atoi(argv[2]) : 1;
+
+    // every size lands in a bin no bigger than it when rounding down, no smaller when rounding up
+    for (uint32_t size = 1; size < 0x40000000u; size = size * 3 / 2 + 1) {
+        if (OffsetAllocator::BinToSize(OffsetAllocator::SizeToBinRoundUp(size)) < size ||
+            OffsetAllocator::BinToSize(OffsetAllocator::SizeToBinRoundDown(size)) > size) {
+            std::fprintf(stderr, "size %u rounds to the wrong bin\n", size);
+            return 1;
+        }
+    }
+
+    // a power of two and an awkward size, small sizes and sizes near the buffer
+    struct Round {
+        uint32_t size;
+        uint32_t smallSize;
+        uint32_t largeSize;
+        int allocatePercent;
+    };
+    const Round rounds[] = {
+        { 1u << 20, 500, 50000, 55 },
+        { 1u << 20, 64, 4096, 70 },
+        { 999983, 3000, 200000, 50 },
+        { 4096, 16, 1024, 60 },
+    };
+
+    std::mt19937 random(seed);
+    std::printf("%8s %10s %10s %10s %10s %12s\n", "size", "allocated", "failed", "freed", "peak live", "peak ranges");
+    for (int round = 0; round < (int)(sizeof(rounds) / sizeof(rounds[0])); ++round) {
+        const Round& config = rounds[round];
+        OffsetAllocator allocator(config.size);
+        FreeList reference(config.size);
+        std::vector<Live> live;
+        size_t allocated = 0, failed = 0, freed = 0, peakLive = 0, peakRanges = 0;
+
+        for (int operation = 0; operation < operations; ++operation) {
+            if (live.empty() || (int)(random() % 100) < config.allocatePercent) {
+                uint32_t size = 1 + random() % (random() % 10 == 0 ? config.largeSize : config.smallSize);
+                uint32_t largest = reference.GetLargest();
+                OffsetAllocator::Allocation allocation = allocator.Allocate(size);
+                if (allocation.offset == OffsetAllocator::kNoSpace) {
+                    Expect(size > largest, "allocation failed with a big enough range free", round, operation);
+                    ++failed;
+                }
+                else {
+                    Expect(size <= largest, "allocation succeeded without a big enough range free", round, operation);
+                    Expect(reference.Take(allocation.offset, size), "allocation overlaps a live range", round, operation);
+                    live.push_back({ allocation, size });
+                    ++allocated;
+                }
+            }
+            else {
+                size_t index = random() % live.size();
+                allocator.Free(live[index].allocation);
+                reference.Give(live[index].allocation.offset, live[index].size);
+                live[index] = live.back();
+                live.pop_back();
+                ++freed;
+            }
+
+            Expect(allocator.GetFreeStorage() == reference.GetFree(), "free storage does not match the live ranges", round, operation);
+            Expect(allocator.GetLargestFree() == reference.GetLargest(), "largest free range is not fully merged", round, operation);
+            peakLive = live.size() > peakLive ? live.size() : peakLive;
+            peakRanges = reference.GetRangeCount() > peakRanges ? reference.GetRangeCount() : peakRanges;
+        }
+
+        // freeing what is left, in random order, has to leave one range covering the buffer
+        while (!live.empty()) {
+            size_t index = random() % live.size();
+            allocator.Free(live[index].allocation);
+            reference.Give(live[index].allocation.offset, live[index].size);
+            live[index] = live.back();
+            live.pop_back();
+        }
+        Expect(reference.GetRangeCount() == 1, "reference did not merge back to one range", round, operations);
+        Expect(allocator.GetFreeStorage() == config.size, "free storage is not the whole buffer", round, operations);
+        Expect(allocator.GetLargestFree() == config.size, "free ranges did not coalesce back into one", round, operations);
+        OffsetAllocator::Allocation whole = allocator.Allocate(config.size);
+        Expect(whole.offset == 0, "the whole buffer cannot be allocated after freeing everything", round, operations);
+        Expect(allocator.GetFreeStorage() == 0 && allocator.Allocate(1).offset == OffsetAllocator::kNoSpace,
+            "a full buffer still hands out space", round, operations);
+        allocator.Free(whole);
+        Expect(allocator.GetFreeStorage() == config.size, "freeing the whole buffer lost space", round, operations);
+
+        std::printf("%8u %10zu %10zu %10zu %10zu %12zu\n", config.size, allocated, failed, freed, peakLive, peakRanges);
+    }
+    std::printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,224 @@
+// The upload ring's offset bookkeeping driven against a mock GPU. No D3D dependency.
+// Build on Linux from this directory:
+//   g++ -O2 -std=c++14 -I../src RingAllocatorTest.cpp ../src/RingAllocator.cpp -o RingAllocatorTest
+// Usage: ./RingAllocatorTest [frames] [seed]
+// The mock GPU finishes each frame a random 0 to lag frames after it is submitted, and keeps
+// a copy of the buffer that UploadRing would map: NO_OVERWRITE writes land in it directly, a
+// DISCARD starts a fresh copy holding only the current frame's span. A byte model kept next
+// to the allocator records which frame owns every 256-byte block, wasted space at a wrap
+// included. Every allocation is checked for alignment, for the offset and discard the model
+// predicts, and for not overwriting a frame that has not retired; at the end of each frame
+// every allocation it made still has to read back from the GPU copy.
+#include "RingAllocator.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+const uint32_t kAlignment = 256;
+
+void Expect(bool ok, const char* what, int frame)
+{
+    if (!ok) {
+        std::fprintf(stderr, "frame %d: %s\n", frame, what);
+        std::exit(1);
+    }
+}
+
+struct Upload {
+    RingAllocator::Allocation allocation;
+    uint32_t tag;
+};
+
+struct Stats {
+    size_t allocations = 0;
+    size_t discards = 0;
+    size_t restarts = 0;
+    size_t staleBinds = 0;
+};
+
+// Frames alternate between fitting comfortably and overflowing; now and then one is bigger
+// than the whole ring.
+void Run(uint32_t blocks, uint32_t framesInFlight, int lag, int frames, unsigned seed, Stats& stats)
+{
+    const uint32_t size = blocks * kAlignment;
+    RingAllocator ring(size, framesInFlight, kAlignment);
+    std::mt19937 random(seed);
+
+    std::vector<int> owner(blocks, -1);		// frame that wrote each block of the GPU copy
+    std::vector<uint32_t> gpu(blocks, 0);	// tag of the upload in each block
+    std::vector<uint32_t> shadow(blocks, 0);
+    std::vector<bool> retired(frames, false);
+    std::vector<int> slotFrame(framesInFlight, -1);
+    int completed = -1;					// last frame the mock GPU has finished
+    int lastRetired = -1;
+    uint32_t head = 0;
+    uint32_t tag = 0;
+
+    for (int frame = 0; frame < frames; ++frame) {
+        completed = std::max(completed, frame - 1 - (int)(random() % (lag + 1)));
+        ring.BeginFrame([&](size_t slot, bool wait) {
+            int submitted = slotFrame[slot];
+            Expect(submitted == lastRetired + 1, "frames retired out of order", frame);
+            if (wait)
+                completed = std::max(completed, submitted);
+            if (submitted > completed)
+                return false;
+            retired[submitted] = true;
+            lastRetired = submitted;
+            return true;
+        });
+        auto owned = [&](uint32_t block) { return owner[block] >= 0 && !retired[owner[block]]; };
+
+        std::vector<Upload> uploads;
+        uint32_t budget = (frame % 7 == 6 ? 2 * size : size / (1 + random() % 4));
+        if (frame % 5 == 4)
+            budget = size / 8;
+        for (uint32_t spent = 0; spent < budget;) {
+            uint32_t bytes = 1 + random() % (frame % 3 == 0 ? 4 * kAlignment : kAlignment);
+            uint32_t count = (bytes + kAlignment - 1) / kAlignment;
+
+            // what the model expects: the allocation goes at the head, or at 0 when it would
+            // run off the end, and the ring is full if that touches a block still owned
+            bool empty = true;
+            for (uint32_t block = 0; block < blocks; ++block)
+                empty = empty && !owned(block);
+            if (empty)
+                head = 0;
+            auto fits = [&]() {
+                uint32_t start = head + count > blocks ? 0 : head;
+                uint32_t end = start == head ? head + count : blocks;
+                for (uint32_t block = head; block < end; ++block)
+                    if (owned(block))
+                        return false;
+                for (uint32_t block = start; block < start + count; ++block)
+                    if (owned(block))
+                        return false;
+                return true;
+            };
+            bool full = !fits();
+            bool restart = false;
+            if (full) {
+                for (uint32_t block = 0; block < blocks; ++block) {
+                    if (owner[block] != frame)
+                        owner[block] = -1;
+                }
+                bool anyOwned = false;
+                for (uint32_t block = 0; block < blocks; ++block)
+                    anyOwned = anyOwned || owned(block);
+                if (!anyOwned)
+                    head = 0;
+                restart = !fits();
+                if (restart) {
+                    std::fill(owner.begin(), owner.end(), -1);
+                    head = 0;
+                }
+            }
+            uint32_t expected = head + count > blocks ? 0 : head;
+            uint32_t generation = ring.GetGeneration();
+
+            RingAllocator::Allocation allocation = ring.Allocate(bytes);
+            Expect(allocation.offset % kAlignment == 0, "offset is not 256-byte aligned", frame);
+            Expect(allocation.size == count * kAlignment, "size is not rounded up to the alignment", frame);
+            Expect(allocation.offset + allocation.size <= size, "allocation runs past the end", frame);
+            Expect(allocation.discard == full, full ? "ring is full but did not discard" : "discarded with room left", frame);
+            Expect(allocation.offset == expected * kAlignment, "offset is not where the ring was heading", frame);
+
+            uint32_t first = allocation.offset / kAlignment;
+            if (allocation.discard) {
+                // the renamed buffer starts as garbage with this frame's span copied in
+                std::vector<uint32_t> renamed(blocks, 0xdeadu);
+                uint32_t start = ring.GetFrameStart() / kAlignment;
+                for (uint32_t i = 0; i < ring.GetFrameBytes() / kAlignment; ++i)
+                    renamed[(start + i) % blocks] = shadow[(start + i) % blocks];
+                gpu.swap(renamed);
+                ++stats.discards;
+            }
+            else {
+                for (uint32_t block = first; block < first + count; ++block)
+                    Expect(!owned(block) || owner[block] == frame, "NO_OVERWRITE write over a frame still in flight", frame);
+            }
+            Expect(allocation.generation == generation + (restart ? 1 : 0), "generation changed without a restart", frame);
+            stats.restarts += restart;
+
+            // a wrap leaves the end of the ring to this frame as well
+            if (first != head) {
+                for (uint32_t block = head; block < blocks; ++block)
+                    owner[block] = frame;
+            }
+            for (uint32_t block = first; block < first + count; ++block) {
+                owner[block] = frame;
+                shadow[block] = gpu[block] = ++tag;
+            }
+            head = first + count;
+            uploads.push_back({ allocation, tag });
+            spent += allocation.size;
+            ++stats.allocations;
+        }
+
+        // binding: everything since the last restart reads back, anything older throws
+        for (const Upload& upload : uploads) {
+            bool current = upload.allocation.generation == ring.GetGeneration();
+            bool threw = false;
+            try {
+                ring.Validate(upload.allocation.generation);
+            }
+            catch (const std::runtime_error&) {
+                threw = true;
+            }
+            Expect(threw != current, current ? "current allocation failed to bind" : "overwritten allocation did not throw on bind", frame);
+            if (!current) {
+                ++stats.staleBinds;
+                continue;
+            }
+            for (uint32_t i = 0; i < upload.allocation.size / kAlignment; ++i) {
+                uint32_t block = upload.allocation.offset / kAlignment + i;
+                Expect(gpu[block] == upload.tag - (upload.allocation.size / kAlignment - 1 - i),
+                    "allocation lost its contents", frame);
+            }
+        }
+        if (budget > size) {
+            Expect(!uploads.empty() && uploads.front().allocation.generation != ring.GetGeneration(),
+                "frame bigger than the ring did not restart", frame);
+        }
+
+        slotFrame[ring.EndFrame()] = frame;
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int frames = argc > 1 ? std::atoi(argv[1]) : 2000;
+    unsigned seed = argc > 2 ? (unsigned)std::atoi(argv[2]) : 1;
+
+    try {
+        RingAllocator ring(4 * kAlignment, 2, kAlignment);
+        ring.Allocate(4 * kAlignment + 1);
+        std::fprintf(stderr, "allocation bigger than the ring did not throw\n");
+        return 1;
+    }
+    catch (const std::runtime_error&) {
+    }
+
+    std::printf("%6s %6s %4s  %11s %9s %9s %11s\n", "blocks", "frames", "lag", "allocations", "discards", "restarts", "stale binds");
+    const uint32_t sizes[] = { 4, 16, 64 };
+    for (uint32_t blocks : sizes) {
+        for (uint32_t framesInFlight = 1; framesInFlight <= 4; ++framesInFlight) {
+            for (int lag = 0; lag <= 3; ++lag) {
+                Stats stats;
+                Run(blocks, framesInFlight, lag, frames, seed + blocks * 16 + framesInFlight * 4 + lag, stats);
+                std::printf("%6u %6u %4d  %11zu %9zu %9zu %11zu\n", blocks, framesInFlight, lag,
+                    stats.allocations, stats.discards, stats.restarts, stats.staleBinds);
+            }
+        }
+    }
+    std::printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,126 @@
+// CPU bilinear sampling in linear vs tiled (8x8 Morton) layout, plus the cost of converting
+// between the two. No D3D dependency. Build on Linux from this directory:
+//   g++ -O2 -std=c++14 -I../src SamplingBenchmark.cpp ../src/TexelTiling.cpp ../src/Image.cpp ../src/Simd.cpp -o SamplingBenchmark
+// Usage: ./SamplingBenchmark [texture size] [iterations]
+// Each pattern draws a screen-sized grid of samples walked in screen rows, with the texture
+// rotated and scaled under it, so a 90 degree walk reads the texture down its columns.
+#include "Simd.h"
+#include "TexelTiling.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static ImageData MakeTestImage(int width, int height)
+{
+    ImageData image = { width, height, 4, PixelBuffer((size_t)width * height * 4) };
+    unsigned int seed = 12345;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            unsigned char* p = image.data.data() + ((size_t)y * width + x) * 4;
+            seed = seed * 1664525u + 1013904223u;
+            p[0] = (unsigned char)(x * 255 / width);
+            p[1] = (unsigned char)(y * 255 / height);
+            p[2] = (unsigned char)(seed >> 24);
+            p[3] = 255;
+        }
+    }
+    return image;
+}
+
+struct Pattern
+{
+    const char* name;
+    float degrees;
+    // texels per screen pixel
+    float scale;
+};
+
+// Samples one screen row at a time so the uv and colour buffers stay in cache
+static double Sample(const ImageData& image, const Pattern& pattern, int screen, std::vector<float>& uv, std::vector<float>& rgba)
+{
+    float radians = pattern.degrees * 3.14159265f / 180.0f;
+    float c = std::cos(radians) * pattern.scale;
+    float s = std::sin(radians) * pattern.scale;
+    float invWidth = 1.0f / image.width;
+    float invHeight = 1.0f / image.height;
+    double checksum = 0.0;
+    for (int y = 0; y < screen; ++y) {
+        float sy = y - screen * 0.5f;
+        for (int x = 0; x < screen; ++x) {
+            float sx = x - screen * 0.5f;
+            uv[2 * x] = (image.width * 0.5f + c * sx - s * sy) * invWidth;
+            uv[2 * x + 1] = (image.height * 0.5f + s * sx + c * sy) * invHeight;
+        }
+        TexelTiling::SampleBilinear(image, uv.data(), screen, rgba.data());
+        checksum += rgba[0] + rgba[4 * (screen - 1) + 2];
+    }
+    return checksum;
+}
+
+int main(int argc, char** argv)
+{
+    int size = argc > 1 ? std::atoi(argv[1]) : 4096;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 3;
+
+    ImageData linear = MakeTestImage(size, size);
+    std::printf("texture %dx%d RGBA8 (%.0f MB), %d iterations, AVX2 %s\n", size, size,
+        linear.data.size() / (1024.0 * 1024.0), iterations, CpuFeatures::Get().HasAVX2() ? "on" : "off");
+
+    ImageData tiled;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        tiled = TexelTiling::ToTiled(linear);
+    double tileSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    ImageData roundTrip;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        roundTrip = TexelTiling::ToLinear(tiled);
+    double untileSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    double megabytes = linear.data.size() / (1024.0 * 1024.0);
+    std::printf("%-24s %8.2f ms %8.0f MB/s\n", "swizzle", tileSeconds * 1000.0, megabytes / tileSeconds);
+    std::printf("%-24s %8.2f ms %8.0f MB/s\n", "unswizzle", untileSeconds * 1000.0, megabytes / untileSeconds);
+    if (std::memcmp(roundTrip.data.data(), linear.data.data(), linear.data.size()) != 0) {
+        std::fprintf(stderr, "round trip does not match the source\n");
+        return 1;
+    }
+
+    const Pattern patterns[] = {
+        { "rows, 1:1", 0.0f, 1.0f },
+        { "rotated 30, 1:1", 30.0f, 1.0f },
+        { "columns, 1:1", 90.0f, 1.0f },
+        { "columns, minified 2x", 90.0f, 2.0f },
+        { "rotated 45, magnified 4x", 45.0f, 0.25f },
+    };
+    int screen = size / 2;
+    std::vector<float> uv((size_t)screen * 2);
+    std::vector<float> rgba((size_t)screen * 4);
+    double samples = (double)screen * screen;
+
+    std::printf("%-24s %12s %12s %8s\n", "pattern", "linear Ms/s", "tiled Ms/s", "speedup");
+    for (const Pattern& pattern : patterns) {
+        double rates[2];
+        double checksums[2];
+        const ImageData* images[2] = { &linear, &tiled };
+        for (int layout = 0; layout < 2; ++layout) {
+            // one untimed pass to settle caches and page faults
+            checksums[layout] = Sample(*images[layout], pattern, screen, uv, rgba);
+            start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i)
+                Sample(*images[layout], pattern, screen, uv, rgba);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+            rates[layout] = samples / seconds / 1e6;
+        }
+        if (checksums[0] != checksums[1]) {
+            std::fprintf(stderr, "%s: tiled samples differ from linear\n", pattern.name);
+            return 1;
+        }
+        std::printf("%-24s %12.1f %12.1f %7.2fx\n", pattern.name, rates[0], rates[1], rates[1] / rates[0]);
+    }
+    return 0;
+}
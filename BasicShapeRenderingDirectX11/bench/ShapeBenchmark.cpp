@@ -0,0 +1,66 @@
+// Procedural shape generation at stress-test tessellations, on one thread and on the shared
+// pool. No D3D dependency.
+// Build on Linux from this directory:
+//   g++ -O2 -std=c++14 -pthread -I../src ShapeBenchmark.cpp ../src/ShapeGenerator.cpp ../src/ThreadPool.cpp -o ShapeBenchmark
+// Usage: ./ShapeBenchmark [segments] [runs]
+// Every shape is built with about 2 * segments^2 triangles.
+#include "ShapeGenerator.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+namespace {
+
+// Best of runs, in milliseconds
+double Time(int runs, const std::function<MeshData()>& build, size_t& triangles)
+{
+    double best = 1e30;
+    for (int run = 0; run < runs; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        MeshData mesh = build();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+        triangles = mesh.indices.size() / 3;
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int segments = argc > 1 ? std::atoi(argv[1]) : 1024;
+    int runs = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    ThreadPool single(1);
+    ThreadPool& pool = ThreadPool::Default();
+    // six faces of n x n quads make 12 n^2 triangles
+    int faceSegments = std::max(1, static_cast<int>(segments / 2.45f));
+
+    struct Shape {
+        const char* name;
+        std::function<MeshData(ThreadPool&)> build;
+    };
+    std::vector<Shape> shapes = {
+        { "box", [&](ThreadPool& p) { return ShapeGenerator::Box(1.0f, 1.0f, 1.0f, faceSegments, p); } },
+        { "sphere", [&](ThreadPool& p) { return ShapeGenerator::Sphere(1.0f, segments, segments, p); } },
+        { "cylinder", [&](ThreadPool& p) { return ShapeGenerator::Cylinder(0.5f, 2.0f, segments, segments, p); } },
+        { "torus", [&](ThreadPool& p) { return ShapeGenerator::Torus(0.7f, 0.3f, segments, segments, p); } },
+        { "capsule", [&](ThreadPool& p) { return ShapeGenerator::Capsule(0.5f, 1.0f, segments, segments / 2, p); } },
+    };
+
+    std::printf("%zu worker threads\n", pool.GetThreadCount());
+    for (const Shape& shape : shapes) {
+        size_t triangles = 0;
+        double singleMs = Time(runs, [&]() { return shape.build(single); }, triangles);
+        double poolMs = Time(runs, [&]() { return shape.build(pool); }, triangles);
+        std::printf("%-9s %9zu triangles  1 thread %7.2f ms (%6.1f Mtri/s)  pool %7.2f ms (%6.1f Mtri/s)\n", shape.name, triangles,
+            singleMs, triangles / singleMs / 1000.0, poolMs, triangles / poolMs / 1000.0);
+    }
+    return 0;
+}
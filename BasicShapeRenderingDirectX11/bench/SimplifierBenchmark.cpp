@@ -0,0 +1,52 @@
+// LOD chain building with the quadric simplifier, and the level picked by screen-space error
+// as the camera backs away. No D3D dependency.
+// Build on Linux from this directory:
+//   g++ -O2 -std=c++14 -I../src -I../Dependancies SimplifierBenchmark.cpp ../src/MeshSimplifier.cpp ../src/LodSelector.cpp ../src/MeshOptimizer.cpp -o SimplifierBenchmark
+// Usage: ./SimplifierBenchmark [segments] [maxError]
+// maxError is in mesh units; both test meshes are about two units across.
+#include "BenchMeshes.h"
+#include "LodSelector.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    int segments = argc > 1 ? std::atoi(argv[1]) : 512;
+    float maxError = argc > 2 ? (float)std::atof(argv[2]) : 0.05f;
+
+    std::vector<bench::TestMesh> meshes(2);
+    meshes[0].name = "sphere";
+    bench::AddSphere(meshes[0], segments, 0.0f, 0.0f, 0.0f, 1.0f);
+    meshes[1].name = "torus";
+    bench::AddTorus(meshes[1], segments, 0.7f, 0.3f);
+
+    const float distances[] = { 2.0f, 5.0f, 10.0f, 25.0f, 50.0f, 100.0f, 250.0f };
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+    float scale = LodSelector::GetProjectionScale(projection, 1080.0f);
+
+    for (const bench::TestMesh& mesh : meshes) {
+        auto start = std::chrono::steady_clock::now();
+        LodChain chain = MeshSimplifier::BuildLodChain(mesh.vertices, bench::kFloatsPerVertex, mesh.indices, maxError);
+        std::chrono::duration<double, std::milli> buildMs = std::chrono::steady_clock::now() - start;
+
+        std::printf("%s: %zu levels built in %.1f ms, %zu indices in total (%.2fx level 0)\n", mesh.name, chain.levels.size(),
+            buildMs.count(), chain.indices.size(), (double)chain.indices.size() / chain.levels[0].indexCount);
+        for (size_t i = 0; i < chain.levels.size(); ++i) {
+            const LodLevel& level = chain.levels[i];
+            std::printf("  level %zu: %8u triangles  error %.5f\n", i, level.indexCount / 3, level.error);
+        }
+
+        std::printf("  1080p, 45 degree fov, 1 pixel error:");
+        for (float distance : distances) {
+            size_t level = LodSelector::SelectLevel(chain, glm::vec3(0.0f, 0.0f, distance), scale);
+            std::printf("  %.0f -> %zu", distance, level);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
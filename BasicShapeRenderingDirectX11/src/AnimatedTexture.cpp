@@ -0,0 +1,204 @@
+#include "AnimatedTexture.h"
+#include "ImageDecoder.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+AnimatedTexture::AnimatedTexture(const std::string& path, ID3D11Device* dev, ThreadPool& pool, UINT ringSize)
+    : mPool(pool)
+{
+    mFile.reset(new MappedFile(path));
+    mDecoder.reset(new GifDecoder(mFile->GetData(), mFile->GetSize()));
+    mWidth = mDecoder->GetWidth();
+    mHeight = mDecoder->GetHeight();
+    // one slice is on screen while the others are refilled
+    ringSize = std::max(2u, ringSize);
+
+    // fill the ring up front; an animation that ends before it overflows never needs the decoder again
+    std::vector<Frame> frames;
+    Frame next;
+    bool ended = false;
+    while (!ended) {
+        ended = !DecodeFrame(next);
+        if (ended || frames.size() == ringSize)
+            break;
+        frames.push_back(std::move(next));
+        next = Frame();
+    }
+    if (frames.empty()) {
+        throw std::runtime_error("No frames in " + path);
+    }
+    if (ended) {
+        mDecoder.reset();
+        mFile.reset();
+    } else {
+        mDecoded.push_back(std::move(next));
+    }
+
+    mSliceCount = static_cast<UINT>(frames.size());
+    mUploaded = frames.size();
+    mSliceDelays.resize(frames.size());
+
+    D3D11_TEXTURE2D_DESC desc;
+    ZeroMemory(&desc, sizeof(desc));
+    desc.Width = mWidth;
+    desc.Height = mHeight;
+    desc.MipLevels = 1;
+    desc.ArraySize = mSliceCount;
+    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.CPUAccessFlags = 0;
+
+    std::vector<D3D11_SUBRESOURCE_DATA> initData(mSliceCount);
+    for (UINT slice = 0; slice < mSliceCount; ++slice) {
+        initData[slice].pSysMem = frames[slice].pixels.data();
+        initData[slice].SysMemPitch = static_cast<UINT>(mWidth * 4);
+        initData[slice].SysMemSlicePitch = 0;
+        mSliceDelays[slice] = frames[slice].delayMs;
+    }
+
+    HRESULT hr = dev->CreateTexture2D(&desc, initData.data(), &mTexture);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to create animated texture");
+    }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+    ZeroMemory(&srvDesc, sizeof(srvDesc));
+    srvDesc.Format = desc.Format;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+    srvDesc.Texture2DArray.MostDetailedMip = 0;
+    srvDesc.Texture2DArray.MipLevels = 1;
+    srvDesc.Texture2DArray.FirstArraySlice = 0;
+    srvDesc.Texture2DArray.ArraySize = mSliceCount;
+
+    hr = dev->CreateShaderResourceView(mTexture, &srvDesc, &mTextureView);
+    if (FAILED(hr)) {
+        mTexture->Release();
+        throw std::runtime_error("Failed to create shader resource view");
+    }
+
+    if (mDecoder) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        StartDecodeAhead();
+    }
+}
+
+AnimatedTexture::AnimatedTexture(const std::string& path, ID3D11Device* dev, UINT ringSize)
+    : AnimatedTexture(path, dev, ThreadPool::Default(), ringSize)
+{
+}
+
+AnimatedTexture::~AnimatedTexture()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    if (mTask.valid())
+        mTask.wait();
+    mTextureView->Release();
+    mTexture->Release();
+}
+
+void AnimatedTexture::Update(ID3D11DeviceContext* devcon, float deltaSeconds)
+{
+    // upload before and after advancing, so a frame decoded just in time is not held back
+    // and the slice just left is refilled straight away
+    UploadDecoded(devcon);
+
+    mElapsedMs += deltaSeconds * 1000.0f;
+    for (;;) {
+        float delay = static_cast<float>(mSliceDelays[GetCurrentSlice()]);
+        if (mElapsedMs < delay)
+            break;
+        if (IsFullyResident()) {
+            mDisplayed = (mDisplayed + 1) % mSliceCount;
+        } else if (mDisplayed + 1 < mUploaded) {
+            ++mDisplayed;
+        } else {
+            // decoding fell behind, hold this frame until the next one arrives
+            mElapsedMs = delay;
+            break;
+        }
+        mElapsedMs -= delay;
+    }
+
+    UploadDecoded(devcon);
+}
+
+void AnimatedTexture::UploadDecoded(ID3D11DeviceContext* devcon)
+{
+    if (IsFullyResident())
+        return;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    // the newest upload may go at most one ring ahead of the slice on screen
+    while (!mDecoded.empty() && mUploaded < mDisplayed + mSliceCount) {
+        Frame& frame = mDecoded.front();
+        UINT slice = static_cast<UINT>(mUploaded % mSliceCount);
+        devcon->UpdateSubresource(mTexture, slice, nullptr, frame.pixels.data(), static_cast<UINT>(mWidth * 4), 0);
+        mSliceDelays[slice] = frame.delayMs;
+        ++mUploaded;
+
+        mSpareBuffers.push_back(std::move(frame.pixels));
+        mDecoded.pop_front();
+    }
+    StartDecodeAhead();
+}
+
+bool AnimatedTexture::DecodeFrame(Frame& frame)
+{
+    int delayMs = 0;
+    const unsigned char* pixels = mDecoder->NextFrame(delayMs);
+    if (!pixels)
+        return false;
+    frame.pixels.assign(pixels, pixels + static_cast<size_t>(mWidth) * mHeight * 4);
+    // browsers play anything faster than 50 fps at 10 fps, and files are authored for that
+    frame.delayMs = delayMs < 20 ? 100 : delayMs;
+    return true;
+}
+
+void AnimatedTexture::StartDecodeAhead()
+{
+    if (mDecoding || mStopping || mFailed || mDecoded.size() >= mSliceCount)
+        return;
+    mDecoding = true;
+    mTask = mPool.Submit([this]() { DecodeAhead(); });
+}
+
+void AnimatedTexture::DecodeAhead()
+{
+    for (;;) {
+        Frame frame;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mStopping || mDecoded.size() >= mSliceCount) {
+                mDecoding = false;
+                return;
+            }
+            if (!mSpareBuffers.empty()) {
+                frame.pixels = std::move(mSpareBuffers.back());
+                mSpareBuffers.pop_back();
+            }
+        }
+
+        bool decoded = DecodeFrame(frame);
+        if (!decoded) {
+            // past the last frame, loop
+            mDecoder->Rewind();
+            decoded = DecodeFrame(frame);
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!decoded) {
+            mFailed = true;
+            mDecoding = false;
+            return;
+        }
+        mDecoded.push_back(std::move(frame));
+    }
+}
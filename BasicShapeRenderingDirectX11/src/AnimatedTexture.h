@@ -0,0 +1,80 @@
+#pragma once
+#include <d3d11.h>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class GifDecoder;
+class MappedFile;
+class ThreadPool;
+
+// Flipbook texture played from an animated GIF, one Texture2DArray slice per frame.
+// Animations of up to ringSize frames are decoded once and loop from GPU memory. Longer
+// ones stream through a ring of ringSize slices: a worker decodes ahead while the render
+// thread writes finished frames over slices that have already been shown, so neither the
+// GPU nor the CPU ever holds more than about two rings of frames. Shaders sample the array
+// at GetCurrentSlice().
+class AnimatedTexture
+{
+public:
+	AnimatedTexture(const std::string& path, ID3D11Device* dev, ThreadPool& pool, UINT ringSize = 8);
+	AnimatedTexture(const std::string& path, ID3D11Device* dev, UINT ringSize = 8);
+	~AnimatedTexture();
+
+	AnimatedTexture(const AnimatedTexture&) = delete;
+	AnimatedTexture& operator=(const AnimatedTexture&) = delete;
+
+	// Call once per frame on the render thread: advances playback by the frame time and
+	// uploads whatever the worker has decoded since. If decoding falls behind, the current
+	// frame is held rather than skipped.
+	void Update(ID3D11DeviceContext* devcon, float deltaSeconds);
+
+	ID3D11ShaderResourceView* GetTextureView() const { return mTextureView; }
+	UINT GetCurrentSlice() const { return static_cast<UINT>(mDisplayed % mSliceCount); }
+	UINT GetSliceCount() const { return mSliceCount; }
+	int GetWidth() const { return mWidth; }
+	int GetHeight() const { return mHeight; }
+	// Whole animation is on the GPU and nothing more is decoded
+	bool IsFullyResident() const { return !mDecoder; }
+
+private:
+	struct Frame {
+		std::vector<unsigned char> pixels;
+		int delayMs = 0;
+	};
+
+	void UploadDecoded(ID3D11DeviceContext* devcon);
+	bool DecodeFrame(Frame& frame);
+	void DecodeAhead();
+	void StartDecodeAhead();
+
+private:
+	ThreadPool& mPool;
+	ID3D11Texture2D* mTexture = nullptr;
+	ID3D11ShaderResourceView* mTextureView = nullptr;
+	UINT mSliceCount = 0;
+	int mWidth = 0;
+	int mHeight = 0;
+
+	// playback counts frames shown since the start, including repeats, so a frame's slice
+	// is its sequence number modulo the slice count
+	long long mDisplayed = 0;
+	long long mUploaded = 0;
+	float mElapsedMs = 0.0f;
+	std::vector<int> mSliceDelays;
+
+	// only the worker touches the decoder once playback has started
+	std::unique_ptr<MappedFile> mFile;
+	std::unique_ptr<GifDecoder> mDecoder;
+
+	std::mutex mMutex;
+	std::deque<Frame> mDecoded;
+	std::vector<std::vector<unsigned char>> mSpareBuffers;
+	bool mDecoding = false;
+	bool mStopping = false;
+	bool mFailed = false;
+	std::future<void> mTask;
+};
@@ -0,0 +1,492 @@
+#include "AsyncFileReader.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define ASYNC_FILE_READER_IO_URING
+#include <cstdint>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+#endif
+#endif
+
+namespace {
+
+// Large files go out as several requests so one texture cannot hog the queue
+const size_t kChunkSize = 8 * 1024 * 1024;
+
+} // namespace
+
+struct AsyncFileReader::Request {
+#if defined(_WIN32)
+    OVERLAPPED overlapped;
+    HANDLE file = INVALID_HANDLE_VALUE;
+#else
+    int file = -1;
+#endif
+#if defined(ASYNC_FILE_READER_IO_URING)
+    iovec chunk;
+#endif
+    std::string path;
+    Callback onComplete;
+    std::vector<unsigned char> bytes;
+    size_t offset = 0;
+};
+
+#if defined(ASYNC_FILE_READER_IO_URING)
+
+// The submission and completion rings shared with the kernel, driven with raw system calls
+// so there is no liburing dependency. Any thread may submit; only the completion thread
+// reaps.
+struct AsyncFileReader::Uring {
+    int fd = -1;
+    void* ringMap = MAP_FAILED;
+    size_t ringSize = 0;
+    void* completionMap = MAP_FAILED;
+    size_t completionSize = 0;
+    void* entryMap = MAP_FAILED;
+    size_t entrySize = 0;
+
+    unsigned* submitTail = nullptr;
+    unsigned* submitMask = nullptr;
+    unsigned* submitArray = nullptr;
+    io_uring_sqe* entries = nullptr;
+    unsigned* completeHead = nullptr;
+    unsigned* completeTail = nullptr;
+    unsigned* completeMask = nullptr;
+    io_uring_cqe* completions = nullptr;
+    std::mutex submitMutex;
+
+    ~Uring()
+    {
+        if (entryMap != MAP_FAILED)
+            munmap(entryMap, entrySize);
+        if (completionMap != MAP_FAILED && completionMap != ringMap)
+            munmap(completionMap, completionSize);
+        if (ringMap != MAP_FAILED)
+            munmap(ringMap, ringSize);
+        if (fd >= 0)
+            close(fd);
+    }
+
+    // False when the kernel has no io_uring or it is switched off, which callers treat as
+    // "use the fallback pool"
+    bool Setup(unsigned depth)
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, depth, &params));
+        if (fd < 0)
+            return false;
+
+        ringSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        completionSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        // newer kernels put both rings in one mapping
+        bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single)
+            ringSize = completionSize = std::max(ringSize, completionSize);
+
+        ringMap = mmap(nullptr, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (ringMap == MAP_FAILED)
+            return false;
+        completionMap = single ? ringMap
+            : mmap(nullptr, completionSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (completionMap == MAP_FAILED)
+            return false;
+        entrySize = params.sq_entries * sizeof(io_uring_sqe);
+        entryMap = mmap(nullptr, entrySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (entryMap == MAP_FAILED)
+            return false;
+
+        unsigned char* ring = static_cast<unsigned char*>(ringMap);
+        submitTail = reinterpret_cast<unsigned*>(ring + params.sq_off.tail);
+        submitMask = reinterpret_cast<unsigned*>(ring + params.sq_off.ring_mask);
+        submitArray = reinterpret_cast<unsigned*>(ring + params.sq_off.array);
+        entries = static_cast<io_uring_sqe*>(entryMap);
+        unsigned char* completion = static_cast<unsigned char*>(completionMap);
+        completeHead = reinterpret_cast<unsigned*>(completion + params.cq_off.head);
+        completeTail = reinterpret_cast<unsigned*>(completion + params.cq_off.tail);
+        completeMask = reinterpret_cast<unsigned*>(completion + params.cq_off.ring_mask);
+        completions = reinterpret_cast<io_uring_cqe*>(completion + params.cq_off.cqes);
+        return true;
+    }
+
+    // Each request has at most one entry in flight and the ring is deeper than the in-flight
+    // cap, so there is always a free slot
+    bool Submit(unsigned char opcode, int file, const iovec* vector, uint64_t offset, uint64_t userData)
+    {
+        std::lock_guard<std::mutex> lock(submitMutex);
+        unsigned tail = *submitTail;
+        unsigned index = tail & *submitMask;
+        io_uring_sqe& entry = entries[index];
+        std::memset(&entry, 0, sizeof(entry));
+        entry.opcode = opcode;
+        entry.fd = file;
+        entry.addr = reinterpret_cast<uint64_t>(vector);
+        entry.len = vector ? 1 : 0;
+        entry.off = offset;
+        entry.user_data = userData;
+        submitArray[index] = index;
+        __atomic_store_n(submitTail, tail + 1, __ATOMIC_RELEASE);
+
+        for (;;) {
+            long submitted = syscall(__NR_io_uring_enter, fd, 1, 0, 0, nullptr, 0);
+            if (submitted >= 0)
+                return submitted == 1;
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                return false;
+            std::this_thread::yield();
+        }
+    }
+
+    // Blocks until a completion is available
+    io_uring_cqe Wait()
+    {
+        unsigned head = *completeHead;
+        while (head == __atomic_load_n(completeTail, __ATOMIC_ACQUIRE))
+            syscall(__NR_io_uring_enter, fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        io_uring_cqe completion = completions[head & *completeMask];
+        __atomic_store_n(completeHead, head + 1, __ATOMIC_RELEASE);
+        return completion;
+    }
+};
+
+#else
+
+struct AsyncFileReader::Uring {
+};
+
+#endif
+
+AsyncFileReader::AsyncFileReader(size_t ioThreads, size_t maxInFlight)
+    : mMaxInFlight(std::max<size_t>(1, maxInFlight))
+{
+#if defined(_WIN32)
+    // one thread drains every completion, the reads themselves need none
+    mPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+    if (mPort)
+        mCompletionThread = std::thread(&AsyncFileReader::CompletionLoop, this);
+#elif defined(ASYNC_FILE_READER_IO_URING)
+    // room for every read in flight plus the shutdown marker
+    mMaxInFlight = std::min<size_t>(mMaxInFlight, 4096);
+    mUring.reset(new Uring);
+    if (mUring->Setup(static_cast<unsigned>(mMaxInFlight + 1)))
+        mCompletionThread = std::thread(&AsyncFileReader::CompletionLoop, this);
+    else
+        mUring.reset();
+#endif
+    if (!mPort && !mUring)
+        mFallback.reset(new ThreadPool(std::max<size_t>(1, ioThreads)));
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+    WaitAll();
+#if defined(_WIN32)
+    if (mPort) {
+        // a completion without an OVERLAPPED tells the loop to exit
+        PostQueuedCompletionStatus(mPort, 0, 0, nullptr);
+        mCompletionThread.join();
+        CloseHandle(mPort);
+    }
+#elif defined(ASYNC_FILE_READER_IO_URING)
+    if (mUring) {
+        // so does a no-op without a request
+        if (mUring->Submit(IORING_OP_NOP, -1, nullptr, 0, 0))
+            mCompletionThread.join();
+        else
+            mCompletionThread.detach();
+    }
+#endif
+}
+
+AsyncFileReader& AsyncFileReader::Default()
+{
+    static AsyncFileReader reader;
+    return reader;
+}
+
+void AsyncFileReader::Read(const std::string& path, Callback onComplete)
+{
+    std::unique_ptr<Request> request(new Request);
+    request->path = path;
+    request->onComplete = std::move(onComplete);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    ++mOutstanding;
+    if (mPort || mUring) {
+        mQueued.push_back(std::move(request));
+        StartQueued(lock);
+        return;
+    }
+    lock.unlock();
+
+    std::shared_ptr<Request> job(std::move(request));
+    mFallback->Submit([this, job]() {
+        std::exception_ptr error;
+        try {
+            job->bytes = ReadAll(job->path);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        job->onComplete(std::move(job->bytes), error);
+
+        std::lock_guard<std::mutex> guard(mMutex);
+        if (--mOutstanding == 0)
+            mIdle.notify_all();
+    });
+}
+
+void AsyncFileReader::WaitAll()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mIdle.wait(lock, [this]() { return mOutstanding == 0; });
+}
+
+void AsyncFileReader::StartQueued(std::unique_lock<std::mutex>& lock)
+{
+    while (mInFlight < mMaxInFlight && !mQueued.empty()) {
+        Request* request = mQueued.front().release();
+        mQueued.pop_front();
+        ++mInFlight;
+
+        // opening can block on the file system, so do it without the lock. An empty file
+        // has nothing to read and is finished here, before anything is queued.
+        lock.unlock();
+        bool opened = Open(request);
+        bool empty = opened && request->bytes.empty();
+        bool issued = opened && !empty && IssueRead(request);
+        lock.lock();
+        if (!issued) {
+            --mInFlight;
+            lock.unlock();
+            Finish(request, empty ? nullptr : std::make_exception_ptr(std::runtime_error("Failed to read " + request->path)));
+            lock.lock();
+        }
+    }
+}
+
+void AsyncFileReader::Completed(Request* request, size_t transferred)
+{
+    if (transferred == 0) {
+        Finish(request, std::make_exception_ptr(std::runtime_error("Failed to read " + request->path)));
+    } else {
+        request->offset += transferred;
+        if (request->offset == request->bytes.size())
+            Finish(request, nullptr);
+        else if (!IssueRead(request))
+            Finish(request, std::make_exception_ptr(std::runtime_error("Failed to read " + request->path)));
+        else
+            return;
+    }
+
+    // a finished file frees a slot for the next queued one
+    std::unique_lock<std::mutex> lock(mMutex);
+    --mInFlight;
+    StartQueued(lock);
+}
+
+void AsyncFileReader::Finish(Request* request, std::exception_ptr error)
+{
+    std::unique_ptr<Request> owned(request);
+#if defined(_WIN32)
+    if (request->file != INVALID_HANDLE_VALUE)
+        CloseHandle(request->file);
+#else
+    if (request->file >= 0)
+        close(request->file);
+#endif
+    request->onComplete(std::move(request->bytes), error);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (--mOutstanding == 0)
+        mIdle.notify_all();
+}
+
+#if defined(_WIN32)
+
+bool AsyncFileReader::Open(Request* request)
+{
+    request->file = CreateFileA(request->path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (request->file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(request->file, &size))
+        return false;
+    if (size.QuadPart > 0 && !CreateIoCompletionPort(request->file, mPort, 0, 0))
+        return false;
+    request->bytes.resize(static_cast<size_t>(size.QuadPart));
+    return true;
+}
+
+bool AsyncFileReader::IssueRead(Request* request)
+{
+    // the completion is queued on the port even if the read finishes immediately
+    ZeroMemory(&request->overlapped, sizeof(request->overlapped));
+    ULONGLONG offset = request->offset;
+    request->overlapped.Offset = static_cast<DWORD>(offset);
+    request->overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    DWORD chunk = static_cast<DWORD>(std::min(kChunkSize, request->bytes.size() - request->offset));
+    if (!ReadFile(request->file, request->bytes.data() + request->offset, chunk, nullptr, &request->overlapped))
+        return GetLastError() == ERROR_IO_PENDING;
+    return true;
+}
+
+void AsyncFileReader::CompletionLoop()
+{
+    for (;;) {
+        DWORD transferred = 0;
+        ULONG_PTR key = 0;
+        OVERLAPPED* overlapped = nullptr;
+        BOOL ok = GetQueuedCompletionStatus(mPort, &transferred, &key, &overlapped, INFINITE);
+        if (!overlapped)
+            return;
+
+        Request* request = CONTAINING_RECORD(overlapped, Request, overlapped);
+        Completed(request, ok ? transferred : 0);
+    }
+}
+
+std::vector<unsigned char> AsyncFileReader::ReadAll(const std::string& path)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Failed to open " + path);
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to read " + path);
+    }
+
+    // an OVERLAPPED on a synchronous handle gives positional reads, like pread
+    std::vector<unsigned char> bytes(static_cast<size_t>(size.QuadPart));
+    for (size_t offset = 0; offset < bytes.size();) {
+        OVERLAPPED position = {};
+        position.Offset = static_cast<DWORD>(static_cast<ULONGLONG>(offset));
+        position.OffsetHigh = static_cast<DWORD>(static_cast<ULONGLONG>(offset) >> 32);
+        DWORD chunk = static_cast<DWORD>(std::min(kChunkSize, bytes.size() - offset));
+        DWORD transferred = 0;
+        if (!ReadFile(file, bytes.data() + offset, chunk, &transferred, &position) || transferred == 0) {
+            CloseHandle(file);
+            throw std::runtime_error("Failed to read " + path);
+        }
+        offset += transferred;
+    }
+    CloseHandle(file);
+    return bytes;
+}
+
+#else
+
+bool AsyncFileReader::Open(Request* request)
+{
+    request->file = open(request->path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (request->file < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(request->file, &info) != 0)
+        return false;
+#if defined(POSIX_FADV_SEQUENTIAL)
+    posix_fadvise(request->file, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    request->bytes.resize(static_cast<size_t>(info.st_size));
+    return true;
+}
+
+#if defined(ASYNC_FILE_READER_IO_URING)
+
+bool AsyncFileReader::IssueRead(Request* request)
+{
+    // READV rather than READ so kernels back to 5.1 take it
+    size_t chunk = std::min(kChunkSize, request->bytes.size() - request->offset);
+    request->chunk.iov_base = request->bytes.data() + request->offset;
+    request->chunk.iov_len = chunk;
+    return mUring->Submit(IORING_OP_READV, request->file, &request->chunk, request->offset, reinterpret_cast<uint64_t>(request));
+}
+
+void AsyncFileReader::CompletionLoop()
+{
+    for (;;) {
+        io_uring_cqe completion = mUring->Wait();
+        if (completion.user_data == 0)
+            return;
+
+        Request* request = reinterpret_cast<Request*>(completion.user_data);
+        if (completion.res == -EINTR || completion.res == -EAGAIN) {
+            if (IssueRead(request))
+                continue;
+            completion.res = -EIO;
+        }
+        // 0 means the file got shorter since it was opened
+        Completed(request, completion.res > 0 ? static_cast<size_t>(completion.res) : 0);
+    }
+}
+
+#else
+
+// Without a ring Read() never queues, so these are unreachable
+bool AsyncFileReader::IssueRead(Request*)
+{
+    return false;
+}
+
+void AsyncFileReader::CompletionLoop()
+{
+}
+
+#endif
+
+std::vector<unsigned char> AsyncFileReader::ReadAll(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw std::runtime_error("Failed to open " + path);
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("Failed to read " + path);
+    }
+#if defined(POSIX_FADV_SEQUENTIAL)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    std::vector<unsigned char> bytes(static_cast<size_t>(info.st_size));
+    for (size_t offset = 0; offset < bytes.size();) {
+        size_t chunk = std::min(kChunkSize, bytes.size() - offset);
+        ssize_t transferred = pread(fd, bytes.data() + offset, chunk, static_cast<off_t>(offset));
+        if (transferred < 0 && errno == EINTR)
+            continue;
+        if (transferred <= 0) {
+            close(fd);
+            throw std::runtime_error("Failed to read " + path);
+        }
+        offset += static_cast<size_t>(transferred);
+    }
+    close(fd);
+    return bytes;
+}
+
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ThreadPool;
+
+// Reads whole files in the background and hands each buffer to a callback. On Windows all
+// pending reads are overlapped requests on one I/O completion port, on Linux they are
+// batched through an io_uring, so hundreds of files keep the disk queue full from a single
+// thread. Elsewhere, or if the kernel refuses the port or ring, a small pool of threads
+// does blocking positional reads instead. Empty files complete with an empty buffer.
+class AsyncFileReader
+{
+public:
+	// Called once per file on an I/O thread, with the contents or with the exception that
+	// stopped the read. Keep it short and pass real work such as decoding to another pool.
+	using Callback = std::function<void(std::vector<unsigned char> bytes, std::exception_ptr error)>;
+
+	// ioThreads sizes the fallback pool, maxInFlight caps the reads outstanding at once
+	explicit AsyncFileReader(size_t ioThreads = 4, size_t maxInFlight = 64);
+	// Waits for every callback to finish
+	~AsyncFileReader();
+
+	AsyncFileReader(const AsyncFileReader&) = delete;
+	AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+	// Thread-safe
+	void Read(const std::string& path, Callback onComplete);
+	// Blocks until every read issued so far has delivered its callback
+	void WaitAll();
+
+	bool IsUsingCompletionPort() const { return mPort != nullptr; }
+	bool IsUsingIoUring() const { return mUring != nullptr; }
+
+	// Blocking read of a whole file with positional reads, what the fallback pool runs
+	static std::vector<unsigned char> ReadAll(const std::string& path);
+
+	// Process-wide reader shared by the asset pipeline
+	static AsyncFileReader& Default();
+
+private:
+	struct Request;
+	struct Uring;
+
+	void StartQueued(std::unique_lock<std::mutex>& lock);
+	// Opens the file and sizes the buffer
+	bool Open(Request* request);
+	// Queues the next chunk
+	bool IssueRead(Request* request);
+	void CompletionLoop();
+	// transferred is 0 for a failed read
+	void Completed(Request* request, size_t transferred);
+	void Finish(Request* request, std::exception_ptr error);
+
+private:
+	void* mPort = nullptr;
+	std::unique_ptr<Uring> mUring;
+	std::thread mCompletionThread;
+	std::unique_ptr<ThreadPool> mFallback;
+
+	size_t mMaxInFlight;
+	size_t mInFlight = 0;
+	size_t mOutstanding = 0;
+	std::deque<std::unique_ptr<Request>> mQueued;
+	std::mutex mMutex;
+	std::condition_variable mIdle;
+};
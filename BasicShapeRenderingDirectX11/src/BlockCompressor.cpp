@@ -0,0 +1,655 @@
+#include "BlockCompressor.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <emmintrin.h>
+#include <stdexcept>
+
+namespace {
+
+// One 4x4 block as structure-of-arrays floats so four texels fit in an SSE register
+struct Block {
+    alignas(16) float c[4][16];
+};
+
+void LoadBlock(const unsigned char* rgba, Block& block)
+{
+    for (int i = 0; i < 16; ++i)
+        for (int ch = 0; ch < 4; ++ch)
+            block.c[ch][i] = rgba[i * 4 + ch];
+}
+
+inline float HorizontalMin(__m128 v)
+{
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtss_f32(v);
+}
+
+inline float HorizontalMax(__m128 v)
+{
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtss_f32(v);
+}
+
+inline float HorizontalSum(__m128 v)
+{
+    v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtss_f32(v);
+}
+
+// Per-channel bounding box, pulled in by 1/inset of the range to reduce the quantization error
+void BoundingBoxEndpoints(const Block& block, int channels, float inset, float lo[4], float hi[4])
+{
+    for (int ch = 0; ch < channels; ++ch) {
+        const float* c = block.c[ch];
+        __m128 mn = _mm_min_ps(_mm_min_ps(_mm_load_ps(c), _mm_load_ps(c + 4)), _mm_min_ps(_mm_load_ps(c + 8), _mm_load_ps(c + 12)));
+        __m128 mx = _mm_max_ps(_mm_max_ps(_mm_load_ps(c), _mm_load_ps(c + 4)), _mm_max_ps(_mm_load_ps(c + 8), _mm_load_ps(c + 12)));
+        float minValue = HorizontalMin(mn);
+        float maxValue = HorizontalMax(mx);
+        float pad = (maxValue - minValue) / inset;
+        lo[ch] = minValue + pad;
+        hi[ch] = maxValue - pad;
+    }
+}
+
+// Endpoints at the extremes of the texels projected onto the principal axis
+void PrincipalAxisEndpoints(const Block& block, int channels, float lo[4], float hi[4])
+{
+    float mean[4] = {};
+    for (int ch = 0; ch < channels; ++ch) {
+        const float* c = block.c[ch];
+        __m128 sum = _mm_add_ps(_mm_add_ps(_mm_load_ps(c), _mm_load_ps(c + 4)), _mm_add_ps(_mm_load_ps(c + 8), _mm_load_ps(c + 12)));
+        mean[ch] = HorizontalSum(sum) / 16.0f;
+    }
+
+    float covariance[4][4] = {};
+    for (int i = 0; i < channels; ++i) {
+        for (int j = i; j < channels; ++j) {
+            __m128 mi = _mm_set1_ps(mean[i]);
+            __m128 mj = _mm_set1_ps(mean[j]);
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < 16; k += 4) {
+                __m128 di = _mm_sub_ps(_mm_load_ps(block.c[i] + k), mi);
+                __m128 dj = _mm_sub_ps(_mm_load_ps(block.c[j] + k), mj);
+                acc = _mm_add_ps(acc, _mm_mul_ps(di, dj));
+            }
+            covariance[i][j] = covariance[j][i] = HorizontalSum(acc);
+        }
+    }
+
+    // power iteration, seeded with the bounding box diagonal
+    float axis[4] = {};
+    float boxLo[4], boxHi[4];
+    BoundingBoxEndpoints(block, channels, FLT_MAX, boxLo, boxHi);
+    for (int ch = 0; ch < channels; ++ch)
+        axis[ch] = boxHi[ch] - boxLo[ch];
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        float next[4] = {};
+        float length = 0.0f;
+        for (int i = 0; i < channels; ++i) {
+            for (int j = 0; j < channels; ++j)
+                next[i] += covariance[i][j] * axis[j];
+            length = std::max(length, std::fabs(next[i]));
+        }
+        if (length < 1e-6f)
+            break;
+        for (int i = 0; i < channels; ++i)
+            axis[i] = next[i] / length;
+    }
+
+    float axisLength = 0.0f;
+    for (int ch = 0; ch < channels; ++ch)
+        axisLength += axis[ch] * axis[ch];
+    if (axisLength < 1e-12f) {
+        // flat block, every texel equals the mean
+        for (int ch = 0; ch < channels; ++ch)
+            lo[ch] = hi[ch] = mean[ch];
+        return;
+    }
+    for (int ch = 0; ch < channels; ++ch)
+        axis[ch] /= std::sqrt(axisLength);
+
+    __m128 minProjection = _mm_set1_ps(FLT_MAX);
+    __m128 maxProjection = _mm_set1_ps(-FLT_MAX);
+    for (int k = 0; k < 16; k += 4) {
+        __m128 t = _mm_setzero_ps();
+        for (int ch = 0; ch < channels; ++ch)
+            t = _mm_add_ps(t, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(block.c[ch] + k), _mm_set1_ps(mean[ch])), _mm_set1_ps(axis[ch])));
+        minProjection = _mm_min_ps(minProjection, t);
+        maxProjection = _mm_max_ps(maxProjection, t);
+    }
+    float tMin = HorizontalMin(minProjection);
+    float tMax = HorizontalMax(maxProjection);
+    for (int ch = 0; ch < channels; ++ch) {
+        lo[ch] = std::min(255.0f, std::max(0.0f, mean[ch] + axis[ch] * tMin));
+        hi[ch] = std::min(255.0f, std::max(0.0f, mean[ch] + axis[ch] * tMax));
+    }
+}
+
+// Picks the nearest palette entry for every texel, four texels per SSE iteration.
+// Returns the summed squared error.
+float SelectIndices(const Block& block, int channels, const float (*palette)[4], int paletteSize, int indices[16])
+{
+    float error = 0.0f;
+    for (int k = 0; k < 16; k += 4) {
+        __m128 texel[4];
+        for (int ch = 0; ch < channels; ++ch)
+            texel[ch] = _mm_load_ps(block.c[ch] + k);
+
+        __m128 best = _mm_set1_ps(FLT_MAX);
+        __m128 bestIndex = _mm_setzero_ps();
+        for (int p = 0; p < paletteSize; ++p) {
+            __m128 distance = _mm_setzero_ps();
+            for (int ch = 0; ch < channels; ++ch) {
+                __m128 d = _mm_sub_ps(texel[ch], _mm_set1_ps(palette[p][ch]));
+                distance = _mm_add_ps(distance, _mm_mul_ps(d, d));
+            }
+            __m128 closer = _mm_cmplt_ps(distance, best);
+            best = _mm_min_ps(best, distance);
+            bestIndex = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps((float)p)), _mm_andnot_ps(closer, bestIndex));
+        }
+
+        _mm_storeu_si128((__m128i*)(indices + k), _mm_cvttps_epi32(bestIndex));
+        error += HorizontalSum(best);
+    }
+    return error;
+}
+
+// Least-squares endpoints for fixed indices; weights[i] is how much of endpoint 0 index i takes
+bool RefineEndpoints(const Block& block, int channels, const int indices[16], const float* weights, float lo[4], float hi[4])
+{
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+    float ax[4] = {}, bx[4] = {};
+    for (int i = 0; i < 16; ++i) {
+        float a = weights[indices[i]];
+        float b = 1.0f - a;
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        for (int ch = 0; ch < channels; ++ch) {
+            ax[ch] += a * block.c[ch][i];
+            bx[ch] += b * block.c[ch][i];
+        }
+    }
+
+    float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f)
+        return false;
+    float inverse = 1.0f / determinant;
+    for (int ch = 0; ch < channels; ++ch) {
+        hi[ch] = std::min(255.0f, std::max(0.0f, (ax[ch] * bb - bx[ch] * ab) * inverse));
+        lo[ch] = std::min(255.0f, std::max(0.0f, (bx[ch] * aa - ax[ch] * ab) * inverse));
+    }
+    return true;
+}
+
+inline uint16_t PackRGB565(const float c[4])
+{
+    int r = std::min(31, std::max(0, (int)(c[0] * 31.0f / 255.0f + 0.5f)));
+    int g = std::min(63, std::max(0, (int)(c[1] * 63.0f / 255.0f + 0.5f)));
+    int b = std::min(31, std::max(0, (int)(c[2] * 31.0f / 255.0f + 0.5f)));
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+inline void UnpackRGB565(uint16_t packed, float c[4])
+{
+    int r = (packed >> 11) & 31;
+    int g = (packed >> 5) & 63;
+    int b = packed & 31;
+    c[0] = (float)((r << 3) | (r >> 2));
+    c[1] = (float)((g << 2) | (g >> 4));
+    c[2] = (float)((b << 3) | (b >> 2));
+    c[3] = 255.0f;
+}
+
+// Four-colour BC1 palette in the order the hardware indexes it
+void BuildBC1Palette(uint16_t c0, uint16_t c1, float palette[4][4])
+{
+    UnpackRGB565(c0, palette[0]);
+    UnpackRGB565(c1, palette[1]);
+    for (int ch = 0; ch < 4; ++ch) {
+        palette[2][ch] = (2.0f * palette[0][ch] + palette[1][ch]) / 3.0f;
+        palette[3][ch] = (palette[0][ch] + 2.0f * palette[1][ch]) / 3.0f;
+    }
+}
+
+// Writes the 8-byte colour half shared by BC1 and BC3, always in four-colour mode
+void EncodeColorBlock(const Block& block, unsigned char* out, CompressionQuality quality)
+{
+    static const float kWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+    float lo[4], hi[4];
+    if (quality == CompressionQuality::High)
+        PrincipalAxisEndpoints(block, 3, lo, hi);
+    else
+        BoundingBoxEndpoints(block, 3, 16.0f, lo, hi);
+
+    uint16_t bestC0 = 0, bestC1 = 0;
+    int bestIndices[16] = {};
+    float bestError = FLT_MAX;
+    int iterations = quality == CompressionQuality::High ? 3 : 1;
+
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        uint16_t c0 = PackRGB565(hi);
+        uint16_t c1 = PackRGB565(lo);
+        if (c0 < c1)
+            std::swap(c0, c1);
+
+        int indices[16] = {};
+        float error = 0.0f;
+        if (c0 != c1) {
+            float palette[4][4];
+            BuildBC1Palette(c0, c1, palette);
+            error = SelectIndices(block, 3, palette, 4, indices);
+        }
+        else {
+            float palette[1][4];
+            UnpackRGB565(c0, palette[0]);
+            error = SelectIndices(block, 3, palette, 1, indices);
+        }
+
+        if (error < bestError) {
+            bestError = error;
+            bestC0 = c0;
+            bestC1 = c1;
+            std::memcpy(bestIndices, indices, sizeof(indices));
+        }
+        if (c0 == c1 || !RefineEndpoints(block, 3, indices, kWeights, lo, hi))
+            break;
+    }
+
+    uint32_t packedIndices = 0;
+    for (int i = 0; i < 16; ++i)
+        packedIndices |= (uint32_t)bestIndices[i] << (i * 2);
+
+    out[0] = (unsigned char)(bestC0 & 0xFF);
+    out[1] = (unsigned char)(bestC0 >> 8);
+    out[2] = (unsigned char)(bestC1 & 0xFF);
+    out[3] = (unsigned char)(bestC1 >> 8);
+    std::memcpy(out + 4, &packedIndices, 4);
+}
+
+// BC4-style 8-value alpha block (a0 > a1)
+void EncodeAlphaBlock(const Block& block, unsigned char* out)
+{
+    float lo[4], hi[4];
+    BoundingBoxEndpoints(block, 4, FLT_MAX, lo, hi);
+    int a0 = (int)hi[3];
+    int a1 = (int)lo[3];
+
+    uint64_t bits = 0;
+    if (a0 != a1) {
+        float palette[8];
+        palette[0] = (float)a0;
+        palette[1] = (float)a1;
+        for (int i = 2; i < 8; ++i)
+            palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7.0f;
+
+        for (int i = 0; i < 16; ++i) {
+            float a = block.c[3][i];
+            int best = 0;
+            float bestDistance = FLT_MAX;
+            for (int p = 0; p < 8; ++p) {
+                float d = std::fabs(a - palette[p]);
+                if (d < bestDistance) {
+                    bestDistance = d;
+                    best = p;
+                }
+            }
+            bits |= (uint64_t)best << (i * 3);
+        }
+    }
+
+    out[0] = (unsigned char)a0;
+    out[1] = (unsigned char)a1;
+    for (int i = 0; i < 6; ++i)
+        out[2 + i] = (unsigned char)(bits >> (i * 8));
+}
+
+// Little-endian bit stream over a 16-byte block
+struct BitWriter {
+    unsigned char* out;
+    int position = 0;
+
+    void Write(uint32_t value, int count)
+    {
+        for (int i = 0; i < count; ++i, ++position) {
+            if (value & (1u << i))
+                out[position >> 3] |= (unsigned char)(1u << (position & 7));
+        }
+    }
+};
+
+struct BitReader {
+    const unsigned char* in;
+    int position = 0;
+
+    uint32_t Read(int count)
+    {
+        uint32_t value = 0;
+        for (int i = 0; i < count; ++i, ++position)
+            value |= (uint32_t)((in[position >> 3] >> (position & 7)) & 1) << i;
+        return value;
+    }
+};
+
+const int kBC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// Mode 6 endpoint: 7 bits per channel plus a shared p-bit
+struct BC7Endpoint {
+    int q[4];
+    int p;
+
+    void Expand(float c[4]) const
+    {
+        for (int ch = 0; ch < 4; ++ch)
+            c[ch] = (float)((q[ch] << 1) | p);
+    }
+};
+
+BC7Endpoint QuantizeBC7Endpoint(const float c[4], int p)
+{
+    BC7Endpoint e;
+    e.p = p;
+    for (int ch = 0; ch < 4; ++ch)
+        e.q[ch] = std::min(127, std::max(0, (int)std::floor((c[ch] - p) * 0.5f + 0.5f)));
+    return e;
+}
+
+float EndpointError(const BC7Endpoint& e, const float c[4])
+{
+    float expanded[4];
+    e.Expand(expanded);
+    float error = 0.0f;
+    for (int ch = 0; ch < 4; ++ch)
+        error += (expanded[ch] - c[ch]) * (expanded[ch] - c[ch]);
+    return error;
+}
+
+void BuildBC7Palette(const BC7Endpoint& e0, const BC7Endpoint& e1, float palette[16][4])
+{
+    float a[4], b[4];
+    e0.Expand(a);
+    e1.Expand(b);
+    for (int i = 0; i < 16; ++i) {
+        int w = kBC7Weights4[i];
+        for (int ch = 0; ch < 4; ++ch)
+            palette[i][ch] = (float)(((64 - w) * (int)a[ch] + w * (int)b[ch] + 32) >> 6);
+    }
+}
+
+} // namespace
+
+void BlockCompressor::EncodeBC1Block(const unsigned char* rgba, unsigned char* block, CompressionQuality quality)
+{
+    Block texels;
+    LoadBlock(rgba, texels);
+    EncodeColorBlock(texels, block, quality);
+}
+
+void BlockCompressor::EncodeBC3Block(const unsigned char* rgba, unsigned char* block, CompressionQuality quality)
+{
+    Block texels;
+    LoadBlock(rgba, texels);
+    EncodeAlphaBlock(texels, block);
+    EncodeColorBlock(texels, block + 8, quality);
+}
+
+void BlockCompressor::EncodeBC7Block(const unsigned char* rgba, unsigned char* block, CompressionQuality quality)
+{
+    // kWeights[i] is the share of endpoint 0 (the "lo" side) for index i
+    static const float kWeights[16] = {
+        1.0f, 60 / 64.0f, 55 / 64.0f, 51 / 64.0f, 47 / 64.0f, 43 / 64.0f, 38 / 64.0f, 34 / 64.0f,
+        30 / 64.0f, 26 / 64.0f, 21 / 64.0f, 17 / 64.0f, 13 / 64.0f, 9 / 64.0f, 4 / 64.0f, 0.0f
+    };
+
+    Block texels;
+    LoadBlock(rgba, texels);
+
+    // the p-bit is shared by all four channels, and with it at 0 alpha tops out at 254; opaque
+    // blocks keep both p-bits at 1 and alpha at 127 so they decode to 255 whatever RGB prefers
+    bool opaque = true;
+    for (int i = 0; i < 16; ++i)
+        opaque = opaque && texels.c[3][i] == 255.0f;
+    auto quantize = [opaque](const float c[4], int p) {
+        BC7Endpoint e = QuantizeBC7Endpoint(c, opaque ? 1 : p);
+        if (opaque)
+            e.q[3] = 127;
+        return e;
+    };
+
+    float lo[4], hi[4];
+    if (quality == CompressionQuality::High)
+        PrincipalAxisEndpoints(texels, 4, lo, hi);
+    else
+        BoundingBoxEndpoints(texels, 4, 32.0f, lo, hi);
+
+    BC7Endpoint best0 = {}, best1 = {};
+    int bestIndices[16] = {};
+    float bestError = FLT_MAX;
+    int iterations = quality == CompressionQuality::High ? 2 : 1;
+
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        // Fast picks each p-bit on its own, High tries every combination
+        int combinations = quality == CompressionQuality::High && !opaque ? 4 : 1;
+        for (int combo = 0; combo < combinations; ++combo) {
+            BC7Endpoint e0, e1;
+            if (quality == CompressionQuality::High) {
+                e0 = quantize(lo, combo & 1);
+                e1 = quantize(hi, combo >> 1);
+            }
+            else {
+                BC7Endpoint a = quantize(lo, 0), b = quantize(lo, 1);
+                e0 = EndpointError(a, lo) <= EndpointError(b, lo) ? a : b;
+                a = quantize(hi, 0);
+                b = quantize(hi, 1);
+                e1 = EndpointError(a, hi) <= EndpointError(b, hi) ? a : b;
+            }
+
+            float palette[16][4];
+            BuildBC7Palette(e0, e1, palette);
+            int indices[16];
+            float error = SelectIndices(texels, 4, palette, 16, indices);
+            if (error < bestError) {
+                bestError = error;
+                best0 = e0;
+                best1 = e1;
+                std::memcpy(bestIndices, indices, sizeof(indices));
+            }
+        }
+
+        if (iteration + 1 < iterations && !RefineEndpoints(texels, 4, bestIndices, kWeights, hi, lo))
+            break;
+    }
+
+    // the anchor index is stored with its top bit implied zero
+    if (bestIndices[0] >= 8) {
+        std::swap(best0, best1);
+        for (int i = 0; i < 16; ++i)
+            bestIndices[i] = 15 - bestIndices[i];
+    }
+
+    std::memset(block, 0, 16);
+    BitWriter writer = { block };
+    writer.Write(1u << 6, 7);
+    for (int ch = 0; ch < 4; ++ch) {
+        writer.Write((uint32_t)best0.q[ch], 7);
+        writer.Write((uint32_t)best1.q[ch], 7);
+    }
+    writer.Write((uint32_t)best0.p, 1);
+    writer.Write((uint32_t)best1.p, 1);
+    writer.Write((uint32_t)bestIndices[0], 3);
+    for (int i = 1; i < 16; ++i)
+        writer.Write((uint32_t)bestIndices[i], 4);
+}
+
+ImageData BlockCompressor::Compress(const ImageData& image, PixelFormat format, CompressionQuality quality)
+{
+    return Compress(image, format, quality, ThreadPool::Default());
+}
+
+ImageData BlockCompressor::Compress(const ImageData& image, PixelFormat format, CompressionQuality quality, ThreadPool& pool)
+{
+    if (image.format != PixelFormat::RGBA8 || image.channels != 4)
+        throw std::runtime_error("Block compression needs an RGBA8 source");
+    if (!IsBlockCompressed(format))
+        throw std::runtime_error("Not a block-compressed format");
+
+    void (*encode)(const unsigned char*, unsigned char*, CompressionQuality) =
+        format == PixelFormat::BC1 ? EncodeBC1Block : format == PixelFormat::BC3 ? EncodeBC3Block : EncodeBC7Block;
+    size_t blockSize = format == PixelFormat::BC1 ? 8 : 16;
+
+    int blocksWide = (image.width + 3) / 4;
+    int blocksHigh = (image.height + 3) / 4;
+    ImageData result = { image.width, image.height, 4, PixelBuffer(GetImageSize(format, image.width, image.height)), format };
+
+    const unsigned char* src = image.data.data();
+    unsigned char* dst = result.data.data();
+    pool.ParallelFor(static_cast<size_t>(blocksHigh), [&](size_t by) {
+        unsigned char texels[64];
+        for (int bx = 0; bx < blocksWide; ++bx) {
+            // edge blocks repeat the last row/column
+            for (int y = 0; y < 4; ++y) {
+                int sy = std::min(static_cast<int>(by) * 4 + y, image.height - 1);
+                for (int x = 0; x < 4; ++x) {
+                    int sx = std::min(bx * 4 + x, image.width - 1);
+                    std::memcpy(texels + (y * 4 + x) * 4, src + (static_cast<size_t>(sy) * image.width + sx) * 4, 4);
+                }
+            }
+            encode(texels, dst + (by * blocksWide + bx) * blockSize, quality);
+        }
+    });
+    return result;
+}
+
+ImageData BlockCompressor::Decompress(const ImageData& image)
+{
+    if (!IsBlockCompressed(image.format))
+        return image;
+
+    ImageData result = { image.width, image.height, 4, PixelBuffer(static_cast<size_t>(image.width) * image.height * 4) };
+    int blocksWide = (image.width + 3) / 4;
+    int blocksHigh = (image.height + 3) / 4;
+    size_t blockSize = image.format == PixelFormat::BC1 ? 8 : 16;
+
+    for (int by = 0; by < blocksHigh; ++by) {
+        for (int bx = 0; bx < blocksWide; ++bx) {
+            const unsigned char* in = image.data.data() + (static_cast<size_t>(by) * blocksWide + bx) * blockSize;
+            unsigned char texels[16][4];
+
+            if (image.format == PixelFormat::BC7) {
+                BitReader reader = { in };
+                if (reader.Read(7) != (1u << 6))
+                    throw std::runtime_error("Only BC7 mode 6 blocks can be decoded");
+                BC7Endpoint e0, e1;
+                for (int ch = 0; ch < 4; ++ch) {
+                    e0.q[ch] = (int)reader.Read(7);
+                    e1.q[ch] = (int)reader.Read(7);
+                }
+                e0.p = (int)reader.Read(1);
+                e1.p = (int)reader.Read(1);
+                float palette[16][4];
+                BuildBC7Palette(e0, e1, palette);
+                for (int i = 0; i < 16; ++i) {
+                    int index = (int)reader.Read(i == 0 ? 3 : 4);
+                    for (int ch = 0; ch < 4; ++ch)
+                        texels[i][ch] = (unsigned char)palette[index][ch];
+                }
+            }
+            else {
+                const unsigned char* color = image.format == PixelFormat::BC3 ? in + 8 : in;
+                uint16_t c0 = (uint16_t)(color[0] | (color[1] << 8));
+                uint16_t c1 = (uint16_t)(color[2] | (color[3] << 8));
+                uint32_t indices;
+                std::memcpy(&indices, color + 4, 4);
+
+                float palette[4][4];
+                BuildBC1Palette(c0, c1, palette);
+                if (image.format == PixelFormat::BC1 && c0 <= c1) {
+                    // three-colour mode with transparent black
+                    for (int ch = 0; ch < 4; ++ch) {
+                        palette[2][ch] = (palette[0][ch] + palette[1][ch]) * 0.5f;
+                        palette[3][ch] = 0.0f;
+                    }
+                }
+                for (int i = 0; i < 16; ++i) {
+                    const float* c = palette[(indices >> (i * 2)) & 3];
+                    for (int ch = 0; ch < 4; ++ch)
+                        texels[i][ch] = (unsigned char)(c[ch] + 0.5f);
+                }
+
+                if (image.format == PixelFormat::BC3) {
+                    int a0 = in[0], a1 = in[1];
+                    float alphas[8] = { (float)a0, (float)a1 };
+                    for (int i = 2; i < 8; ++i)
+                        alphas[i] = a0 > a1 ? ((8 - i) * a0 + (i - 1) * a1) / 7.0f : (i < 6 ? ((6 - i) * a0 + (i - 1) * a1) / 5.0f : (i == 6 ? 0.0f : 255.0f));
+                    uint64_t bits = 0;
+                    for (int i = 0; i < 6; ++i)
+                        bits |= (uint64_t)in[2 + i] << (i * 8);
+                    for (int i = 0; i < 16; ++i)
+                        texels[i][3] = (unsigned char)(alphas[(bits >> (i * 3)) & 7] + 0.5f);
+                }
+            }
+
+            for (int y = 0; y < 4; ++y) {
+                int dy = by * 4 + y;
+                if (dy >= image.height)
+                    break;
+                for (int x = 0; x < 4; ++x) {
+                    int dx = bx * 4 + x;
+                    if (dx >= image.width)
+                        break;
+                    std::memcpy(result.data.data() + (static_cast<size_t>(dy) * image.width + dx) * 4, texels[y * 4 + x], 4);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+PixelFormat BlockCompressor::ChooseFormat(const ImageData& image, TextureCompression compression)
+{
+    // there are no BC4/BC5/BC6H encoders yet, so everything but RGBA8 stays uncompressed
+    if (image.format != PixelFormat::RGBA8)
+        return image.format;
+    switch (compression) {
+    case TextureCompression::Auto:
+        return HasAlpha(image) ? PixelFormat::BC3 : PixelFormat::BC1;
+    case TextureCompression::BC1:
+        return PixelFormat::BC1;
+    case TextureCompression::BC3:
+        return PixelFormat::BC3;
+    case TextureCompression::BC7:
+        return PixelFormat::BC7;
+    default:
+        return image.format;
+    }
+}
+
+bool BlockCompressor::HasAlpha(const ImageData& image)
+{
+    if (image.format != PixelFormat::RGBA8 || image.channels != 4)
+        return false;
+
+    const unsigned char* p = image.data.data();
+    size_t count = image.data.size();
+    size_t i = 0;
+    const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+    for (; i + 16 <= count; i += 16) {
+        __m128i v = _mm_and_si128(_mm_loadu_si128((const __m128i*)(p + i)), alphaMask);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(v, alphaMask)) != 0xFFFF)
+            return true;
+    }
+    for (i += 3; i < count; i += 4) {
+        if (p[i] != 255)
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "Image.h"
+#include "TextureSettings.h"
+
+class ThreadPool;
+
+// CPU encoder for BC1, BC3 and BC7 (mode 6). Rows of 4x4 blocks are spread across a
+// ThreadPool; endpoint search and index selection run on SSE over the 16 texels of a block.
+class BlockCompressor
+{
+public:
+	static ImageData Compress(const ImageData& image, PixelFormat format, CompressionQuality quality, ThreadPool& pool);
+	static ImageData Compress(const ImageData& image, PixelFormat format, CompressionQuality quality);
+
+	// Decodes back to RGBA8 so the result can be compared against the source.
+	// BC7 support is limited to the mode 6 blocks this encoder writes.
+	static ImageData Decompress(const ImageData& image);
+
+	// Resolves a TextureCompression setting to the format an image should be stored in
+	static PixelFormat ChooseFormat(const ImageData& image, TextureCompression compression);
+	static bool HasAlpha(const ImageData& image);
+
+	// 4x4 RGBA8 texels in, one encoded block out
+	static void EncodeBC1Block(const unsigned char* rgba, unsigned char* block, CompressionQuality quality);
+	static void EncodeBC3Block(const unsigned char* rgba, unsigned char* block, CompressionQuality quality);
+	static void EncodeBC7Block(const unsigned char* rgba, unsigned char* block, CompressionQuality quality);
+};
@@ -1,19 +1,19 @@
 #include "Buffer.h"
 #include <iostream>
 
-VertexBuffer::VertexBuffer(std::vector<float> vertices, ID3D11Device* dev)
+VertexBuffer::VertexBuffer(const float* vertices, size_t count, ID3D11Device* dev)
 {
     // create the vertex buffer
     D3D11_BUFFER_DESC vertexBufferDesc = {};
 
-    vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;                // write access access by CPU and GPU
-    vertexBufferDesc.ByteWidth = vertices.size() * sizeof(float);             // size is the VERTEX struct * 3
+    vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;              // static geometry, GPU access only
+    vertexBufferDesc.ByteWidth = static_cast<UINT>(count * sizeof(float));
     vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;       // use as a vertex buffer
-    vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;    // allow CPU to write in buffer
+    vertexBufferDesc.CPUAccessFlags = 0;
     vertexBufferDesc.MiscFlags = 0;
 
     D3D11_SUBRESOURCE_DATA vertexData = {};
-    vertexData.pSysMem = vertices.data();
+    vertexData.pSysMem = vertices;
 
     HRESULT hr = dev->CreateBuffer(&vertexBufferDesc, &vertexData, &mVertexBuffer);
     if (FAILED(hr))
@@ -22,22 +22,28 @@ VertexBuffer::VertexBuffer(std::vector<float> vertices, ID3D11Device* dev)
         exit(-1);
     }
 }
+
+VertexBuffer::VertexBuffer(const std::vector<float>& vertices, ID3D11Device* dev)
+    : VertexBuffer(vertices.data(), vertices.size(), dev)
+{
+}
+
 VertexBuffer::~VertexBuffer()
 {
     mVertexBuffer->Release();
 }
 
-IndexBuffer::IndexBuffer(std::vector<unsigned int> indices, ID3D11Device* dev)
+IndexBuffer::IndexBuffer(const unsigned int* indices, size_t count, ID3D11Device* dev)
 {
     D3D11_BUFFER_DESC indexBufferDesc = {};
     indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-    indexBufferDesc.ByteWidth = sizeof(unsigned int) * indices.size();
+    indexBufferDesc.ByteWidth = static_cast<UINT>(sizeof(unsigned int) * count);
     indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
     indexBufferDesc.CPUAccessFlags = 0;
     indexBufferDesc.MiscFlags = 0;
 
     D3D11_SUBRESOURCE_DATA indexData = {};
-    indexData.pSysMem = indices.data();
+    indexData.pSysMem = indices;
 
     HRESULT hr = dev->CreateBuffer(&indexBufferDesc, &indexData, &mIndexBuffer);
     if (FAILED(hr))
@@ -46,7 +52,12 @@ IndexBuffer::IndexBuffer(std::vector<unsigned int> indices, ID3D11Device* dev)
         exit(-1);
     }
 
-    mIndicesSize = indices.size();
+    mIndicesSize = count;
+}
+
+IndexBuffer::IndexBuffer(const std::vector<unsigned int>& indices, ID3D11Device* dev)
+    : IndexBuffer(indices.data(), indices.size(), dev)
+{
 }
 
 IndexBuffer::~IndexBuffer()
@@ -5,7 +5,8 @@
 class VertexBuffer
 {
 public:
-	VertexBuffer(std::vector<float> vertices, ID3D11Device* dev);
+	VertexBuffer(const float* vertices, size_t count, ID3D11Device* dev);
+	VertexBuffer(const std::vector<float>& vertices, ID3D11Device* dev);
 	~VertexBuffer();
 	ID3D11Buffer* GetVertexBuffer() { return mVertexBuffer; }
 private:
@@ -15,7 +16,8 @@ private:
 class IndexBuffer
 {
 public:
-	IndexBuffer(std::vector<unsigned int> indices, ID3D11Device* dev);
+	IndexBuffer(const unsigned int* indices, size_t count, ID3D11Device* dev);
+	IndexBuffer(const std::vector<unsigned int>& indices, ID3D11Device* dev);
 	~IndexBuffer();
 	ID3D11Buffer* GetIndexBuffer() const { return mIndexBuffer; }
 	size_t GetIndicesSize() const { return mIndicesSize; }
@@ -0,0 +1,250 @@
+#include "BufferManager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+BufferManager::BufferManager(ID3D11Device* dev, ID3D11DeviceContext* devcon, UINT blockBytes)
+    : mDevice(dev), mContext(devcon), mBlockBytes(blockBytes)
+{
+}
+
+BufferManager::~BufferManager()
+{
+    for (auto& pool : mPools) {
+        for (auto& block : pool->blocks)
+            block->buffer->Release();
+    }
+}
+
+BufferRange BufferManager::Allocate(BufferUsage usage, UINT bindFlags, UINT stride, UINT count, const void* data)
+{
+    if (count == 0 || stride == 0)
+        throw std::runtime_error("Buffer ranges need a non-zero count and stride");
+    if (usage == BufferUsage::Immutable && !data)
+        throw std::runtime_error("Immutable buffer ranges need their data up front");
+    // staging buffers cannot be bound to the pipeline
+    if (usage == BufferUsage::Staging)
+        bindFlags = 0;
+
+    Pool& pool = GetPool(usage, bindFlags, stride);
+    Block* block = nullptr;
+    OffsetAllocator::Allocation allocation;
+    for (auto& candidate : pool.blocks) {
+        allocation = candidate->allocator.Allocate(count);
+        if (allocation.offset != OffsetAllocator::kNoSpace) {
+            block = candidate.get();
+            break;
+        }
+    }
+    if (!block) {
+        block = &AddBlock(pool, count);
+        allocation = block->allocator.Allocate(count);
+    }
+
+    BufferRange range;
+    range.buffer = block->buffer;
+    range.offset = allocation.offset;
+    range.count = count;
+    range.stride = stride;
+    range.usage = usage;
+    range.bindFlags = bindFlags;
+    range.allocation = allocation;
+    if (data)
+        Write(range, data, 0, count);
+    return range;
+}
+
+void BufferManager::Free(BufferRange& range)
+{
+    if (!range.buffer)
+        return;
+
+    Pool& pool = GetPool(range.usage, range.bindFlags, range.stride);
+    auto found = std::find_if(pool.blocks.begin(), pool.blocks.end(),
+        [&](const std::unique_ptr<Block>& block) { return block->buffer == range.buffer; });
+    if (found == pool.blocks.end())
+        throw std::runtime_error("Buffer range does not belong to this manager");
+
+    Block& block = **found;
+    block.allocator.Free(range.allocation);
+    // keep one block per pool so allocating and freeing a single mesh does not thrash
+    if (block.allocator.GetFreeStorage() == block.allocator.GetSize() && pool.blocks.size() > 1) {
+        if (block.buffer == mBoundVertexBuffer || block.buffer == mBoundIndexBuffer)
+            ResetBindings();
+        block.buffer->Release();
+        pool.blocks.erase(found);
+    }
+    range = BufferRange();
+}
+
+Mesh BufferManager::CreateMesh(const void* vertices, UINT vertexCount, UINT stride, const unsigned int* indices, UINT indexCount, BufferUsage usage)
+{
+    Mesh mesh;
+    mesh.vertices = Allocate(usage, D3D11_BIND_VERTEX_BUFFER, stride, vertexCount, vertices);
+    try {
+        mesh.indices = Allocate(usage, D3D11_BIND_INDEX_BUFFER, sizeof(unsigned int), indexCount, indices);
+    }
+    catch (...) {
+        Free(mesh.vertices);
+        throw;
+    }
+    return mesh;
+}
+
+void BufferManager::FreeMesh(Mesh& mesh)
+{
+    Free(mesh.vertices);
+    Free(mesh.indices);
+}
+
+void BufferManager::Update(const BufferRange& range, const void* data, UINT first, UINT count)
+{
+    if (range.usage != BufferUsage::Dynamic)
+        throw std::runtime_error("Only dynamic buffer ranges can be updated");
+    if (first + count > range.count)
+        throw std::runtime_error("Buffer update is outside the range");
+    Write(range, data, first, count);
+}
+
+void* BufferManager::Map(const BufferRange& range, D3D11_MAP mapType)
+{
+    if (range.usage != BufferUsage::Staging)
+        throw std::runtime_error("Only staging buffer ranges can be mapped");
+
+    // the whole block is mapped, so only one of its ranges can be open at a time
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    HRESULT hr = mContext->Map(range.buffer, 0, mapType, 0, &mapped);
+    if (FAILED(hr))
+        throw std::runtime_error("Failed to map staging buffer");
+    return static_cast<unsigned char*>(mapped.pData) + static_cast<size_t>(range.offset) * range.stride;
+}
+
+void BufferManager::Unmap(const BufferRange& range)
+{
+    mContext->Unmap(range.buffer, 0);
+}
+
+void BufferManager::Draw(const Mesh& mesh, UINT instanceCount)
+{
+    DrawRange(mesh, 0, mesh.indices.count, instanceCount);
+}
+
+void BufferManager::DrawRange(const Mesh& mesh, UINT firstIndex, UINT indexCount, UINT instanceCount)
+{
+    if (firstIndex + indexCount > mesh.indices.count)
+        throw std::runtime_error("Draw range is outside the mesh's indices");
+    if (mesh.vertices.buffer != mBoundVertexBuffer || mesh.vertices.stride != mBoundStride) {
+        UINT stride = mesh.vertices.stride;
+        UINT offset = 0;
+        mContext->IASetVertexBuffers(0, 1, &mesh.vertices.buffer, &stride, &offset);
+        mBoundVertexBuffer = mesh.vertices.buffer;
+        mBoundStride = stride;
+    }
+    if (mesh.indices.buffer != mBoundIndexBuffer) {
+        mContext->IASetIndexBuffer(mesh.indices.buffer, DXGI_FORMAT_R32_UINT, 0);
+        mBoundIndexBuffer = mesh.indices.buffer;
+    }
+
+    INT baseVertex = static_cast<INT>(mesh.vertices.offset);
+    UINT startIndex = mesh.indices.offset + firstIndex;
+    if (instanceCount == 1)
+        mContext->DrawIndexed(indexCount, startIndex, baseVertex);
+    else
+        mContext->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, 0);
+}
+
+void BufferManager::ResetBindings()
+{
+    mBoundVertexBuffer = nullptr;
+    mBoundStride = 0;
+    mBoundIndexBuffer = nullptr;
+}
+
+size_t BufferManager::GetBlockCount() const
+{
+    size_t count = 0;
+    for (const auto& pool : mPools)
+        count += pool->blocks.size();
+    return count;
+}
+
+size_t BufferManager::GetReservedBytes() const
+{
+    size_t bytes = 0;
+    for (const auto& pool : mPools) {
+        for (const auto& block : pool->blocks)
+            bytes += static_cast<size_t>(block->allocator.GetSize()) * pool->stride;
+    }
+    return bytes;
+}
+
+BufferManager::Pool& BufferManager::GetPool(BufferUsage usage, UINT bindFlags, UINT stride)
+{
+    for (auto& pool : mPools) {
+        if (pool->usage == usage && pool->bindFlags == bindFlags && pool->stride == stride)
+            return *pool;
+    }
+    std::unique_ptr<Pool> pool(new Pool());
+    pool->usage = usage;
+    pool->bindFlags = bindFlags;
+    pool->stride = stride;
+    mPools.push_back(std::move(pool));
+    return *mPools.back();
+}
+
+BufferManager::Block& BufferManager::AddBlock(Pool& pool, UINT minCount)
+{
+    UINT count = std::max(mBlockBytes / pool.stride, minCount);
+    if (static_cast<unsigned long long>(count) * pool.stride > 0xFFFFFFFFull)
+        throw std::runtime_error("Buffer range is too large");
+
+    D3D11_BUFFER_DESC desc = {};
+    desc.ByteWidth = count * pool.stride;
+    desc.BindFlags = pool.bindFlags;
+    desc.MiscFlags = 0;
+    switch (pool.usage) {
+    case BufferUsage::Dynamic:
+        desc.Usage = D3D11_USAGE_DYNAMIC;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        break;
+    case BufferUsage::Staging:
+        desc.Usage = D3D11_USAGE_STAGING;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ | D3D11_CPU_ACCESS_WRITE;
+        break;
+    default:
+        // D3D11_USAGE_IMMUTABLE buffers can only be filled at creation, which rules out
+        // sub-allocation. DEFAULT with no CPU access is the same to the GPU.
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.CPUAccessFlags = 0;
+        break;
+    }
+
+    ID3D11Buffer* buffer = nullptr;
+    HRESULT hr = mDevice->CreateBuffer(&desc, nullptr, &buffer);
+    if (FAILED(hr))
+        throw std::runtime_error("Failed to create pooled buffer");
+    pool.blocks.emplace_back(new Block(buffer, count));
+    return *pool.blocks.back();
+}
+
+void BufferManager::Write(const BufferRange& range, const void* data, UINT first, UINT count)
+{
+    UINT byteOffset = (range.offset + first) * range.stride;
+    UINT bytes = count * range.stride;
+    if (range.usage == BufferUsage::Immutable) {
+        D3D11_BOX box = { byteOffset, 0, 0, byteOffset + bytes, 1, 1 };
+        mContext->UpdateSubresource(range.buffer, 0, &box, data, 0, 0);
+        return;
+    }
+
+    // no-overwrite promises not to touch anything the GPU may be reading, so other ranges
+    // in the block keep drawing without a stall or a rename
+    D3D11_MAP mapType = range.usage == BufferUsage::Dynamic ? D3D11_MAP_WRITE_NO_OVERWRITE : D3D11_MAP_WRITE;
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    HRESULT hr = mContext->Map(range.buffer, 0, mapType, 0, &mapped);
+    if (FAILED(hr))
+        throw std::runtime_error("Failed to map pooled buffer");
+    std::memcpy(static_cast<unsigned char*>(mapped.pData) + byteOffset, data, bytes);
+    mContext->Unmap(range.buffer, 0);
+}
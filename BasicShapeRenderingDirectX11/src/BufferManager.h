@@ -0,0 +1,107 @@
+#pragma once
+#include <d3d11.h>
+#include <memory>
+#include <vector>
+#include "OffsetAllocator.h"
+
+enum class BufferUsage
+{
+	Immutable,	// written once when allocated, GPU-only after that
+	Dynamic,	// CPU-writable with Map(NO_OVERWRITE)
+	Staging		// CPU-readable copy target, not bindable
+};
+
+// Elements [offset, offset + count) of one of the manager's backing buffers. Offsets count
+// elements rather than bytes, so a vertex range's offset is its base vertex and an index
+// range's offset is its start index.
+struct BufferRange {
+	ID3D11Buffer* buffer = nullptr;
+	UINT offset = 0;
+	UINT count = 0;
+	UINT stride = 0;
+	BufferUsage usage = BufferUsage::Immutable;
+	UINT bindFlags = 0;
+	OffsetAllocator::Allocation allocation;
+};
+
+struct Mesh {
+	BufferRange vertices;
+	BufferRange indices;	// 32-bit
+};
+
+// Sub-allocates vertex, index and staging ranges from a few large buffers instead of one
+// ID3D11Buffer per mesh. Each usage, bind flag and stride combination is a pool of blocks
+// with a TLSF allocator each; a pool grows by a block when no block has room. Meshes that
+// share a pool share buffers, so drawing one after another only changes the draw offsets.
+// Use from the render thread.
+class BufferManager
+{
+public:
+	BufferManager(ID3D11Device* dev, ID3D11DeviceContext* devcon, UINT blockBytes = 4u << 20);
+	~BufferManager();
+
+	BufferManager(const BufferManager&) = delete;
+	BufferManager& operator=(const BufferManager&) = delete;
+
+	// data holds count * stride bytes and is copied straight to the GPU. It is required for
+	// Immutable ranges and optional for the others.
+	BufferRange Allocate(BufferUsage usage, UINT bindFlags, UINT stride, UINT count, const void* data = nullptr);
+	// The range may be handed out again right away. That is safe for Immutable and Staging
+	// ranges; a Dynamic range must be finished with by the GPU first, since it is written
+	// without synchronisation.
+	void Free(BufferRange& range);
+
+	Mesh CreateMesh(const void* vertices, UINT vertexCount, UINT stride, const unsigned int* indices, UINT indexCount, BufferUsage usage = BufferUsage::Immutable);
+	template <typename Vertex>
+	Mesh CreateMesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, BufferUsage usage = BufferUsage::Immutable)
+	{
+		return CreateMesh(vertices.data(), static_cast<UINT>(vertices.size()), sizeof(Vertex), indices.data(), static_cast<UINT>(indices.size()), usage);
+	}
+	void FreeMesh(Mesh& mesh);
+
+	// Writes elements [first, first + count) of a Dynamic range
+	void Update(const BufferRange& range, const void* data, UINT first, UINT count);
+	// Staging ranges only; the pointer is to the range's first element
+	void* Map(const BufferRange& range, D3D11_MAP mapType);
+	void Unmap(const BufferRange& range);
+
+	// Binds the mesh's buffers unless they are already the bound ones, then draws with the
+	// ranges' offsets as start index and base vertex
+	void Draw(const Mesh& mesh, UINT instanceCount = 1);
+	// Draws indices [firstIndex, firstIndex + indexCount) of the mesh's index range
+	void DrawRange(const Mesh& mesh, UINT firstIndex, UINT indexCount, UINT instanceCount = 1);
+	// Call after binding vertex or index buffers anywhere else
+	void ResetBindings();
+
+	size_t GetBlockCount() const;
+	size_t GetReservedBytes() const;
+
+private:
+	struct Block {
+		ID3D11Buffer* buffer;
+		OffsetAllocator allocator;
+
+		Block(ID3D11Buffer* buffer, UINT count) : buffer(buffer), allocator(count) {}
+	};
+
+	struct Pool {
+		BufferUsage usage;
+		UINT bindFlags;
+		UINT stride;
+		std::vector<std::unique_ptr<Block>> blocks;
+	};
+
+	Pool& GetPool(BufferUsage usage, UINT bindFlags, UINT stride);
+	Block& AddBlock(Pool& pool, UINT minCount);
+	void Write(const BufferRange& range, const void* data, UINT first, UINT count);
+
+private:
+	ID3D11Device* mDevice;
+	ID3D11DeviceContext* mContext;
+	UINT mBlockBytes;
+	std::vector<std::unique_ptr<Pool>> mPools;
+
+	ID3D11Buffer* mBoundVertexBuffer = nullptr;
+	UINT mBoundStride = 0;
+	ID3D11Buffer* mBoundIndexBuffer = nullptr;
+};
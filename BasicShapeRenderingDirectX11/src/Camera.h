@@ -13,6 +13,7 @@ public:
 	void processInput(GLFWwindow* window, float deltaTime);
 	glm::mat4 GetCameraView() const { return mView; }
 	glm::mat4 GetCameraProjection() const { return mProjection; }
+	glm::vec3 GetCameraPosition() const { return mCameraPos; }
 
 	void RecalculateViewMatrix();
 
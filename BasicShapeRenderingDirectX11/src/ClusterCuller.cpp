@@ -0,0 +1,80 @@
+#include "ClusterCuller.h"
+
+#include <cmath>
+
+ClusterCuller::View::View(const glm::mat4& viewProjection, const glm::vec3& cameraPosition)
+    : position(cameraPosition)
+{
+    // Gribb and Hartmann: each clip plane is the last row of the matrix plus or minus another.
+    // The near plane uses glm's -w..w depth; with a 0..w projection it is merely conservative.
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; ++i)
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    planes[0] = rows[3] + rows[0];
+    planes[1] = rows[3] - rows[0];
+    planes[2] = rows[3] + rows[1];
+    planes[3] = rows[3] - rows[1];
+    planes[4] = rows[3] + rows[2];
+    planes[5] = rows[3] - rows[2];
+    for (glm::vec4& plane : planes) {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f)
+            plane /= length;
+    }
+}
+
+bool ClusterCuller::IsVisible(const Meshlet& meshlet, const View& view, Stats* stats)
+{
+    glm::vec3 center(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+    for (const glm::vec4& plane : view.planes) {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -meshlet.radius) {
+            if (stats)
+                ++stats->frustumCulled;
+            return false;
+        }
+    }
+
+    if (meshlet.coneCutoff <= 1.0f) {
+        glm::vec3 apex(meshlet.coneApex[0], meshlet.coneApex[1], meshlet.coneApex[2]);
+        glm::vec3 axis(meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2]);
+        glm::vec3 direction = apex - view.position;
+        float distance = glm::length(direction);
+        if (distance > 0.0f && glm::dot(direction, axis) >= meshlet.coneCutoff * distance) {
+            if (stats)
+                ++stats->backfaceCulled;
+            return false;
+        }
+    }
+
+    if (stats)
+        ++stats->visible;
+    return true;
+}
+
+ClusterCuller::Stats ClusterCuller::Cull(const MeshletMesh& mesh, const View& view, std::vector<unsigned int>& indices)
+{
+    Stats stats;
+    indices.clear();
+    for (const Meshlet& meshlet : mesh.meshlets) {
+        if (IsVisible(meshlet, view, &stats))
+            MeshletBuilder::AppendIndices(mesh, meshlet, indices);
+    }
+    return stats;
+}
+
+ClusterCuller::Stats ClusterCuller::CullRanges(const MeshletMesh& mesh, const View& view, std::vector<Range>& ranges)
+{
+    Stats stats;
+    ranges.clear();
+    for (const Meshlet& meshlet : mesh.meshlets) {
+        if (!IsVisible(meshlet, view, &stats))
+            continue;
+        unsigned int first = meshlet.triangleOffset * 3;
+        unsigned int count = meshlet.triangleCount * 3;
+        if (!ranges.empty() && ranges.back().firstIndex + ranges.back().indexCount == first)
+            ranges.back().indexCount += count;
+        else
+            ranges.push_back({ first, count });
+    }
+    return stats;
+}
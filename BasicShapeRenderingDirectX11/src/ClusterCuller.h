@@ -0,0 +1,41 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include "MeshletBuilder.h"
+
+// Per-meshlet visibility on the CPU: a meshlet survives when its bounding sphere touches
+// the view frustum and its normal cone has at least one triangle facing the camera. The
+// survivors' triangles are written out as a plain index list, or as ranges of the meshlet
+// ordered index buffer, so the vertex shader only runs for vertices of visible clusters.
+class ClusterCuller
+{
+public:
+	// The camera in the mesh's own space: pass projection * view * model and the camera
+	// position taken through the inverse model matrix
+	struct View {
+		glm::vec4 planes[6];	// inside when dot(plane.xyz, p) + plane.w >= 0, xyz normalized
+		glm::vec3 position;
+
+		View(const glm::mat4& viewProjection, const glm::vec3& cameraPosition);
+	};
+
+	// Indices [firstIndex, firstIndex + indexCount) of MeshletBuilder::FlattenIndices
+	struct Range {
+		unsigned int firstIndex;
+		unsigned int indexCount;
+	};
+
+	struct Stats {
+		size_t visible = 0;
+		size_t frustumCulled = 0;
+		size_t backfaceCulled = 0;
+	};
+
+	static bool IsVisible(const Meshlet& meshlet, const View& view, Stats* stats = nullptr);
+
+	// Replaces indices with the triangles of every visible meshlet
+	static Stats Cull(const MeshletMesh& mesh, const View& view, std::vector<unsigned int>& indices);
+	// Replaces ranges with one per run of visible meshlets, for drawing straight from a static
+	// index buffer without uploading anything
+	static Stats CullRanges(const MeshletMesh& mesh, const View& view, std::vector<Range>& ranges);
+};
@@ -0,0 +1,222 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+void SplitPath(const std::string& path, std::string& directory, std::string& name)
+{
+    size_t slash = path.find_last_of("/\\");
+    if (slash == std::string::npos) {
+        directory = ".";
+        name = path;
+        return;
+    }
+    directory = slash == 0 ? path.substr(0, 1) : path.substr(0, slash);
+    name = path.substr(slash + 1);
+}
+
+// Windows file names compare without case
+std::string NormalizeName(std::string name)
+{
+#if defined(_WIN32)
+    for (char& c : name)
+        c = (char)std::tolower((unsigned char)c);
+#endif
+    return name;
+}
+
+} // namespace
+
+struct FileWatcher::Directory {
+    std::string path;
+    // name as the OS reports it -> path the caller passed to Watch()
+    std::unordered_map<std::string, std::string> files;
+#if defined(_WIN32)
+    OVERLAPPED overlapped;
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    DWORD buffer[16 * 1024];
+
+    bool IssueRead()
+    {
+        ZeroMemory(&overlapped, sizeof(overlapped));
+        return ReadDirectoryChangesW(handle, buffer, sizeof(buffer), FALSE,
+            FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE,
+            nullptr, &overlapped, nullptr) != FALSE;
+    }
+#elif defined(__linux__)
+    int watch = -1;
+#endif
+};
+
+FileWatcher::FileWatcher()
+{
+#if defined(_WIN32)
+    mHandle = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+    if (!mHandle)
+        throw std::runtime_error("Failed to create file watcher");
+#elif defined(__linux__)
+    mDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (mDescriptor < 0)
+        throw std::runtime_error("Failed to create file watcher");
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#if defined(_WIN32)
+    // the pending read writes into the Directory, so wait for the cancel to land first
+    for (auto& entry : mDirectories) {
+        Directory& directory = *entry.second;
+        DWORD bytes;
+        if (CancelIoEx(directory.handle, &directory.overlapped) || GetLastError() != ERROR_NOT_FOUND)
+            GetOverlappedResult(directory.handle, &directory.overlapped, &bytes, TRUE);
+        CloseHandle(directory.handle);
+    }
+    CloseHandle(mHandle);
+#elif defined(__linux__)
+    close(mDescriptor);
+#endif
+}
+
+void FileWatcher::Watch(const std::string& path)
+{
+    std::string directoryPath, name;
+    SplitPath(path, directoryPath, name);
+    std::string key = NormalizeName(directoryPath);
+
+    auto found = mDirectories.find(key);
+    if (found == mDirectories.end()) {
+        std::unique_ptr<Directory> directory(new Directory);
+        directory->path = directoryPath;
+#if defined(_WIN32)
+        directory->handle = CreateFileA(directoryPath.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        if (directory->handle == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Failed to watch " + directoryPath);
+        if (!CreateIoCompletionPort(directory->handle, mHandle, reinterpret_cast<ULONG_PTR>(directory.get()), 0)
+            || !directory->IssueRead()) {
+            CloseHandle(directory->handle);
+            throw std::runtime_error("Failed to watch " + directoryPath);
+        }
+#elif defined(__linux__)
+        // saves either write in place or rename a finished temporary over the file
+        directory->watch = inotify_add_watch(mDescriptor, directoryPath.c_str(), IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_MOVED_TO);
+        if (directory->watch < 0)
+            throw std::runtime_error("Failed to watch " + directoryPath);
+#else
+        throw std::runtime_error("File watching is not supported on this platform");
+#endif
+        found = mDirectories.emplace(key, std::move(directory)).first;
+    }
+    found->second->files[NormalizeName(name)] = path;
+}
+
+std::vector<std::string> FileWatcher::PollChanges()
+{
+    DrainEvents();
+
+    std::vector<std::string> settled;
+    Clock::time_point now = Clock::now();
+    for (auto it = mChanged.begin(); it != mChanged.end();) {
+        if (now - it->second < mSettleTime) {
+            ++it;
+            continue;
+        }
+        settled.push_back(it->first);
+        it = mChanged.erase(it);
+    }
+    return settled;
+}
+
+void FileWatcher::MarkChanged(Directory& directory, const std::string& name)
+{
+    auto file = directory.files.find(NormalizeName(name));
+    if (file != directory.files.end())
+        mChanged[file->second] = Clock::now();
+}
+
+#if defined(_WIN32)
+
+void FileWatcher::DrainEvents()
+{
+    for (;;) {
+        DWORD bytes = 0;
+        ULONG_PTR key = 0;
+        OVERLAPPED* overlapped = nullptr;
+        BOOL ok = GetQueuedCompletionStatus(mHandle, &bytes, &key, &overlapped, 0);
+        if (!overlapped)
+            return;
+
+        Directory& directory = *reinterpret_cast<Directory*>(key);
+        if (ok && bytes == 0) {
+            // the buffer overflowed and the details are lost, so assume everything changed
+            for (auto& file : directory.files)
+                mChanged[file.second] = Clock::now();
+        } else if (ok) {
+            const unsigned char* cursor = reinterpret_cast<const unsigned char*>(directory.buffer);
+            for (;;) {
+                const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(cursor);
+                int wideLength = static_cast<int>(info->FileNameLength / sizeof(WCHAR));
+                char name[MAX_PATH * 2];
+                int length = WideCharToMultiByte(CP_ACP, 0, info->FileName, wideLength, name, sizeof(name), nullptr, nullptr);
+                if (length > 0)
+                    MarkChanged(directory, std::string(name, length));
+                if (info->NextEntryOffset == 0)
+                    break;
+                cursor += info->NextEntryOffset;
+            }
+        }
+        // a failed completion means the directory went away, stop watching it
+        if (ok)
+            directory.IssueRead();
+    }
+}
+
+#elif defined(__linux__)
+
+void FileWatcher::DrainEvents()
+{
+    alignas(inotify_event) char buffer[16 * 1024];
+    for (;;) {
+        ssize_t length = read(mDescriptor, buffer, sizeof(buffer));
+        if (length < 0 && errno == EINTR)
+            continue;
+        if (length <= 0)
+            return;
+
+        for (char* cursor = buffer; cursor < buffer + length;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(cursor);
+            cursor += sizeof(inotify_event) + event->len;
+            for (auto& entry : mDirectories) {
+                Directory& directory = *entry.second;
+                if (event->mask & IN_Q_OVERFLOW) {
+                    for (auto& file : directory.files)
+                        mChanged[file.second] = Clock::now();
+                } else if (directory.watch == event->wd && event->len > 0) {
+                    MarkChanged(directory, event->name);
+                }
+            }
+        }
+    }
+}
+
+#else
+
+void FileWatcher::DrainEvents()
+{
+}
+
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Reports when watched files are written. Watching a file watches its directory
+// (ReadDirectoryChangesW on Windows, inotify on Linux), so editors that save through a
+// temporary file and a rename are caught too. Nothing runs in the background: events
+// queue up in the OS and PollChanges() drains them, from one thread only.
+class FileWatcher
+{
+public:
+	FileWatcher();
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	// Throws std::runtime_error if the directory cannot be watched
+	void Watch(const std::string& path);
+
+	// Watched paths, exactly as passed to Watch(), that changed and have then been left
+	// alone for the settle time, so a file is not picked up halfway through being saved
+	std::vector<std::string> PollChanges();
+
+	void SetSettleTime(std::chrono::milliseconds settleTime) { mSettleTime = settleTime; }
+
+private:
+	using Clock = std::chrono::steady_clock;
+	struct Directory;
+
+	void DrainEvents();
+	void MarkChanged(Directory& directory, const std::string& name);
+
+private:
+	void* mHandle = nullptr;
+	int mDescriptor = -1;
+	std::unordered_map<std::string, std::unique_ptr<Directory>> mDirectories;
+	std::unordered_map<std::string, Clock::time_point> mChanged;
+	std::chrono::milliseconds mSettleTime{ 200 };
+};
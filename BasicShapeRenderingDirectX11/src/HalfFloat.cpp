@@ -0,0 +1,240 @@
+#include "HalfFloat.h"
+#include "Simd.h"
+
+#include <cstring>
+#include <emmintrin.h>
+#include <immintrin.h>
+
+namespace {
+
+// Unsigned float with 5 exponent bits (bias 15) and mantissaBits of mantissa, in the low
+// bits of each lane. Half floats are the 10-bit case plus a sign; R11G11B10 uses 6 and 5.
+// Rounds to nearest even: denormals through a float add, normals with an integer bias.
+inline __m128i FloatToSmallFloat(__m128 f, int mantissaBits)
+{
+    int shift = 23 - mantissaBits;
+    __m128i bits = _mm_castps_si128(f);
+
+    const __m128 denormMagic = _mm_castsi128_ps(_mm_set1_epi32(((127 - 15) + shift + 1) << 23));
+    __m128i denorm = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(f, denormMagic)), _mm_castps_si128(denormMagic));
+
+    __m128i odd = _mm_and_si128(_mm_srl_epi32(bits, _mm_cvtsi32_si128(shift)), _mm_set1_epi32(1));
+    __m128i rebiased = _mm_add_epi32(bits, _mm_set1_epi32((1 << (shift - 1)) - 1 - (112 << 23)));
+    __m128i normal = _mm_srl_epi32(_mm_add_epi32(rebiased, odd), _mm_cvtsi32_si128(shift));
+
+    __m128i isDenorm = _mm_cmplt_epi32(bits, _mm_set1_epi32(113 << 23));
+    return _mm_or_si128(_mm_and_si128(isDenorm, denorm), _mm_andnot_si128(isDenorm, normal));
+}
+
+inline __m128 SmallFloatToFloat(__m128i value, int mantissaBits)
+{
+    const __m128i shiftedExp = _mm_set1_epi32(31 << 23);
+    __m128i o = _mm_sll_epi32(value, _mm_cvtsi32_si128(23 - mantissaBits));
+    __m128i exp = _mm_and_si128(o, shiftedExp);
+    o = _mm_add_epi32(o, _mm_set1_epi32((127 - 15) << 23));
+
+    // infinity and NaN keep an all-ones exponent
+    __m128i isInfNan = _mm_cmpeq_epi32(exp, shiftedExp);
+    o = _mm_add_epi32(o, _mm_and_si128(isInfNan, _mm_set1_epi32((128 - 16) << 23)));
+
+    // denormals are renormalised by a float subtract
+    __m128i isDenorm = _mm_cmpeq_epi32(exp, _mm_setzero_si128());
+    __m128 denorm = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(o, _mm_set1_epi32(1 << 23))), _mm_castsi128_ps(_mm_set1_epi32(113 << 23)));
+    return _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(isDenorm, _mm_castps_si128(denorm)), _mm_andnot_si128(isDenorm, o)));
+}
+
+inline __m128i FloatToHalf4(__m128 f)
+{
+    __m128i bits = _mm_castps_si128(f);
+    __m128i sign = _mm_and_si128(bits, _mm_set1_epi32((int)0x80000000));
+    __m128i abs = _mm_xor_si128(bits, sign);
+
+    __m128i half = FloatToSmallFloat(_mm_castsi128_ps(abs), 10);
+
+    // anything from 2^16 up is infinity, NaN stays a quiet NaN
+    __m128i overflow = _mm_cmpgt_epi32(abs, _mm_set1_epi32(((127 + 16) << 23) - 1));
+    __m128i isNan = _mm_cmpgt_epi32(abs, _mm_set1_epi32(255 << 23));
+    __m128i special = _mm_or_si128(_mm_set1_epi32(0x7C00), _mm_and_si128(isNan, _mm_set1_epi32(0x200)));
+    half = _mm_or_si128(_mm_and_si128(overflow, special), _mm_andnot_si128(overflow, half));
+    return _mm_or_si128(half, _mm_srli_epi32(sign, 16));
+}
+
+inline __m128 HalfToFloat4(__m128i half)
+{
+    __m128 abs = SmallFloatToFloat(_mm_and_si128(half, _mm_set1_epi32(0x7FFF)), 10);
+    __m128i sign = _mm_slli_epi32(_mm_and_si128(half, _mm_set1_epi32(0x8000)), 16);
+    return _mm_or_ps(abs, _mm_castsi128_ps(sign));
+}
+
+// Two vectors of 32-bit lanes holding 16-bit values into one vector of eight. The
+// sign-extension keeps the signed saturating pack from touching values above 0x7FFF.
+inline __m128i PackLow16(__m128i lo, __m128i hi)
+{
+    lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+    hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+    return _mm_packs_epi32(lo, hi);
+}
+
+inline __m128i PackR11G11B10_4(__m128 p0, __m128 p1, __m128 p2, __m128 p3)
+{
+    _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+    const __m128 zero = _mm_setzero_ps();
+    // max with zero first: MAXPS returns the second operand for NaN
+    __m128 r = _mm_min_ps(_mm_max_ps(p0, zero), _mm_set1_ps(65024.0f));
+    __m128 g = _mm_min_ps(_mm_max_ps(p1, zero), _mm_set1_ps(65024.0f));
+    __m128 b = _mm_min_ps(_mm_max_ps(p2, zero), _mm_set1_ps(64512.0f));
+    __m128i packed = FloatToSmallFloat(r, 6);
+    packed = _mm_or_si128(packed, _mm_slli_epi32(FloatToSmallFloat(g, 6), 11));
+    return _mm_or_si128(packed, _mm_slli_epi32(FloatToSmallFloat(b, 5), 22));
+}
+
+SIMD_TARGET_F16C size_t FromUnorm16_F16C(const uint16_t* src, uint16_t* dst, size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(1.0f / 65535.0f);
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m256i wide = _mm256_setr_m128i(_mm_unpacklo_epi16(v, zero), _mm_unpackhi_epi16(v, zero));
+        __m256 f = _mm256_mul_ps(_mm256_cvtepi32_ps(wide), scale);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+    }
+    return i;
+}
+
+} // namespace
+
+void HalfFloat::FromFloat(const float* src, uint16_t* dst, size_t count)
+{
+    if (CpuFeatures::Get().HasF16C())
+        FromFloatF16C(src, dst, count);
+    else
+        FromFloatSSE2(src, dst, count);
+}
+
+void HalfFloat::ToFloat(const uint16_t* src, float* dst, size_t count)
+{
+    if (CpuFeatures::Get().HasF16C())
+        ToFloatF16C(src, dst, count);
+    else
+        ToFloatSSE2(src, dst, count);
+}
+
+void HalfFloat::FromFloatSSE2(const float* src, uint16_t* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = FloatToHalf4(_mm_loadu_ps(src + i));
+        __m128i hi = FloatToHalf4(_mm_loadu_ps(src + i + 4));
+        _mm_storeu_si128((__m128i*)(dst + i), PackLow16(lo, hi));
+    }
+    // the tail goes through the same kernel on a padded copy
+    if (i < count) {
+        alignas(16) float in[8] = {};
+        alignas(16) uint16_t out[8];
+        std::memcpy(in, src + i, (count - i) * sizeof(float));
+        _mm_store_si128((__m128i*)out, PackLow16(FloatToHalf4(_mm_load_ps(in)), FloatToHalf4(_mm_load_ps(in + 4))));
+        std::memcpy(dst + i, out, (count - i) * sizeof(uint16_t));
+    }
+}
+
+SIMD_TARGET_F16C void HalfFloat::FromFloatF16C(const float* src, uint16_t* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm_storeu_si128((__m128i*)(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+    if (i < count)
+        FromFloatSSE2(src + i, dst + i, count - i);
+}
+
+void HalfFloat::ToFloatSSE2(const uint16_t* src, float* dst, size_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_ps(dst + i, HalfToFloat4(_mm_unpacklo_epi16(v, zero)));
+        _mm_storeu_ps(dst + i + 4, HalfToFloat4(_mm_unpackhi_epi16(v, zero)));
+    }
+    if (i < count) {
+        alignas(16) uint16_t in[8] = {};
+        alignas(16) float out[8];
+        std::memcpy(in, src + i, (count - i) * sizeof(uint16_t));
+        __m128i v = _mm_load_si128((const __m128i*)in);
+        _mm_store_ps(out, HalfToFloat4(_mm_unpacklo_epi16(v, zero)));
+        _mm_store_ps(out + 4, HalfToFloat4(_mm_unpackhi_epi16(v, zero)));
+        std::memcpy(dst + i, out, (count - i) * sizeof(float));
+    }
+}
+
+SIMD_TARGET_F16C void HalfFloat::ToFloatF16C(const uint16_t* src, float* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + i))));
+    if (i < count)
+        ToFloatSSE2(src + i, dst + i, count - i);
+}
+
+void HalfFloat::FromUnorm16(const uint16_t* src, uint16_t* dst, size_t count)
+{
+    size_t i = CpuFeatures::Get().HasF16C() ? FromUnorm16_F16C(src, dst, count) : 0;
+
+    const __m128 scale = _mm_set1_ps(1.0f / 65535.0f);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i lo = FloatToHalf4(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)), scale));
+        __m128i hi = FloatToHalf4(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)), scale));
+        _mm_storeu_si128((__m128i*)(dst + i), PackLow16(lo, hi));
+    }
+    for (; i < count; ++i) {
+        float f = src[i] / 65535.0f;
+        FromFloatSSE2(&f, dst + i, 1);
+    }
+}
+
+void HalfFloat::PackR11G11B10(const float* rgba, uint32_t* dst, size_t pixels)
+{
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        const float* p = rgba + i * 4;
+        __m128i packed = PackR11G11B10_4(_mm_loadu_ps(p), _mm_loadu_ps(p + 4), _mm_loadu_ps(p + 8), _mm_loadu_ps(p + 12));
+        _mm_storeu_si128((__m128i*)(dst + i), packed);
+    }
+    if (i < pixels) {
+        alignas(16) float in[16] = {};
+        alignas(16) uint32_t out[4];
+        std::memcpy(in, rgba + i * 4, (pixels - i) * 4 * sizeof(float));
+        _mm_store_si128((__m128i*)out, PackR11G11B10_4(_mm_load_ps(in), _mm_load_ps(in + 4), _mm_load_ps(in + 8), _mm_load_ps(in + 12)));
+        std::memcpy(dst + i, out, (pixels - i) * sizeof(uint32_t));
+    }
+}
+
+void HalfFloat::UnpackR11G11B10(const uint32_t* src, float* rgba, size_t pixels)
+{
+    const __m128i mask11 = _mm_set1_epi32(0x7FF);
+    const __m128i mask10 = _mm_set1_epi32(0x3FF);
+    alignas(16) uint32_t in[4] = {};
+    alignas(16) float out[16];
+    for (size_t i = 0; i < pixels; i += 4) {
+        bool tail = i + 4 > pixels;
+        if (tail)
+            std::memcpy(in, src + i, (pixels - i) * sizeof(uint32_t));
+        __m128i v = _mm_loadu_si128((const __m128i*)(tail ? in : src + i));
+
+        __m128 r = SmallFloatToFloat(_mm_and_si128(v, mask11), 6);
+        __m128 g = SmallFloatToFloat(_mm_and_si128(_mm_srli_epi32(v, 11), mask11), 6);
+        __m128 b = SmallFloatToFloat(_mm_and_si128(_mm_srli_epi32(v, 22), mask10), 5);
+        __m128 a = _mm_set1_ps(1.0f);
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+
+        float* dst = tail ? out : rgba + i * 4;
+        _mm_storeu_ps(dst, r);
+        _mm_storeu_ps(dst + 4, g);
+        _mm_storeu_ps(dst + 8, b);
+        _mm_storeu_ps(dst + 12, a);
+        if (tail)
+            std::memcpy(rgba + i * 4, out, (pixels - i) * 4 * sizeof(float));
+    }
+}
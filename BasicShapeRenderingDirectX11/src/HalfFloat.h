@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Conversions for the HDR texture formats: 32-bit float to and from half floats, and the
+// packed unsigned R11G11B10 format. Half conversion uses F16C when the CPU has it; the
+// SSE2 fallback also rounds to nearest even, so both paths produce the same bits.
+class HalfFloat
+{
+public:
+	static void FromFloat(const float* src, uint16_t* dst, size_t count);
+	static void ToFloat(const uint16_t* src, float* dst, size_t count);
+	// 16-bit UNORM (as stb_image returns 16-bit PNGs) to half, mapping 65535 to 1.0
+	static void FromUnorm16(const uint16_t* src, uint16_t* dst, size_t count);
+
+	// RGBA float pixels in, alpha is dropped. Negative and NaN channels become 0, values
+	// past the format's range clamp to its largest finite value.
+	static void PackR11G11B10(const float* rgba, uint32_t* dst, size_t pixels);
+	// Alpha comes back as 1
+	static void UnpackR11G11B10(const uint32_t* src, float* rgba, size_t pixels);
+
+	// Single-path versions, so the benchmark can compare them
+	static void FromFloatSSE2(const float* src, uint16_t* dst, size_t count);
+	static void FromFloatF16C(const float* src, uint16_t* dst, size_t count);
+	static void ToFloatSSE2(const uint16_t* src, float* dst, size_t count);
+	static void ToFloatF16C(const uint16_t* src, float* dst, size_t count);
+};
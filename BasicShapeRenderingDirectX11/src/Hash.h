@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit XXH64 of a byte range, used to key cached and deduplicated content
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+// 64-bit FNV-1a of a file path with backslashes folded to '/' and ASCII letters to lower
+// case, so spellings of the same Windows path agree. constexpr, so literal paths hash at
+// compile time.
+constexpr uint64_t HashPath(const char* path)
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (; *path; ++path) {
+		char c = *path == '\\' ? '/' : *path;
+		if (c >= 'A' && c <= 'Z')
+			c = static_cast<char>(c - 'A' + 'a');
+		hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001B3ull;
+	}
+	return hash;
+}
+
+inline uint64_t HashCombine(uint64_t seed, uint64_t value)
+{
+	return seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2));
+}
@@ -0,0 +1,127 @@
+#include "Image.h"
+
+#include <algorithm>
+#include <cstring>
+
+PixelBuffer::PixelBuffer(size_t size)
+    : mData(size ? new unsigned char[size] : nullptr), mSize(size), mDeleter([](unsigned char* p) { delete[] p; })
+{
+}
+
+PixelBuffer::PixelBuffer(std::vector<unsigned char>&& bytes)
+{
+    // keep the vector alive instead of copying out of it
+    auto* owner = new std::vector<unsigned char>(std::move(bytes));
+    mData = owner->data();
+    mSize = owner->size();
+    mDeleter = [owner](unsigned char*) { delete owner; };
+}
+
+PixelBuffer::PixelBuffer(unsigned char* data, size_t size, Deleter deleter)
+    : mData(data), mSize(size), mDeleter(std::move(deleter))
+{
+}
+
+PixelBuffer::~PixelBuffer()
+{
+    Release();
+}
+
+PixelBuffer::PixelBuffer(const PixelBuffer& other)
+    : PixelBuffer(other.mSize)
+{
+    if (mSize)
+        std::memcpy(mData, other.mData, mSize);
+}
+
+PixelBuffer::PixelBuffer(PixelBuffer&& other) noexcept
+    : mData(other.mData), mSize(other.mSize), mDeleter(std::move(other.mDeleter))
+{
+    other.mData = nullptr;
+    other.mSize = 0;
+    other.mDeleter = nullptr;
+}
+
+PixelBuffer& PixelBuffer::operator=(const PixelBuffer& other)
+{
+    if (this != &other)
+        *this = PixelBuffer(other);
+    return *this;
+}
+
+PixelBuffer& PixelBuffer::operator=(PixelBuffer&& other) noexcept
+{
+    if (this != &other) {
+        Release();
+        mData = other.mData;
+        mSize = other.mSize;
+        mDeleter = std::move(other.mDeleter);
+        other.mData = nullptr;
+        other.mSize = 0;
+        other.mDeleter = nullptr;
+    }
+    return *this;
+}
+
+void PixelBuffer::resize(size_t size)
+{
+    if (size == mSize)
+        return;
+    PixelBuffer resized(size);
+    if (mSize && size)
+        std::memcpy(resized.mData, mData, std::min(size, mSize));
+    *this = std::move(resized);
+}
+
+void PixelBuffer::Release()
+{
+    if (mDeleter)
+        mDeleter(mData);
+    mData = nullptr;
+    mSize = 0;
+    mDeleter = nullptr;
+}
+
+bool IsBlockCompressed(PixelFormat format)
+{
+    return format == PixelFormat::BC1 || format == PixelFormat::BC3 || format == PixelFormat::BC7;
+}
+
+bool IsFloatFormat(PixelFormat format)
+{
+    return format == PixelFormat::RGBA16F || format == PixelFormat::R11G11B10F;
+}
+
+int GetBytesPerPixel(PixelFormat format)
+{
+    switch (format) {
+    case PixelFormat::R8:
+        return 1;
+    case PixelFormat::RG8:
+        return 2;
+    case PixelFormat::RGBA16F:
+        return 8;
+    default:
+        return 4;
+    }
+}
+
+size_t GetRowPitch(PixelFormat format, int width)
+{
+    size_t blocksWide = (static_cast<size_t>(width) + 3) / 4;
+    switch (format) {
+    case PixelFormat::BC1:
+        return blocksWide * 8;
+    case PixelFormat::BC3:
+    case PixelFormat::BC7:
+        return blocksWide * 16;
+    default:
+        return static_cast<size_t>(width) * GetBytesPerPixel(format);
+    }
+}
+
+size_t GetImageSize(PixelFormat format, int width, int height)
+{
+    size_t rows = IsBlockCompressed(format) ? (static_cast<size_t>(height) + 3) / 4 : static_cast<size_t>(height);
+    return GetRowPitch(format, width) * rows;
+}
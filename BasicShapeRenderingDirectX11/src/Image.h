@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// CPU-side image types shared by the texture pipeline. Kept free of any D3D
+// headers so the image processing code can also be built for tools and benchmarks.
+
+enum class MipFilter
+{
+	None,
+	Box,
+	Kaiser
+};
+
+// Filters for resampling to an arbitrary size
+enum class ResizeFilter
+{
+	Mitchell,	// B = C = 1/3: soft, barely rings
+	Lanczos3	// sharper, can ring slightly around hard edges
+};
+
+// Layout of ImageData::data. Block-compressed formats store 4x4 blocks in row-major order.
+enum class PixelFormat
+{
+	RGBA8,
+	BC1,
+	BC3,
+	BC7,
+	R8,
+	RG8,
+	RGBA16F,
+	R11G11B10F
+};
+
+// Order of the texels in ImageData::data for uncompressed formats. Everything except
+// TexelTiling and its sampler expects Linear, including the D3D upload.
+enum class TexelLayout
+{
+	Linear,	// row-major
+	Tiled	// 8x8 tiles in row-major order, Z (Morton) order inside each tile, edge tiles padded
+};
+
+// Byte buffer that can adopt memory allocated elsewhere (stb_image, a mapped file, ...)
+// and release it through a custom deleter, so decoded pixels never need an extra copy.
+class PixelBuffer
+{
+public:
+	using Deleter = std::function<void(unsigned char*)>;
+
+	PixelBuffer() = default;
+	explicit PixelBuffer(size_t size);
+	PixelBuffer(std::vector<unsigned char>&& bytes);
+	PixelBuffer(unsigned char* data, size_t size, Deleter deleter);
+	~PixelBuffer();
+
+	PixelBuffer(const PixelBuffer& other);
+	PixelBuffer(PixelBuffer&& other) noexcept;
+	PixelBuffer& operator=(const PixelBuffer& other);
+	PixelBuffer& operator=(PixelBuffer&& other) noexcept;
+
+	unsigned char* data() { return mData; }
+	const unsigned char* data() const { return mData; }
+	size_t size() const { return mSize; }
+	bool empty() const { return mSize == 0; }
+
+	unsigned char* begin() { return mData; }
+	unsigned char* end() { return mData + mSize; }
+	const unsigned char* begin() const { return mData; }
+	const unsigned char* end() const { return mData + mSize; }
+
+	unsigned char& operator[](size_t i) { return mData[i]; }
+	const unsigned char& operator[](size_t i) const { return mData[i]; }
+
+	// Reallocates into owned storage, keeping the leading bytes
+	void resize(size_t size);
+
+private:
+	void Release();
+
+private:
+	unsigned char* mData = nullptr;
+	size_t mSize = 0;
+	Deleter mDeleter;
+};
+
+struct ImageData {
+	int width;
+	int height;
+	int channels;
+	PixelBuffer data;
+	PixelFormat format = PixelFormat::RGBA8;
+	TexelLayout layout = TexelLayout::Linear;
+};
+
+bool IsBlockCompressed(PixelFormat format);
+// Half-float and packed float HDR formats
+bool IsFloatFormat(PixelFormat format);
+// Bytes per texel of an uncompressed format
+int GetBytesPerPixel(PixelFormat format);
+// Bytes per row, or per row of 4x4 blocks for block-compressed formats
+size_t GetRowPitch(PixelFormat format, int width);
+size_t GetImageSize(PixelFormat format, int width, int height);
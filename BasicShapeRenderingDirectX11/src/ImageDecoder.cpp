@@ -0,0 +1,126 @@
+#include "ImageDecoder.h"
+#include "HalfFloat.h"
+#include "MappedFile.h"
+#include "PixelConverter.h"
+// stb_image uses pow and ldexp without including math.h itself
+#include <cmath>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image/stb_image.h>
+
+#include <climits>
+#include <stdexcept>
+
+ImageData ImageDecoder::LoadFile(const std::string& filename, int scaleDenom)
+{
+    // decode straight out of the page cache
+    MappedFile file(filename);
+    return Decode(file.GetData(), file.GetSize(), scaleDenom);
+}
+
+ImageData ImageDecoder::Decode(const unsigned char* bytes, size_t size, int scaleDenom)
+{
+    if (size > static_cast<size_t>(INT_MAX)) {
+        throw std::runtime_error("Image file too large");
+    }
+
+    int length = static_cast<int>(size);
+    if (stbi_is_hdr_from_memory(bytes, length))
+        return DecodeHdr(bytes, size);
+    if (stbi_is_16_bit_from_memory(bytes, length))
+        return Decode16Bit(bytes, size);
+
+    // keep the channel count the file was stored with, grey images stay one byte per texel.
+    // RGB has no GPU format, so stb writes those (every JPEG) as RGBA straight into the
+    // buffer we keep. The JPEG scale is thread-local in stb, so concurrent decodes can each
+    // use their own
+    int width, height, channels;
+    int desired = STBI_default;
+    if (stbi_info_from_memory(bytes, length, &width, &height, &channels) && channels == 3)
+        desired = STBI_rgb_alpha;
+    stbi_set_jpeg_scale_denom_thread(scaleDenom);
+    unsigned char* data = stbi_load_from_memory(bytes, length, &width, &height, &channels, desired);
+    stbi_set_jpeg_scale_denom_thread(1);
+    if (!data) {
+        throw std::runtime_error("Failed to load image");
+    }
+
+    // stb reports the file's channel count, not the one it wrote
+    PixelFormat format = PixelConverter::ChooseFormat(channels);
+    if (desired != STBI_default)
+        channels = desired;
+
+    // hand stb's buffer to ImageData so the pixels are allocated exactly once
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    PixelBuffer pixels(data, pixelCount * channels, [](unsigned char* p) { stbi_image_free(p); });
+    return { width, height, channels, std::move(pixels), format };
+}
+
+bool ImageDecoder::ReadSize(const unsigned char* bytes, size_t size, int& width, int& height)
+{
+    int channels;
+    return size <= static_cast<size_t>(INT_MAX) && stbi_info_from_memory(bytes, static_cast<int>(size), &width, &height, &channels) != 0;
+}
+
+ImageData ImageDecoder::DecodeHdr(const unsigned char* bytes, size_t size)
+{
+    int width, height, channels;
+    float* data = stbi_loadf_from_memory(bytes, static_cast<int>(size), &width, &height, &channels, STBI_rgb_alpha);
+    if (!data) {
+        throw std::runtime_error("Failed to load HDR image");
+    }
+
+    // opaque HDR packs into 4 bytes per texel, only images with alpha need half floats
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    bool hasAlpha = channels == 2 || channels == 4;
+    PixelFormat format = hasAlpha ? PixelFormat::RGBA16F : PixelFormat::R11G11B10F;
+    PixelBuffer pixels(GetImageSize(format, width, height));
+    if (hasAlpha)
+        HalfFloat::FromFloat(data, reinterpret_cast<uint16_t*>(pixels.data()), pixelCount * 4);
+    else
+        HalfFloat::PackR11G11B10(data, reinterpret_cast<uint32_t*>(pixels.data()), pixelCount);
+    stbi_image_free(data);
+
+    return { width, height, hasAlpha ? 4 : 3, std::move(pixels), format };
+}
+
+ImageData ImageDecoder::Decode16Bit(const unsigned char* bytes, size_t size)
+{
+    int width, height, channels;
+    stbi_us* data = stbi_load_16_from_memory(bytes, static_cast<int>(size), &width, &height, &channels, STBI_rgb_alpha);
+    if (!data) {
+        throw std::runtime_error("Failed to load 16-bit image");
+    }
+
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    PixelBuffer pixels(GetImageSize(PixelFormat::RGBA16F, width, height));
+    HalfFloat::FromUnorm16(data, reinterpret_cast<uint16_t*>(pixels.data()), pixelCount * 4);
+    stbi_image_free(data);
+
+    return { width, height, 4, std::move(pixels), PixelFormat::RGBA16F };
+}
+
+GifDecoder::GifDecoder(const unsigned char* bytes, size_t size)
+{
+    if (size > static_cast<size_t>(INT_MAX)) {
+        throw std::runtime_error("Image file too large");
+    }
+    mStream = stbi_gif_stream_open(bytes, static_cast<int>(size), &mWidth, &mHeight);
+    if (!mStream) {
+        throw std::runtime_error("Failed to open GIF");
+    }
+}
+
+GifDecoder::~GifDecoder()
+{
+    stbi_gif_stream_close(mStream);
+}
+
+const unsigned char* GifDecoder::NextFrame(int& delayMs)
+{
+    return stbi_gif_stream_next(mStream, &delayMs);
+}
+
+void GifDecoder::Rewind()
+{
+    stbi_gif_stream_rewind(mStream);
+}
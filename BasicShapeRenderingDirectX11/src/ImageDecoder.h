@@ -0,0 +1,52 @@
+#pragma once
+#include <string>
+#include "Image.h"
+
+// Turns encoded image files into ImageData with stb_image. Free of D3D so tools and
+// benchmarks can decode exactly what the renderer uploads. Safe to call from any thread.
+class ImageDecoder
+{
+public:
+	// 8-bit files keep their channel count (grey as R8, grey+alpha as RG8, RGB expanded to
+	// RGBA8). Radiance HDR becomes R11G11B10F (RGBA16F with alpha), 16-bit PNGs RGBA16F.
+	// scaleDenom 2, 4 or 8 decodes JPEGs at that fraction of their size with a reduced
+	// IDCT (sizes round up); other formats always decode in full.
+	static ImageData Decode(const unsigned char* bytes, size_t size, int scaleDenom = 1);
+	// Decodes straight out of a mapping of the file
+	static ImageData LoadFile(const std::string& path, int scaleDenom = 1);
+	// Full-size dimensions from the header alone; false if the format is not recognised
+	static bool ReadSize(const unsigned char* bytes, size_t size, int& width, int& height);
+
+private:
+	static ImageData DecodeHdr(const unsigned char* bytes, size_t size);
+	static ImageData Decode16Bit(const unsigned char* bytes, size_t size);
+};
+
+struct stbi_gif_stream;
+
+// Decodes an animated GIF one composited RGBA8 frame at a time, so memory stays at a few
+// frames however long the animation is. The bytes must outlive the decoder. Not thread-safe,
+// but different decoders may run on different threads.
+class GifDecoder
+{
+public:
+	// Throws std::runtime_error if the bytes are not a GIF
+	GifDecoder(const unsigned char* bytes, size_t size);
+	~GifDecoder();
+
+	GifDecoder(const GifDecoder&) = delete;
+	GifDecoder& operator=(const GifDecoder&) = delete;
+
+	int GetWidth() const { return mWidth; }
+	int GetHeight() const { return mHeight; }
+
+	// Next frame, valid until the following call, or nullptr once the animation has ended
+	const unsigned char* NextFrame(int& delayMs);
+	// Back to the first frame
+	void Rewind();
+
+private:
+	stbi_gif_stream* mStream = nullptr;
+	int mWidth = 0;
+	int mHeight = 0;
+};
@@ -0,0 +1,33 @@
+#include "LodSelector.h"
+
+#include <algorithm>
+
+namespace {
+
+// closer than this the camera is treated as touching the mesh, which always gets level 0
+const float kMinDistance = 1e-4f;
+
+} // namespace
+
+float LodSelector::GetProjectionScale(const glm::mat4& projection, float viewportHeight)
+{
+    // projection[1][1] is cot(fovy / 2), and clip y covers half the viewport per unit
+    return projection[1][1] * viewportHeight * 0.5f;
+}
+
+float LodSelector::GetScreenError(const LodChain& chain, const glm::vec3& cameraPosition, float projectionScale, float error)
+{
+    glm::vec3 center(chain.center[0], chain.center[1], chain.center[2]);
+    float distance = std::max(glm::length(cameraPosition - center) - chain.radius, kMinDistance);
+    return error * projectionScale / distance;
+}
+
+size_t LodSelector::SelectLevel(const LodChain& chain, const glm::vec3& cameraPosition, float projectionScale, float maxPixelError)
+{
+    // errors only grow along the chain, so walk back from the coarsest level
+    for (size_t level = chain.levels.size(); level > 1; --level) {
+        if (GetScreenError(chain, cameraPosition, projectionScale, chain.levels[level - 1].error) <= maxPixelError)
+            return level - 1;
+    }
+    return 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <glm/glm.hpp>
+#include "MeshSimplifier.h"
+
+// Picks a level of detail each frame by how many pixels its geometric error covers on screen
+// at the mesh's distance from the camera
+class LodSelector
+{
+public:
+	// Pixels covered by one unit of size at distance one, from a glm::perspective projection
+	static float GetProjectionScale(const glm::mat4& projection, float viewportHeight);
+
+	// The coarsest level whose error projects to at most maxPixelError pixels. The camera
+	// position is in the mesh's own space, as for ClusterCuller::View.
+	static size_t SelectLevel(const LodChain& chain, const glm::vec3& cameraPosition, float projectionScale, float maxPixelError = 1.0f);
+
+	// On-screen size in pixels of error world units at the nearest point of the chain's bounds
+	static float GetScreenError(const LodChain& chain, const glm::vec3& cameraPosition, float projectionScale, float error);
+};
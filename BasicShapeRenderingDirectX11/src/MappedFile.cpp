@@ -0,0 +1,82 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& path)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Failed to open " + path);
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map empty or unreadable file " + path);
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map " + path);
+    }
+
+    mFile = file;
+    mMapping = mapping;
+    mData = static_cast<const unsigned char*>(view);
+    mSize = static_cast<size_t>(size.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+    UnmapViewOfFile(mData);
+    CloseHandle(mMapping);
+    CloseHandle(mFile);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Failed to open " + path);
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("Failed to map empty or unreadable file " + path);
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        throw std::runtime_error("Failed to map " + path);
+
+    madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+    mData = static_cast<const unsigned char*>(view);
+    mSize = static_cast<size_t>(info.st_size);
+}
+
+MappedFile::~MappedFile()
+{
+    munmap(const_cast<unsigned char*>(mData), mSize);
+}
+
+#endif
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. Throws std::runtime_error if the file
+// cannot be opened or mapped.
+class MappedFile
+{
+public:
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const unsigned char* GetData() const { return mData; }
+	size_t GetSize() const { return mSize; }
+
+private:
+	const unsigned char* mData = nullptr;
+	size_t mSize = 0;
+#if defined(_WIN32)
+	void* mFile = nullptr;
+	void* mMapping = nullptr;
+#endif
+};
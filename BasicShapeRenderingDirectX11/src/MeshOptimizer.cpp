@@ -0,0 +1,316 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+const unsigned int MeshOptimizer::kDefaultCacheSize;
+
+namespace {
+
+const unsigned int kNone = 0xFFFFFFFF;
+
+// FIFO post-transform cache: a vertex is cached while fewer than size others have been
+// shaded after it, so one timestamp per vertex stands in for the queue
+class VertexCache
+{
+public:
+    VertexCache(size_t vertexCount, unsigned int size)
+        : mStamps(vertexCount, 0), mTime(size + 1), mSize(size)
+    {
+    }
+
+    // returns true on a miss
+    bool Access(unsigned int vertex)
+    {
+        if (mTime - mStamps[vertex] <= mSize)
+            return false;
+        mStamps[vertex] = mTime++;
+        return true;
+    }
+
+    unsigned int AccessTriangle(const unsigned int* triangle)
+    {
+        return Access(triangle[0]) + Access(triangle[1]) + Access(triangle[2]);
+    }
+
+    void Flush() { mTime += mSize + 1; }
+
+private:
+    std::vector<unsigned int> mStamps;
+    unsigned int mTime;
+    unsigned int mSize;
+};
+
+void ValidateIndices(const std::vector<unsigned int>& indices, size_t vertexCount)
+{
+    if (indices.size() % 3 != 0)
+        throw std::runtime_error("Index count is not a whole number of triangles");
+    for (unsigned int index : indices) {
+        if (index >= vertexCount)
+            throw std::runtime_error("Index is outside the vertex buffer");
+    }
+}
+
+size_t CountVertices(const std::vector<float>& vertices, size_t floatsPerVertex)
+{
+    if (floatsPerVertex < 3 || vertices.size() % floatsPerVertex != 0)
+        throw std::runtime_error("Vertices need a position and a whole number of floats each");
+    return vertices.size() / floatsPerVertex;
+}
+
+} // namespace
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize)
+{
+    ValidateIndices(indices, vertexCount);
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    // triangles around each vertex, and how many of them are still to be emitted
+    std::vector<unsigned int> liveCount(vertexCount, 0);
+    for (unsigned int index : indices)
+        ++liveCount[index];
+    std::vector<unsigned int> firstTriangle(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v)
+        firstTriangle[v + 1] = firstTriangle[v] + liveCount[v];
+    std::vector<unsigned int> adjacency(indices.size());
+    {
+        std::vector<unsigned int> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i)
+            adjacency[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+    }
+
+    std::vector<unsigned int> timestamps(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> deadEnd;
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+
+    unsigned int time = cacheSize + 1;
+    size_t cursor = 0;
+    unsigned int fanning = indices[0];
+    while (fanning != kNone) {
+        candidates.clear();
+        for (unsigned int i = firstTriangle[fanning]; i < firstTriangle[fanning + 1]; ++i) {
+            unsigned int triangle = adjacency[i];
+            if (emitted[triangle])
+                continue;
+            emitted[triangle] = true;
+            for (int k = 0; k < 3; ++k) {
+                unsigned int v = indices[triangle * 3 + k];
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                --liveCount[v];
+                if (time - timestamps[v] > cacheSize)
+                    timestamps[v] = time++;
+            }
+        }
+
+        // Prefer the 1-ring vertex that has been in the cache longest but will still be there
+        // once its remaining triangles are emitted; vertices that would fall out score 0.
+        fanning = kNone;
+        int bestPriority = -1;
+        for (unsigned int v : candidates) {
+            if (liveCount[v] == 0)
+                continue;
+            int priority = 0;
+            if (time - timestamps[v] + 2 * liveCount[v] <= cacheSize)
+                priority = static_cast<int>(time - timestamps[v]);
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                fanning = v;
+            }
+        }
+
+        // dead end: back up through recently emitted vertices, then fall back to input order
+        while (fanning == kNone && !deadEnd.empty()) {
+            unsigned int v = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveCount[v] > 0)
+                fanning = v;
+        }
+        while (fanning == kNone && cursor < vertexCount) {
+            if (liveCount[cursor] > 0)
+                fanning = static_cast<unsigned int>(cursor);
+            else
+                ++cursor;
+        }
+    }
+
+    indices.swap(result);
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<float>& vertices, size_t floatsPerVertex,
+    bool frontCounterClockwise, float threshold, unsigned int cacheSize)
+{
+    size_t vertexCount = CountVertices(vertices, floatsPerVertex);
+    ValidateIndices(indices, vertexCount);
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    // Hard boundaries: triangles with three misses, where the cache order starts afresh
+    std::vector<unsigned int> clusterStarts;
+    std::vector<unsigned int> misses(triangleCount);
+    {
+        VertexCache cache(vertexCount, cacheSize);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            misses[t] = cache.AccessTriangle(&indices[t * 3]);
+            if (t == 0 || misses[t] == 3)
+                clusterStarts.push_back(static_cast<unsigned int>(t));
+        }
+    }
+
+    // Soft boundaries: cut a hard cluster wherever the part so far is already within the
+    // threshold of the cluster's ACMR, counting the cold cache the next part starts with
+    std::vector<unsigned int> splits;
+    {
+        VertexCache cache(vertexCount, cacheSize);
+        for (size_t c = 0; c < clusterStarts.size(); ++c) {
+            unsigned int start = clusterStarts[c];
+            unsigned int end = c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : static_cast<unsigned int>(triangleCount);
+            unsigned int clusterMisses = 0;
+            for (unsigned int t = start; t < end; ++t)
+                clusterMisses += misses[t];
+            float clusterThreshold = threshold * clusterMisses / (end - start);
+
+            splits.push_back(start);
+            cache.Flush();
+            unsigned int runMisses = 0;
+            unsigned int runTriangles = 0;
+            for (unsigned int t = start; t < end; ++t) {
+                runMisses += cache.AccessTriangle(&indices[t * 3]);
+                ++runTriangles;
+                if (t + 1 < end && runMisses <= clusterThreshold * runTriangles) {
+                    splits.push_back(t + 1);
+                    cache.Flush();
+                    runMisses = 0;
+                    runTriangles = 0;
+                }
+            }
+        }
+    }
+
+    // Area-weighted centroid and normal of each cluster, and of the whole mesh
+    struct Cluster {
+        unsigned int start, end;
+        float centroid[3];
+        float normal[3];
+        float sortKey;
+    };
+    std::vector<Cluster> clusters(splits.size());
+    float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < splits.size(); ++c) {
+        Cluster& cluster = clusters[c];
+        cluster.start = splits[c];
+        cluster.end = c + 1 < splits.size() ? splits[c + 1] : static_cast<unsigned int>(triangleCount);
+        float centroid[3] = { 0.0f, 0.0f, 0.0f };
+        float normal[3] = { 0.0f, 0.0f, 0.0f };
+        float area = 0.0f;
+        for (unsigned int t = cluster.start; t < cluster.end; ++t) {
+            const float* p0 = &vertices[indices[t * 3 + 0] * floatsPerVertex];
+            const float* p1 = &vertices[indices[t * 3 + 1] * floatsPerVertex];
+            const float* p2 = &vertices[indices[t * 3 + 2] * floatsPerVertex];
+            float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            float triangleArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (int k = 0; k < 3; ++k) {
+                centroid[k] += (p0[k] + p1[k] + p2[k]) * (triangleArea / 3.0f);
+                normal[k] += n[k];
+            }
+            area += triangleArea;
+        }
+        // the summed cross products point inwards when front faces are clockwise
+        float normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        float normalScale = normalLength > 0.0f ? (frontCounterClockwise ? 1.0f : -1.0f) / normalLength : 0.0f;
+        for (int k = 0; k < 3; ++k) {
+            meshCentroid[k] += centroid[k];
+            cluster.centroid[k] = area > 0.0f ? centroid[k] / area : 0.0f;
+            cluster.normal[k] = normal[k] * normalScale;
+        }
+        meshArea += area;
+    }
+    if (meshArea > 0.0f) {
+        for (float& value : meshCentroid)
+            value /= meshArea;
+    }
+
+    // clusters further out along their own normal occlude more of the mesh behind them
+    for (Cluster& cluster : clusters) {
+        cluster.sortKey = 0.0f;
+        for (int k = 0; k < 3; ++k)
+            cluster.sortKey += (cluster.centroid[k] - meshCentroid[k]) * cluster.normal[k];
+    }
+    std::stable_sort(clusters.begin(), clusters.end(),
+        [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    for (const Cluster& cluster : clusters)
+        result.insert(result.end(), indices.begin() + cluster.start * 3, indices.begin() + cluster.end * 3);
+    indices.swap(result);
+}
+
+size_t MeshOptimizer::OptimizeVertexFetch(std::vector<float>& vertices, size_t floatsPerVertex, std::vector<unsigned int>& indices)
+{
+    size_t vertexCount = CountVertices(vertices, floatsPerVertex);
+    ValidateIndices(indices, vertexCount);
+
+    std::vector<unsigned int> remap(vertexCount, kNone);
+    std::vector<float> result;
+    result.reserve(vertices.size());
+    unsigned int next = 0;
+    for (unsigned int& index : indices) {
+        if (remap[index] == kNone) {
+            remap[index] = next++;
+            const float* vertex = &vertices[index * floatsPerVertex];
+            result.insert(result.end(), vertex, vertex + floatsPerVertex);
+        }
+        index = remap[index];
+    }
+    vertices.swap(result);
+    return next;
+}
+
+MeshOptimizer::CacheStats MeshOptimizer::AnalyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize)
+{
+    ValidateIndices(indices, vertexCount);
+    CacheStats stats;
+    if (indices.empty())
+        return stats;
+
+    VertexCache cache(vertexCount, cacheSize);
+    std::vector<bool> used(vertexCount, false);
+    size_t uniqueVertices = 0;
+    for (unsigned int index : indices) {
+        stats.transforms += cache.Access(index);
+        if (!used[index]) {
+            used[index] = true;
+            ++uniqueVertices;
+        }
+    }
+    stats.acmr = static_cast<float>(stats.transforms) / (indices.size() / 3);
+    stats.atvr = static_cast<float>(stats.transforms) / uniqueVertices;
+    return stats;
+}
+
+MeshOptimizer::Report MeshOptimizer::Optimize(std::vector<float>& vertices, size_t floatsPerVertex, std::vector<unsigned int>& indices,
+    bool frontCounterClockwise, unsigned int cacheSize)
+{
+    Report report;
+    report.vertexCountBefore = CountVertices(vertices, floatsPerVertex);
+    report.before = AnalyzeVertexCache(indices, report.vertexCountBefore, cacheSize);
+
+    OptimizeVertexCache(indices, report.vertexCountBefore, cacheSize);
+    OptimizeOverdraw(indices, vertices, floatsPerVertex, frontCounterClockwise, 1.05f, cacheSize);
+    report.vertexCountAfter = OptimizeVertexFetch(vertices, floatsPerVertex, indices);
+
+    report.after = AnalyzeVertexCache(indices, report.vertexCountAfter, cacheSize);
+    return report;
+}
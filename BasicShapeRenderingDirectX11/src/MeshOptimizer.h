@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Reorders indexed triangle lists for the GPU's post-transform vertex cache, early depth
+// rejection and vertex fetch. Pure CPU. Vertices are interleaved floats, floatsPerVertex
+// apart, with the position in the first three; indices are a 32-bit triangle list.
+//
+// Run the passes in order: cache, overdraw, then fetch. The overdraw pass only moves whole
+// clusters of the cache-ordered triangles, and the fetch pass renumbers vertices without
+// changing the triangle order.
+class MeshOptimizer
+{
+public:
+	// Post-transform cache efficiency with a simulated FIFO cache. ACMR is vertex shader runs
+	// per triangle (0.5 is the limit for a regular grid, 3 is no reuse at all); ATVR is runs
+	// per distinct vertex, 1 being every vertex shaded exactly once.
+	struct CacheStats {
+		float acmr = 0.0f;
+		float atvr = 0.0f;
+		size_t transforms = 0;
+	};
+
+	struct Report {
+		CacheStats before;
+		CacheStats after;
+		size_t vertexCountBefore = 0;
+		size_t vertexCountAfter = 0;
+	};
+
+	static const unsigned int kDefaultCacheSize = 16;
+
+	// Tipsify (Sander, Nehab and Barczak 2007): fans triangles around each vertex in turn and
+	// picks the next fanning vertex that will still be in a cache of cacheSize entries.
+	// Linear in the triangle count.
+	static void OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = kDefaultCacheSize);
+
+	// Splits the cache-ordered triangles into clusters where the cache would restart anyway,
+	// or where cutting costs less than threshold times the cluster's ACMR, then draws the
+	// clusters facing out from the mesh centre first so they occlude the rest. Front faces
+	// are judged as in MeshletBuilder::Build: with the default clockwise front faces the
+	// outward normal is -cross(p1 - p0, p2 - p0).
+	static void OptimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<float>& vertices, size_t floatsPerVertex,
+		bool frontCounterClockwise = false, float threshold = 1.05f, unsigned int cacheSize = kDefaultCacheSize);
+
+	// Renumbers vertices in the order the indices first use them, so fetches walk the vertex
+	// buffer forwards. Unreferenced vertices are dropped; returns the new vertex count.
+	static size_t OptimizeVertexFetch(std::vector<float>& vertices, size_t floatsPerVertex, std::vector<unsigned int>& indices);
+
+	static CacheStats AnalyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = kDefaultCacheSize);
+
+	// All three passes, with the cache statistics before and after
+	static Report Optimize(std::vector<float>& vertices, size_t floatsPerVertex, std::vector<unsigned int>& indices,
+		bool frontCounterClockwise = false, unsigned int cacheSize = kDefaultCacheSize);
+};
@@ -0,0 +1,362 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+// open border edges are held in place by planes this much heavier than their triangles
+const double kBorderWeight = 10.0;
+// a collapse may turn a triangle by at most about 78 degrees
+const double kMinNormalCosine = 0.2;
+
+// Symmetric 4x4 plane quadric, plus the total weight of the triangle planes in it so the
+// error comes out as an RMS distance
+struct Quadric {
+    double a2 = 0, ab = 0, ac = 0, ad = 0;
+    double b2 = 0, bc = 0, bd = 0;
+    double c2 = 0, cd = 0;
+    double d2 = 0;
+    double weight = 0;
+
+    void AddPlane(double a, double b, double c, double d, double w)
+    {
+        a2 += w * a * a; ab += w * a * b; ac += w * a * c; ad += w * a * d;
+        b2 += w * b * b; bc += w * b * c; bd += w * b * d;
+        c2 += w * c * c; cd += w * c * d;
+        d2 += w * d * d;
+    }
+
+    Quadric& operator+=(const Quadric& q)
+    {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+        b2 += q.b2; bc += q.bc; bd += q.bd;
+        c2 += q.c2; cd += q.cd;
+        d2 += q.d2;
+        weight += q.weight;
+        return *this;
+    }
+
+    double Evaluate(const float* p) const
+    {
+        double x = p[0], y = p[1], z = p[2];
+        double error = a2 * x * x + b2 * y * y + c2 * z * z + d2
+            + 2.0 * (ab * x * y + ac * x * z + bc * y * z + ad * x + bd * y + cd * z);
+        return error > 0.0 ? error : 0.0;
+    }
+};
+
+float CollapseError(const Quadric& source, const Quadric& target, const float* position)
+{
+    Quadric merged = source;
+    merged += target;
+    if (merged.weight <= 0.0)
+        return 0.0f;
+    return static_cast<float>(std::sqrt(merged.Evaluate(position) / merged.weight));
+}
+
+void Cross(const float* p0, const float* p1, const float* p2, double* n)
+{
+    double e1[3] = { (double)p1[0] - p0[0], (double)p1[1] - p0[1], (double)p1[2] - p0[2] };
+    double e2[3] = { (double)p2[0] - p0[0], (double)p2[1] - p0[1], (double)p2[2] - p0[2] };
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+struct PositionKey {
+    uint32_t bits[3];
+    bool operator==(const PositionKey& other) const { return std::memcmp(bits, other.bits, sizeof(bits)) == 0; }
+};
+
+struct PositionHash {
+    size_t operator()(const PositionKey& key) const
+    {
+        return (key.bits[0] * 73856093u) ^ (key.bits[1] * 19349663u) ^ (key.bits[2] * 83492791u);
+    }
+};
+
+struct Collapse {
+    unsigned int source;
+    unsigned int target;
+    float error;
+};
+
+} // namespace
+
+std::vector<unsigned int> MeshSimplifier::Simplify(const std::vector<float>& vertices, size_t floatsPerVertex, const std::vector<unsigned int>& indices,
+    size_t targetIndexCount, float targetError, float* error)
+{
+    if (floatsPerVertex < 3 || vertices.size() % floatsPerVertex != 0)
+        throw std::runtime_error("Vertices need a position and a whole number of floats each");
+    if (indices.size() % 3 != 0)
+        throw std::runtime_error("Index count is not a whole number of triangles");
+    size_t vertexCount = vertices.size() / floatsPerVertex;
+    for (unsigned int index : indices) {
+        if (index >= vertexCount)
+            throw std::runtime_error("Index is outside the vertex buffer");
+    }
+    auto position = [&](unsigned int v) { return &vertices[v * floatsPerVertex]; };
+
+    // Weld vertices by position: split UV or normal seams are one point of the surface
+    std::vector<unsigned int> positionId(vertexCount);
+    size_t positionCount = 0;
+    {
+        std::unordered_map<PositionKey, unsigned int, PositionHash> ids;
+        for (size_t v = 0; v < vertexCount; ++v) {
+            PositionKey key;
+            std::memcpy(key.bits, position(static_cast<unsigned int>(v)), sizeof(key.bits));
+            auto inserted = ids.insert(std::make_pair(key, static_cast<unsigned int>(positionCount)));
+            if (inserted.second)
+                ++positionCount;
+            positionId[v] = inserted.first->second;
+        }
+    }
+    // a position used through more than one vertex is on a seam and is never moved
+    std::vector<unsigned int> wedge(positionCount, 0xFFFFFFFF);
+    std::vector<bool> locked(positionCount, false);
+    for (unsigned int index : indices) {
+        unsigned int id = positionId[index];
+        if (wedge[id] == 0xFFFFFFFF)
+            wedge[id] = index;
+        else if (wedge[id] != index)
+            locked[id] = true;
+    }
+
+    std::vector<Quadric> quadrics(positionCount);
+    std::unordered_map<uint64_t, unsigned int> edgeUse;
+    for (size_t t = 0; t < indices.size(); t += 3) {
+        const float* p[3] = { position(indices[t]), position(indices[t + 1]), position(indices[t + 2]) };
+        double n[3];
+        Cross(p[0], p[1], p[2], n);
+        double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length == 0.0)
+            continue;
+        double area = length * 0.5;
+        for (double& value : n)
+            value /= length;
+        double d = -(n[0] * p[0][0] + n[1] * p[0][1] + n[2] * p[0][2]);
+        for (int k = 0; k < 3; ++k) {
+            Quadric& q = quadrics[positionId[indices[t + k]]];
+            q.AddPlane(n[0], n[1], n[2], d, area);
+            q.weight += area;
+        }
+        for (int k = 0; k < 3; ++k) {
+            uint64_t a = positionId[indices[t + k]], b = positionId[indices[t + (k + 1) % 3]];
+            ++edgeUse[a < b ? (a << 32) | b : (b << 32) | a];
+        }
+    }
+    // Open border edges get a plane through the edge, perpendicular to its triangle
+    for (size_t t = 0; t < indices.size(); t += 3) {
+        for (int k = 0; k < 3; ++k) {
+            unsigned int i0 = indices[t + k], i1 = indices[t + (k + 1) % 3];
+            uint64_t a = positionId[i0], b = positionId[i1];
+            if (edgeUse[a < b ? (a << 32) | b : (b << 32) | a] != 1)
+                continue;
+            const float* p0 = position(i0);
+            const float* p1 = position(i1);
+            double n[3];
+            Cross(position(indices[t]), position(indices[t + 1]), position(indices[t + 2]), n);
+            double e[3] = { (double)p1[0] - p0[0], (double)p1[1] - p0[1], (double)p1[2] - p0[2] };
+            double m[3] = { e[1] * n[2] - e[2] * n[1], e[2] * n[0] - e[0] * n[2], e[0] * n[1] - e[1] * n[0] };
+            double length = std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+            if (length == 0.0)
+                continue;
+            for (double& value : m)
+                value /= length;
+            double d = -(m[0] * p0[0] + m[1] * p0[1] + m[2] * p0[2]);
+            double w = kBorderWeight * (e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+            quadrics[a].AddPlane(m[0], m[1], m[2], d, w);
+            quadrics[b].AddPlane(m[0], m[1], m[2], d, w);
+        }
+    }
+
+    std::vector<unsigned int> result(indices);
+    float resultError = 0.0f;
+    std::vector<unsigned int> liveCount(vertexCount);
+    std::vector<unsigned int> firstTriangle(vertexCount + 1);
+    std::vector<unsigned int> adjacency;
+    std::vector<uint64_t> edges;
+    std::vector<Collapse> collapses;
+    std::vector<unsigned int> remap(vertexCount);
+    std::vector<bool> touched(vertexCount);
+
+    // Each pass collapses the cheapest edges that do not share a neighbourhood, so the checks
+    // against the current triangles stay valid, then rebuilds and goes again
+    while (result.size() > targetIndexCount) {
+        size_t triangleCount = result.size() / 3;
+        std::fill(liveCount.begin(), liveCount.end(), 0);
+        for (unsigned int index : result)
+            ++liveCount[index];
+        firstTriangle[0] = 0;
+        for (size_t v = 0; v < vertexCount; ++v)
+            firstTriangle[v + 1] = firstTriangle[v] + liveCount[v];
+        adjacency.resize(result.size());
+        {
+            std::vector<unsigned int> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+            for (size_t i = 0; i < result.size(); ++i)
+                adjacency[fill[result[i]]++] = static_cast<unsigned int>(i / 3);
+        }
+
+        edges.clear();
+        for (size_t t = 0; t < result.size(); t += 3) {
+            for (int k = 0; k < 3; ++k) {
+                uint64_t a = result[t + k], b = result[t + (k + 1) % 3];
+                edges.push_back(a < b ? (a << 32) | b : (b << 32) | a);
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        collapses.clear();
+        for (uint64_t edge : edges) {
+            unsigned int a = static_cast<unsigned int>(edge >> 32), b = static_cast<unsigned int>(edge);
+            unsigned int pa = positionId[a], pb = positionId[b];
+            if (pa == pb)
+                continue;
+            Collapse best = { 0, 0, -1.0f };
+            if (!locked[pa])
+                best = { a, b, CollapseError(quadrics[pa], quadrics[pb], position(b)) };
+            if (!locked[pb]) {
+                float cost = CollapseError(quadrics[pb], quadrics[pa], position(a));
+                if (best.error < 0.0f || cost < best.error)
+                    best = { b, a, cost };
+            }
+            if (best.error >= 0.0f && best.error <= targetError)
+                collapses.push_back(best);
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.error < y.error; });
+
+        for (size_t v = 0; v < vertexCount; ++v)
+            remap[v] = static_cast<unsigned int>(v);
+        std::fill(touched.begin(), touched.end(), false);
+        size_t targetTriangles = targetIndexCount / 3;
+        size_t removed = 0;
+        size_t applied = 0;
+        for (const Collapse& collapse : collapses) {
+            if (triangleCount - removed <= targetTriangles)
+                break;
+            if (touched[collapse.source] || touched[collapse.target])
+                continue;
+
+            unsigned int targetPosition = positionId[collapse.target];
+            const float* to = position(collapse.target);
+            bool valid = true;
+            size_t collapsed = 0;
+            for (unsigned int a = firstTriangle[collapse.source]; a < firstTriangle[collapse.source + 1] && valid; ++a) {
+                const unsigned int* t = &result[adjacency[a] * 3];
+                int corner = t[0] == collapse.source ? 0 : t[1] == collapse.source ? 1 : 2;
+                unsigned int o1 = t[(corner + 1) % 3], o2 = t[(corner + 2) % 3];
+                if (positionId[o1] == targetPosition || positionId[o2] == targetPosition) {
+                    // the triangle on the edge disappears, but only if it meets the same
+                    // vertex of the target, not another one across a seam
+                    if (o1 != collapse.target && o2 != collapse.target)
+                        valid = false;
+                    ++collapsed;
+                    continue;
+                }
+                // the rest of the fan must not fold over
+                double before[3], after[3];
+                Cross(position(collapse.source), position(o1), position(o2), before);
+                Cross(to, position(o1), position(o2), after);
+                double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+                double lengths = std::sqrt((before[0] * before[0] + before[1] * before[1] + before[2] * before[2])
+                    * (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+                if (dot <= kMinNormalCosine * lengths)
+                    valid = false;
+            }
+            if (!valid)
+                continue;
+
+            remap[collapse.source] = collapse.target;
+            touched[collapse.source] = true;
+            touched[collapse.target] = true;
+            for (unsigned int a = firstTriangle[collapse.source]; a < firstTriangle[collapse.source + 1]; ++a) {
+                const unsigned int* t = &result[adjacency[a] * 3];
+                touched[t[0]] = touched[t[1]] = touched[t[2]] = true;
+            }
+            quadrics[targetPosition] += quadrics[positionId[collapse.source]];
+            resultError = std::max(resultError, collapse.error);
+            removed += collapsed;
+            ++applied;
+        }
+        if (applied == 0)
+            break;
+
+        size_t write = 0;
+        for (size_t t = 0; t < result.size(); t += 3) {
+            unsigned int a = remap[result[t]], b = remap[result[t + 1]], c = remap[result[t + 2]];
+            if (positionId[a] == positionId[b] || positionId[b] == positionId[c] || positionId[a] == positionId[c])
+                continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    if (error)
+        *error = resultError;
+    return result;
+}
+
+LodChain MeshSimplifier::BuildLodChain(const std::vector<float>& vertices, size_t floatsPerVertex, const std::vector<unsigned int>& indices,
+    float maxError, size_t maxLevels, float reduction)
+{
+    LodChain chain;
+    chain.indices = indices;
+    LodLevel full;
+    full.indexCount = static_cast<unsigned int>(indices.size());
+    chain.levels.push_back(full);
+
+    // bounding sphere around the box of the used vertices, for picking a level by distance
+    if (!indices.empty()) {
+        float lower[3], upper[3];
+        for (int k = 0; k < 3; ++k)
+            lower[k] = upper[k] = vertices[indices[0] * floatsPerVertex + k];
+        for (unsigned int index : indices) {
+            for (int k = 0; k < 3; ++k) {
+                float value = vertices[index * floatsPerVertex + k];
+                lower[k] = std::min(lower[k], value);
+                upper[k] = std::max(upper[k], value);
+            }
+        }
+        for (int k = 0; k < 3; ++k)
+            chain.center[k] = (lower[k] + upper[k]) * 0.5f;
+        float radiusSquared = 0.0f;
+        for (unsigned int index : indices) {
+            const float* p = &vertices[index * floatsPerVertex];
+            float d[3] = { p[0] - chain.center[0], p[1] - chain.center[1], p[2] - chain.center[2] };
+            radiusSquared = std::max(radiusSquared, d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        }
+        chain.radius = std::sqrt(radiusSquared);
+    }
+
+    std::vector<unsigned int> current = indices;
+    float totalError = 0.0f;
+    size_t vertexCount = vertices.size() / floatsPerVertex;
+    while (chain.levels.size() < maxLevels && totalError < maxError) {
+        size_t target = static_cast<size_t>(current.size() / 3 * reduction) * 3;
+        float error = 0.0f;
+        std::vector<unsigned int> next = Simplify(vertices, floatsPerVertex, current, target, maxError - totalError, &error);
+        // stop once a level no longer pays for its memory
+        if (next.empty() || next.size() > current.size() * 9 / 10)
+            break;
+
+        totalError += error;
+        MeshOptimizer::OptimizeVertexCache(next, vertexCount);
+        LodLevel level;
+        level.firstIndex = static_cast<unsigned int>(chain.indices.size());
+        level.indexCount = static_cast<unsigned int>(next.size());
+        level.error = totalError;
+        chain.indices.insert(chain.indices.end(), next.begin(), next.end());
+        chain.levels.push_back(level);
+        current.swap(next);
+    }
+    return chain;
+}
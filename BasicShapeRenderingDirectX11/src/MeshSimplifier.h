@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// One level of detail: a range of LodChain::indices, drawn with the shared vertex buffer
+struct LodLevel {
+	unsigned int firstIndex = 0;
+	unsigned int indexCount = 0;
+	float error = 0.0f;		// estimated distance from the full-detail surface, in mesh units
+};
+
+// Every level's indices back to back, so one index buffer and one vertex buffer serve the
+// whole chain. Level 0 is the input mesh.
+struct LodChain {
+	std::vector<unsigned int> indices;
+	std::vector<LodLevel> levels;
+	float center[3] = {};
+	float radius = 0.0f;
+};
+
+// Quadric error metric simplification (Garland and Heckbert 1997). Edges collapse onto one
+// of their existing end points rather than a new position, so the result only needs new
+// indices and every level shares the original vertices. Vertices on UV seams (one position
+// with several vertices) stay put, and open borders are held by constraint planes.
+// Vertices are interleaved floats with the position in the first three.
+class MeshSimplifier
+{
+public:
+	// Collapses the cheapest edges until at most targetIndexCount indices remain or the next
+	// collapse would move the surface by more than targetError. error receives the largest
+	// error accepted, as an RMS distance to the planes merged into the kept vertex.
+	static std::vector<unsigned int> Simplify(const std::vector<float>& vertices, size_t floatsPerVertex, const std::vector<unsigned int>& indices,
+		size_t targetIndexCount, float targetError, float* error = nullptr);
+
+	// Halves the triangle count per level (by reduction) until a level's error would pass
+	// maxError, the mesh stops shrinking or maxLevels is reached. Each level's error adds up
+	// the steps before it, so it bounds the distance from level 0. Levels are reordered for
+	// the vertex cache.
+	static LodChain BuildLodChain(const std::vector<float>& vertices, size_t floatsPerVertex, const std::vector<unsigned int>& indices,
+		float maxError, size_t maxLevels = 8, float reduction = 0.5f);
+};
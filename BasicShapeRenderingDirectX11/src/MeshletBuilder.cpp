@@ -0,0 +1,258 @@
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+const unsigned int MeshletBuilder::kMaxVertices;
+const unsigned int MeshletBuilder::kMaxTriangles;
+
+namespace {
+
+const unsigned char kNotInMeshlet = 0xFF;
+
+inline float Dot(const float* a, const float* b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+inline float DistanceSquared(const float* a, const float* b)
+{
+    float d[3] = { a[0] - b[0], a[1] - b[1], a[2] - b[2] };
+    return Dot(d, d);
+}
+
+} // namespace
+
+MeshletMesh MeshletBuilder::Build(const std::vector<float>& vertices, size_t floatsPerVertex, const std::vector<unsigned int>& indices,
+    bool frontCounterClockwise, unsigned int maxVertices, unsigned int maxTriangles)
+{
+    if (floatsPerVertex < 3 || vertices.size() % floatsPerVertex != 0)
+        throw std::runtime_error("Vertices need a position and a whole number of floats each");
+    if (indices.size() % 3 != 0)
+        throw std::runtime_error("Index count is not a whole number of triangles");
+    // local indices are bytes, and kNotInMeshlet marks a vertex not yet in the meshlet
+    if (maxVertices < 3 || maxVertices > 255 || maxTriangles < 1)
+        throw std::runtime_error("Meshlet limits must allow a triangle and at most 255 vertices");
+
+    size_t vertexCount = vertices.size() / floatsPerVertex;
+    size_t triangleCount = indices.size() / 3;
+    for (unsigned int index : indices) {
+        if (index >= vertexCount)
+            throw std::runtime_error("Index is outside the vertex buffer");
+    }
+
+    // triangles around each vertex, and how many of them are still unassigned
+    std::vector<unsigned int> liveCount(vertexCount, 0);
+    for (unsigned int index : indices)
+        ++liveCount[index];
+    std::vector<unsigned int> firstTriangle(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v)
+        firstTriangle[v + 1] = firstTriangle[v] + liveCount[v];
+    std::vector<unsigned int> adjacency(indices.size());
+    {
+        std::vector<unsigned int> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i)
+            adjacency[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+    }
+
+    MeshletMesh mesh;
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned char> localIndex(vertexCount, kNotInMeshlet);
+    Meshlet meshlet;
+    size_t cursor = 0;
+
+    auto finish = [&]() {
+        for (unsigned int i = 0; i < meshlet.vertexCount; ++i)
+            localIndex[mesh.vertices[meshlet.vertexOffset + i]] = kNotInMeshlet;
+        ComputeBounds(mesh, meshlet, vertices, floatsPerVertex, frontCounterClockwise);
+        mesh.meshlets.push_back(meshlet);
+        meshlet = Meshlet();
+        meshlet.vertexOffset = static_cast<unsigned int>(mesh.vertices.size());
+        meshlet.triangleOffset = static_cast<unsigned int>(mesh.triangles.size() / 3);
+    };
+    auto newVertices = [&](unsigned int triangle) {
+        const unsigned int* t = &indices[triangle * 3];
+        return (localIndex[t[0]] == kNotInMeshlet) + (localIndex[t[1]] == kNotInMeshlet) + (localIndex[t[2]] == kNotInMeshlet);
+    };
+
+    for (size_t added = 0; added < triangleCount; ++added) {
+        // Grow across shared edges: fewest new vertices first, then the triangle whose
+        // vertices have the fewest triangles left, so nearly finished vertices are not
+        // stranded for a later meshlet
+        unsigned int best = 0xFFFFFFFF;
+        unsigned int bestNew = 4, bestLive = 0;
+        for (unsigned int i = 0; i < meshlet.vertexCount; ++i) {
+            unsigned int v = mesh.vertices[meshlet.vertexOffset + i];
+            if (liveCount[v] == 0)
+                continue;
+            for (unsigned int a = firstTriangle[v]; a < firstTriangle[v + 1]; ++a) {
+                unsigned int triangle = adjacency[a];
+                if (emitted[triangle])
+                    continue;
+                const unsigned int* t = &indices[triangle * 3];
+                unsigned int extra = newVertices(triangle);
+                unsigned int live = liveCount[t[0]] + liveCount[t[1]] + liveCount[t[2]];
+                if (extra < bestNew || (extra == bestNew && live < bestLive)) {
+                    best = triangle;
+                    bestNew = extra;
+                    bestLive = live;
+                }
+            }
+        }
+
+        // a neighbour that does not fit seeds the next meshlet, which keeps it nearby
+        if (best != 0xFFFFFFFF && meshlet.vertexCount + bestNew > maxVertices)
+            finish();
+        if (best == 0xFFFFFFFF) {
+            // nothing connected left: carry on with the next triangle in index order
+            while (emitted[cursor])
+                ++cursor;
+            best = static_cast<unsigned int>(cursor);
+            if (meshlet.vertexCount + newVertices(best) > maxVertices)
+                finish();
+        }
+
+        emitted[best] = true;
+        for (int k = 0; k < 3; ++k) {
+            unsigned int v = indices[best * 3 + k];
+            --liveCount[v];
+            if (localIndex[v] == kNotInMeshlet) {
+                localIndex[v] = static_cast<unsigned char>(meshlet.vertexCount++);
+                mesh.vertices.push_back(v);
+            }
+            mesh.triangles.push_back(localIndex[v]);
+        }
+        if (++meshlet.triangleCount == maxTriangles)
+            finish();
+    }
+    if (meshlet.triangleCount > 0)
+        finish();
+    return mesh;
+}
+
+void MeshletBuilder::AppendIndices(const MeshletMesh& mesh, const Meshlet& meshlet, std::vector<unsigned int>& indices)
+{
+    const unsigned int* vertices = &mesh.vertices[meshlet.vertexOffset];
+    const unsigned char* triangles = &mesh.triangles[meshlet.triangleOffset * 3];
+    for (unsigned int i = 0; i < meshlet.triangleCount * 3; ++i)
+        indices.push_back(vertices[triangles[i]]);
+}
+
+std::vector<unsigned int> MeshletBuilder::FlattenIndices(const MeshletMesh& mesh)
+{
+    std::vector<unsigned int> indices;
+    indices.reserve(mesh.triangles.size());
+    for (const Meshlet& meshlet : mesh.meshlets)
+        AppendIndices(mesh, meshlet, indices);
+    return indices;
+}
+
+void MeshletBuilder::ComputeBounds(const MeshletMesh& mesh, Meshlet& meshlet, const std::vector<float>& vertices, size_t floatsPerVertex, bool frontCounterClockwise)
+{
+    const unsigned int* meshletVertices = &mesh.vertices[meshlet.vertexOffset];
+    auto position = [&](unsigned int local) { return &vertices[meshletVertices[local] * floatsPerVertex]; };
+
+    // Ritter's sphere: start from the most distant pair of axis extremes, then grow to
+    // take in any vertex left outside
+    unsigned int minVertex[3] = {}, maxVertex[3] = {};
+    for (unsigned int i = 1; i < meshlet.vertexCount; ++i) {
+        const float* p = position(i);
+        for (int k = 0; k < 3; ++k) {
+            if (p[k] < position(minVertex[k])[k])
+                minVertex[k] = i;
+            if (p[k] > position(maxVertex[k])[k])
+                maxVertex[k] = i;
+        }
+    }
+    int widest = 0;
+    float widestSpan = -1.0f;
+    for (int k = 0; k < 3; ++k) {
+        float span = DistanceSquared(position(minVertex[k]), position(maxVertex[k]));
+        if (span > widestSpan) {
+            widestSpan = span;
+            widest = k;
+        }
+    }
+    const float* a = position(minVertex[widest]);
+    const float* b = position(maxVertex[widest]);
+    float center[3] = { (a[0] + b[0]) * 0.5f, (a[1] + b[1]) * 0.5f, (a[2] + b[2]) * 0.5f };
+    float radius = std::sqrt(widestSpan) * 0.5f;
+    for (unsigned int i = 0; i < meshlet.vertexCount; ++i) {
+        const float* p = position(i);
+        float distance = std::sqrt(DistanceSquared(p, center));
+        if (distance > radius) {
+            float grow = (distance - radius) * 0.5f;
+            radius += grow;
+            for (int k = 0; k < 3; ++k)
+                center[k] += (p[k] - center[k]) * (grow / distance);
+        }
+    }
+    for (int k = 0; k < 3; ++k)
+        meshlet.center[k] = center[k];
+    meshlet.radius = radius;
+
+    // Normal cone: the mean of the unit front-face normals, opened to the widest of them
+    std::vector<float> normals;
+    normals.reserve(meshlet.triangleCount * 3);
+    float axis[3] = { 0.0f, 0.0f, 0.0f };
+    const unsigned char* triangles = &mesh.triangles[meshlet.triangleOffset * 3];
+    for (unsigned int t = 0; t < meshlet.triangleCount; ++t) {
+        const float* p0 = position(triangles[t * 3 + 0]);
+        const float* p1 = position(triangles[t * 3 + 1]);
+        const float* p2 = position(triangles[t * 3 + 2]);
+        float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+        float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+        float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+        float length = std::sqrt(Dot(n, n));
+        // degenerate triangles are never rasterized, so they do not widen the cone
+        if (length == 0.0f)
+            continue;
+        float scale = (frontCounterClockwise ? 1.0f : -1.0f) / length;
+        for (int k = 0; k < 3; ++k) {
+            n[k] *= scale;
+            axis[k] += n[k];
+            normals.push_back(n[k]);
+        }
+    }
+
+    meshlet.coneCutoff = 2.0f;
+    float axisLength = std::sqrt(Dot(axis, axis));
+    if (normals.empty() || axisLength < 1e-6f)
+        return;
+    for (float& value : axis)
+        value /= axisLength;
+
+    float minDot = 1.0f;
+    for (size_t i = 0; i < normals.size(); i += 3)
+        minDot = std::min(minDot, Dot(&normals[i], axis));
+    if (minDot <= 0.0f)
+        return;
+
+    // Move the apex back along the axis until every triangle's plane is in front of it, so
+    // testing the view direction to the apex is conservative for the whole meshlet
+    float maxT = 0.0f;
+    size_t normalIndex = 0;
+    for (unsigned int t = 0; t < meshlet.triangleCount; ++t) {
+        const float* p0 = position(triangles[t * 3 + 0]);
+        const float* p1 = position(triangles[t * 3 + 1]);
+        const float* p2 = position(triangles[t * 3 + 2]);
+        float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+        float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+        float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+        if (Dot(n, n) == 0.0f)
+            continue;
+        const float* normal = &normals[normalIndex];
+        normalIndex += 3;
+        float toCenter[3] = { center[0] - p0[0], center[1] - p0[1], center[2] - p0[2] };
+        float t0 = Dot(toCenter, normal) / Dot(axis, normal);
+        maxT = std::max(maxT, t0);
+    }
+
+    for (int k = 0; k < 3; ++k) {
+        meshlet.coneAxis[k] = axis[k];
+        meshlet.coneApex[k] = center[k] - axis[k] * maxT;
+    }
+    // back-facing once the view direction is within 90 degrees minus the cone's half angle
+    meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// A cluster of at most MeshletBuilder::kMaxVertices vertices and kMaxTriangles triangles,
+// with the bounds a cluster culler needs. Triangles index the meshlet's own vertex list,
+// which in turn holds indices into the original vertex buffer.
+struct Meshlet {
+	unsigned int vertexOffset = 0;		// into MeshletMesh::vertices
+	unsigned int triangleOffset = 0;	// into MeshletMesh::triangles, 3 entries per triangle
+	unsigned int vertexCount = 0;
+	unsigned int triangleCount = 0;
+
+	float center[3] = {};
+	float radius = 0.0f;
+
+	// Every front-face normal is within the cone around coneAxis. Seen from a point p, the
+	// meshlet is entirely back-facing when dot(normalize(coneApex - p), coneAxis) >= coneCutoff.
+	// A cutoff above 1 means the normals are too spread out to ever cull.
+	float coneApex[3] = {};
+	float coneAxis[3] = {};
+	float coneCutoff = 2.0f;
+};
+
+struct MeshletMesh {
+	std::vector<Meshlet> meshlets;
+	std::vector<unsigned int> vertices;
+	std::vector<unsigned char> triangles;
+};
+
+// Splits an indexed triangle list into meshlets. Meshlets grow across shared edges, taking
+// the neighbouring triangle that adds the fewest new vertices, so they stay compact and
+// their bounds tight; run MeshOptimizer::OptimizeVertexCache first for the best seeds.
+// Vertices are interleaved floats with the position in the first three.
+class MeshletBuilder
+{
+public:
+	static const unsigned int kMaxVertices = 64;
+	static const unsigned int kMaxTriangles = 124;
+
+	// Front faces are judged the way D3D11_RASTERIZER_DESC::FrontCounterClockwise does, for
+	// a right-handed camera such as glm::lookAt: with the default clockwise front faces,
+	// cross(p1 - p0, p2 - p0) points away from the viewer.
+	static MeshletMesh Build(const std::vector<float>& vertices, size_t floatsPerVertex, const std::vector<unsigned int>& indices,
+		bool frontCounterClockwise = false, unsigned int maxVertices = kMaxVertices, unsigned int maxTriangles = kMaxTriangles);
+
+	// Appends the meshlet's triangles to indices, in the original vertex numbering
+	static void AppendIndices(const MeshletMesh& mesh, const Meshlet& meshlet, std::vector<unsigned int>& indices);
+	// Every meshlet's triangles in meshlet order, so meshlet i starts at triangleOffset * 3.
+	// Upload this once and draw the ranges ClusterCuller::CullRanges picks out of it.
+	static std::vector<unsigned int> FlattenIndices(const MeshletMesh& mesh);
+
+private:
+	static void ComputeBounds(const MeshletMesh& mesh, Meshlet& meshlet, const std::vector<float>& vertices, size_t floatsPerVertex, bool frontCounterClockwise);
+};
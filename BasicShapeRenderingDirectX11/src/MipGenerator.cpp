@@ -0,0 +1,538 @@
+#include "MipGenerator.h"
+#include "HalfFloat.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+#include <immintrin.h>
+#include <stdexcept>
+
+namespace {
+
+// Last channel of grey+alpha and RGBA images is alpha and is never gamma encoded
+bool IsSrgbChannel(int channel, int channels, bool srgb)
+{
+    bool hasAlpha = channels == 2 || channels == 4;
+    return srgb && !(hasAlpha && channel == channels - 1);
+}
+
+struct SrgbToLinearTable
+{
+    float values[256];
+
+    SrgbToLinearTable()
+    {
+        for (int i = 0; i < 256; ++i) {
+            float c = i / 255.0f;
+            values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+    }
+};
+
+// Linear float -> sRGB byte lookup keyed on the float's exponent and top 8 mantissa bits.
+// Values below 2^-13 round to 0 in sRGB8 anyway, so 13 exponents cover [2^-13, 1).
+struct LinearToSrgbTable
+{
+    static const int kMinExponent = 127 - 13;
+    static const int kEntries = 13 * 256;
+
+    // +3 so a 32-bit gather at the last entry stays inside the table
+    unsigned char values[kEntries + 3];
+
+    LinearToSrgbTable()
+    {
+        for (int i = 0; i < kEntries; ++i) {
+            unsigned int loBits = (unsigned int)(i + (kMinExponent << 8)) << 15;
+            unsigned int hiBits = loBits + (1u << 15);
+            float lo, hi;
+            std::memcpy(&lo, &loBits, sizeof(lo));
+            std::memcpy(&hi, &hiBits, sizeof(hi));
+            float x = 0.5f * (lo + hi);
+            float s = x <= 0.0031308f ? x * 12.92f : 1.055f * std::pow(x, 1.0f / 2.4f) - 0.055f;
+            values[i] = (unsigned char)std::min(255.0f, std::max(0.0f, s * 255.0f + 0.5f));
+        }
+        values[kEntries] = values[kEntries + 1] = values[kEntries + 2] = 0;
+    }
+};
+
+const SrgbToLinearTable& GetSrgbToLinear()
+{
+    static const SrgbToLinearTable table;
+    return table;
+}
+
+const LinearToSrgbTable& GetLinearToSrgb()
+{
+    static const LinearToSrgbTable table;
+    return table;
+}
+
+inline unsigned char EncodeLinearChannel(float x)
+{
+    return (unsigned char)std::min(255.0f, std::max(0.0f, x * 255.0f + 0.5f));
+}
+
+inline unsigned char EncodeSrgbChannel(float x, const LinearToSrgbTable& table)
+{
+    const float minValue = 1.0f / 8192.0f;
+    const float maxValue = 0.99999994f;
+    x = std::min(maxValue, std::max(minValue, x));
+    unsigned int bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    return table.values[(bits >> 15) - (LinearToSrgbTable::kMinExponent << 8)];
+}
+
+// Four interleaved RGBA pixels at a time: SSE2 computes the table indices, the lookups stay scalar
+void EncodeRGBA_SSE2(const float* src, unsigned char* dst, size_t pixels, bool srgb, const LinearToSrgbTable& table)
+{
+    const __m128 minValue = _mm_set1_ps(1.0f / 8192.0f);
+    const __m128 maxValue = _mm_set1_ps(0.99999994f);
+    const __m128i base = _mm_set1_epi32(LinearToSrgbTable::kMinExponent << 8);
+    alignas(16) int idx[4];
+
+    for (size_t i = 0; i < pixels; ++i, src += 4, dst += 4) {
+        __m128 x = _mm_loadu_ps(src);
+        if (!srgb) {
+            __m128i v = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(255.0f)));
+            v = _mm_packs_epi32(v, v);
+            v = _mm_packus_epi16(v, v);
+            int packed = _mm_cvtsi128_si32(v);
+            std::memcpy(dst, &packed, 4);
+            continue;
+        }
+        __m128 clamped = _mm_min_ps(_mm_max_ps(x, minValue), maxValue);
+        __m128i index = _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(clamped), 15), base);
+        _mm_store_si128((__m128i*)idx, index);
+        dst[0] = table.values[idx[0]];
+        dst[1] = table.values[idx[1]];
+        dst[2] = table.values[idx[2]];
+        dst[3] = EncodeLinearChannel(src[3]);
+    }
+}
+
+// Two RGBA pixels per iteration with the table lookups done by a gather
+SIMD_TARGET_AVX2 size_t EncodeRGBA_AVX2(const float* src, unsigned char* dst, size_t pixels, bool srgb, const LinearToSrgbTable& table)
+{
+    const __m256 minValue = _mm256_set1_ps(1.0f / 8192.0f);
+    const __m256 maxValue = _mm256_set1_ps(0.99999994f);
+    const __m256i base = _mm256_set1_epi32(LinearToSrgbTable::kMinExponent << 8);
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    // alpha lanes (3 and 7) take the linear encoding
+    const __m256i srgbLanes = srgb ? _mm256_setr_epi32(-1, -1, -1, 0, -1, -1, -1, 0) : _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 2 <= pixels; i += 2, src += 8, dst += 8) {
+        __m256 x = _mm256_loadu_ps(src);
+
+        __m256 clamped = _mm256_min_ps(_mm256_max_ps(x, minValue), maxValue);
+        __m256i index = _mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(clamped), 15), base);
+        __m256i encoded = _mm256_and_si256(_mm256_i32gather_epi32((const int*)table.values, index, 1), byteMask);
+
+        __m256i linear = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(255.0f)));
+        __m256i v = _mm256_blendv_epi8(linear, encoded, srgbLanes);
+
+        v = _mm256_packs_epi32(v, v);
+        v = _mm256_packus_epi16(v, v);
+        int lo = _mm_cvtsi128_si32(_mm256_castsi256_si128(v));
+        int hi = _mm_cvtsi128_si32(_mm256_extracti128_si256(v, 1));
+        std::memcpy(dst, &lo, 4);
+        std::memcpy(dst + 4, &hi, 4);
+    }
+    return i;
+}
+
+// Two output RGBA pixels per iteration from an even-width source
+SIMD_TARGET_AVX2 int DownsampleBoxRow_AVX(const float* row0, const float* row1, float* dst, int dstWidth)
+{
+    const __m256 quarter = _mm256_set1_ps(0.25f);
+    int x = 0;
+    for (; x + 2 <= dstWidth; x += 2) {
+        __m256 s0 = _mm256_add_ps(_mm256_loadu_ps(row0 + x * 8), _mm256_loadu_ps(row1 + x * 8));
+        __m256 s1 = _mm256_add_ps(_mm256_loadu_ps(row0 + x * 8 + 8), _mm256_loadu_ps(row1 + x * 8 + 8));
+        __m256 lo = _mm256_permute2f128_ps(s0, s1, 0x20);
+        __m256 hi = _mm256_permute2f128_ps(s0, s1, 0x31);
+        _mm256_storeu_ps(dst + x * 4, _mm256_mul_ps(_mm256_add_ps(lo, hi), quarter));
+    }
+    return x;
+}
+
+void DownsampleBoxRow_SSE2(const float* row0, const float* row1, float* dst, int x, int dstWidth)
+{
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    for (; x < dstWidth; ++x) {
+        __m128 a = _mm_add_ps(_mm_loadu_ps(row0 + x * 8), _mm_loadu_ps(row0 + x * 8 + 4));
+        __m128 b = _mm_add_ps(_mm_loadu_ps(row1 + x * 8), _mm_loadu_ps(row1 + x * 8 + 4));
+        _mm_storeu_ps(dst + x * 4, _mm_mul_ps(_mm_add_ps(a, b), quarter));
+    }
+}
+
+// Weighted sum of whole rows, the vertical half of the separable filter
+SIMD_TARGET_AVX2 size_t AccumulateRows_AVX(const float* const* rows, const float* weights, int taps, float* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 acc = _mm256_setzero_ps();
+        for (int k = 0; k < taps; ++k)
+            acc = _mm256_fmadd_ps(_mm256_set1_ps(weights[k]), _mm256_loadu_ps(rows[k] + i), acc);
+        _mm256_storeu_ps(dst + i, acc);
+    }
+    return i;
+}
+
+size_t AccumulateRows_SSE2(const float* const* rows, const float* weights, int taps, float* dst, size_t i, size_t count)
+{
+    for (; i + 4 <= count; i += 4) {
+        __m128 acc = _mm_setzero_ps();
+        for (int k = 0; k < taps; ++k)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(rows[k] + i)));
+        _mm_storeu_ps(dst + i, acc);
+    }
+    return i;
+}
+
+double BesselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    double halfX = 0.5 * x;
+    for (int k = 1; k < 32; ++k) {
+        double t = halfX / k;
+        term *= t * t;
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+// Kaiser-windowed sinc, width 3 and alpha 4 in destination pixel units
+float KaiserWeight(double t)
+{
+    const double width = 3.0;
+    const double alpha = 4.0;
+    const double pi = 3.14159265358979323846;
+
+    double r = t / width;
+    if (r <= -1.0 || r >= 1.0)
+        return 0.0f;
+    double sinc = t == 0.0 ? 1.0 : std::sin(pi * t) / (pi * t);
+    double window = BesselI0(alpha * std::sqrt(1.0 - r * r)) / BesselI0(alpha);
+    return (float)(sinc * window);
+}
+
+// Mitchell-Netravali cubic with B = C = 1/3, support 2
+float MitchellWeight(double t)
+{
+    const double b = 1.0 / 3.0;
+    const double c = 1.0 / 3.0;
+    t = std::fabs(t);
+    if (t < 1.0)
+        return (float)(((12.0 - 9.0 * b - 6.0 * c) * t * t * t + (-18.0 + 12.0 * b + 6.0 * c) * t * t + (6.0 - 2.0 * b)) / 6.0);
+    if (t < 2.0)
+        return (float)(((-b - 6.0 * c) * t * t * t + (6.0 * b + 30.0 * c) * t * t + (-12.0 * b - 48.0 * c) * t + (8.0 * b + 24.0 * c)) / 6.0);
+    return 0.0f;
+}
+
+// sinc windowed by a sinc three times as wide, support 3
+float Lanczos3Weight(double t)
+{
+    const double pi = 3.14159265358979323846;
+    if (t == 0.0)
+        return 1.0f;
+    if (t <= -3.0 || t >= 3.0)
+        return 0.0f;
+    double x = pi * t;
+    return (float)(3.0 * std::sin(x) * std::sin(x / 3.0) / (x * x));
+}
+
+// Per output coordinate: a fixed number of (clamped source index, normalized weight) pairs
+struct FilterTaps
+{
+    int count = 0;
+    std::vector<int> indices;
+    std::vector<float> weights;
+};
+
+// The kernel is stretched by the scale factor when minifying and left at unit width when
+// magnifying, so it always covers at least one source pixel per lobe
+FilterTaps BuildTaps(int srcSize, int dstSize, float (*weightFn)(double), double support)
+{
+    double ratio = (double)srcSize / dstSize;
+    double scale = std::max(1.0, ratio);
+    double radius = support * scale;
+
+    FilterTaps taps;
+    taps.count = (int)std::ceil(radius) * 2 + 1;
+    taps.indices.resize((size_t)dstSize * taps.count);
+    taps.weights.resize((size_t)dstSize * taps.count);
+
+    for (int x = 0; x < dstSize; ++x) {
+        double center = (x + 0.5) * ratio;
+        int first = (int)std::floor(center - radius);
+        float sum = 0.0f;
+        for (int k = 0; k < taps.count; ++k) {
+            int i = first + k;
+            float w = weightFn(((i + 0.5) - center) / scale);
+            taps.indices[(size_t)x * taps.count + k] = std::min(srcSize - 1, std::max(0, i));
+            taps.weights[(size_t)x * taps.count + k] = w;
+            sum += w;
+        }
+        for (int k = 0; k < taps.count; ++k)
+            taps.weights[(size_t)x * taps.count + k] /= sum;
+    }
+    return taps;
+}
+
+// Horizontal half of the separable filter for one row
+void FilterRow(const float* row, int channels, const FilterTaps& taps, float* out, int dstWidth)
+{
+    for (int x = 0; x < dstWidth; ++x) {
+        const int* idx = &taps.indices[(size_t)x * taps.count];
+        const float* w = &taps.weights[(size_t)x * taps.count];
+        if (channels == 4) {
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < taps.count; ++k)
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(row + idx[k] * 4)));
+            _mm_storeu_ps(out + x * 4, acc);
+            continue;
+        }
+        for (int c = 0; c < channels; ++c) {
+            float acc = 0.0f;
+            for (int k = 0; k < taps.count; ++k)
+                acc += w[k] * row[idx[k] * channels + c];
+            out[x * channels + c] = acc;
+        }
+    }
+}
+
+// Vertical half: works on whole rows so it vectorizes regardless of channel count
+void FilterColumns(const float* src, size_t stride, const FilterTaps& taps, float* dst, int dstHeight)
+{
+    bool useAVX = CpuFeatures::Get().HasAVX2();
+    std::vector<const float*> rows(taps.count);
+    for (int y = 0; y < dstHeight; ++y) {
+        const int* idx = &taps.indices[(size_t)y * taps.count];
+        const float* w = &taps.weights[(size_t)y * taps.count];
+        for (int k = 0; k < taps.count; ++k)
+            rows[k] = src + idx[k] * stride;
+
+        float* out = dst + y * stride;
+        size_t i = useAVX ? AccumulateRows_AVX(rows.data(), w, taps.count, out, stride) : 0;
+        i = AccumulateRows_SSE2(rows.data(), w, taps.count, out, i, stride);
+        for (; i < stride; ++i) {
+            float acc = 0.0f;
+            for (int k = 0; k < taps.count; ++k)
+                acc += w[k] * rows[k][i];
+            out[i] = acc;
+        }
+    }
+}
+
+// Converts one row at a time to linear floats; HDR formats come out as RGBA
+class LinearRowDecoder
+{
+public:
+    LinearRowDecoder(const ImageData& image, bool srgb)
+        : mImage(image)
+    {
+        for (int i = 0; i < 256; ++i)
+            mLinear[i] = i / 255.0f;
+        const float* srgbTable = GetSrgbToLinear().values;
+        for (int c = 0; c < image.channels && c < 4; ++c)
+            mChannelTables[c] = IsSrgbChannel(c, image.channels, srgb) ? srgbTable : mLinear;
+    }
+
+    void Decode(int y, float* dst) const
+    {
+        size_t width = (size_t)mImage.width;
+        const unsigned char* src = mImage.data.data() + y * GetRowPitch(mImage.format, mImage.width);
+        if (mImage.format == PixelFormat::RGBA16F) {
+            HalfFloat::ToFloat(reinterpret_cast<const uint16_t*>(src), dst, width * 4);
+            return;
+        }
+        if (mImage.format == PixelFormat::R11G11B10F) {
+            HalfFloat::UnpackR11G11B10(reinterpret_cast<const uint32_t*>(src), dst, width);
+            return;
+        }
+        int channels = mImage.channels;
+        for (size_t i = 0; i < width * channels; i += channels) {
+            for (int c = 0; c < channels; ++c)
+                dst[i + c] = mChannelTables[c][src[i + c]];
+        }
+    }
+
+private:
+    const ImageData& mImage;
+    float mLinear[256];
+    const float* mChannelTables[4];
+};
+
+} // namespace
+
+int MipGenerator::CountMipLevels(int width, int height)
+{
+    int levels = 1;
+    while (width > 1 || height > 1) {
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+        ++levels;
+    }
+    return levels;
+}
+
+std::vector<ImageData> MipGenerator::GenerateMips(const ImageData& source, MipFilter filter, bool srgb)
+{
+    std::vector<ImageData> mips;
+    if (filter == MipFilter::None || (source.width <= 1 && source.height <= 1))
+        return mips;
+    if (source.channels < 1 || source.channels > 4)
+        throw std::runtime_error("Unsupported channel count for mip generation");
+
+    // HDR formats are filtered as RGBA floats whatever their stored channel count
+    int channels = IsFloatFormat(source.format) ? 4 : source.channels;
+    int levels = CountMipLevels(source.width, source.height);
+    mips.reserve(levels - 1);
+
+    std::vector<float> current, next;
+    DecodeToLinear(source, srgb, current);
+
+    int width = source.width;
+    int height = source.height;
+    for (int level = 1; level < levels; ++level) {
+        int nextWidth = std::max(1, width / 2);
+        int nextHeight = std::max(1, height / 2);
+        next.resize((size_t)nextWidth * nextHeight * channels);
+
+        if (filter == MipFilter::Kaiser)
+            DownsampleKaiser(current.data(), width, height, channels, next.data(), nextWidth, nextHeight);
+        else
+            DownsampleBox(current.data(), width, height, channels, next.data(), nextWidth, nextHeight);
+
+        ImageData mip = { nextWidth, nextHeight, source.channels, {}, source.format };
+        EncodeFromLinear(next.data(), nextWidth, nextHeight, channels, srgb, mip);
+        mips.push_back(std::move(mip));
+
+        current.swap(next);
+        width = nextWidth;
+        height = nextHeight;
+    }
+    return mips;
+}
+
+ImageData MipGenerator::Resize(const ImageData& source, int width, int height, ResizeFilter filter, bool srgb)
+{
+    if (width < 1 || height < 1)
+        throw std::runtime_error("Invalid resize target");
+    if (source.channels < 1 || source.channels > 4 || IsBlockCompressed(source.format))
+        throw std::runtime_error("Unsupported image for resize");
+
+    float (*weightFn)(double) = filter == ResizeFilter::Mitchell ? MitchellWeight : Lanczos3Weight;
+    double support = filter == ResizeFilter::Mitchell ? 2.0 : 3.0;
+    FilterTaps horizontal = BuildTaps(source.width, width, weightFn, support);
+    FilterTaps vertical = BuildTaps(source.height, height, weightFn, support);
+
+    // the horizontal pass shrinks each row as it is linearised, so the full-size source is
+    // never expanded to floats
+    int channels = IsFloatFormat(source.format) ? 4 : source.channels;
+    size_t tmpStride = (size_t)width * channels;
+    std::vector<float> row((size_t)source.width * channels);
+    std::vector<float> tmp(tmpStride * source.height);
+    LinearRowDecoder decoder(source, srgb);
+    for (int y = 0; y < source.height; ++y) {
+        decoder.Decode(y, row.data());
+        FilterRow(row.data(), channels, horizontal, tmp.data() + y * tmpStride, width);
+    }
+
+    std::vector<float> pixels(tmpStride * height);
+    FilterColumns(tmp.data(), tmpStride, vertical, pixels.data(), height);
+
+    ImageData result = { width, height, source.channels, {}, source.format };
+    EncodeFromLinear(pixels.data(), width, height, channels, srgb, result);
+    return result;
+}
+
+void MipGenerator::DecodeToLinear(const ImageData& image, bool srgb, std::vector<float>& pixels)
+{
+    size_t stride = (size_t)image.width * (IsFloatFormat(image.format) ? 4 : image.channels);
+    pixels.resize(stride * image.height);
+    LinearRowDecoder decoder(image, srgb);
+    for (int y = 0; y < image.height; ++y)
+        decoder.Decode(y, pixels.data() + y * stride);
+}
+
+void MipGenerator::EncodeFromLinear(const float* pixels, int width, int height, int channels, bool srgb, ImageData& image)
+{
+    size_t pixelCount = (size_t)width * height;
+    if (IsFloatFormat(image.format)) {
+        image.data.resize(GetImageSize(image.format, width, height));
+        if (image.format == PixelFormat::RGBA16F)
+            HalfFloat::FromFloat(pixels, reinterpret_cast<uint16_t*>(image.data.data()), pixelCount * 4);
+        else
+            HalfFloat::PackR11G11B10(pixels, reinterpret_cast<uint32_t*>(image.data.data()), pixelCount);
+        return;
+    }
+
+    const LinearToSrgbTable& table = GetLinearToSrgb();
+    image.data.resize(pixelCount * channels);
+    unsigned char* dst = image.data.data();
+
+    if (channels == 4) {
+        size_t done = 0;
+        if (CpuFeatures::Get().HasAVX2())
+            done = EncodeRGBA_AVX2(pixels, dst, pixelCount, srgb, table);
+        EncodeRGBA_SSE2(pixels + done * 4, dst + done * 4, pixelCount - done, srgb, table);
+        return;
+    }
+
+    for (size_t i = 0; i < pixelCount * channels; i += channels) {
+        for (int c = 0; c < channels; ++c) {
+            float x = pixels[i + c];
+            dst[i + c] = IsSrgbChannel(c, channels, srgb) ? EncodeSrgbChannel(x, table) : EncodeLinearChannel(x);
+        }
+    }
+}
+
+void MipGenerator::DownsampleBox(const float* src, int srcWidth, int srcHeight, int channels, float* dst, int dstWidth, int dstHeight)
+{
+    size_t srcStride = (size_t)srcWidth * channels;
+    size_t dstStride = (size_t)dstWidth * channels;
+    bool fastPath = channels == 4 && srcWidth == dstWidth * 2;
+    bool useAVX = fastPath && CpuFeatures::Get().HasAVX2();
+
+    for (int y = 0; y < dstHeight; ++y) {
+        const float* row0 = src + std::min(2 * y, srcHeight - 1) * srcStride;
+        const float* row1 = src + std::min(2 * y + 1, srcHeight - 1) * srcStride;
+        float* out = dst + y * dstStride;
+
+        if (fastPath) {
+            int x = useAVX ? DownsampleBoxRow_AVX(row0, row1, out, dstWidth) : 0;
+            DownsampleBoxRow_SSE2(row0, row1, out, x, dstWidth);
+            continue;
+        }
+
+        // odd widths and non-RGBA images clamp the second column at the edge
+        for (int x = 0; x < dstWidth; ++x) {
+            int x0 = std::min(2 * x, srcWidth - 1) * channels;
+            int x1 = std::min(2 * x + 1, srcWidth - 1) * channels;
+            for (int c = 0; c < channels; ++c)
+                out[x * channels + c] = 0.25f * (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c]);
+        }
+    }
+}
+
+void MipGenerator::DownsampleKaiser(const float* src, int srcWidth, int srcHeight, int channels, float* dst, int dstWidth, int dstHeight)
+{
+    FilterTaps horizontal = BuildTaps(srcWidth, dstWidth, KaiserWeight, 3.0);
+    FilterTaps vertical = BuildTaps(srcHeight, dstHeight, KaiserWeight, 3.0);
+
+    // horizontal pass into a dstWidth x srcHeight intermediate
+    size_t srcStride = (size_t)srcWidth * channels;
+    size_t tmpStride = (size_t)dstWidth * channels;
+    std::vector<float> tmp(tmpStride * srcHeight);
+    for (int y = 0; y < srcHeight; ++y)
+        FilterRow(src + y * srcStride, channels, horizontal, tmp.data() + y * tmpStride, dstWidth);
+
+    FilterColumns(tmp.data(), tmpStride, vertical, dst, dstHeight);
+}
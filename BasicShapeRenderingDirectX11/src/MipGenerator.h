@@ -0,0 +1,25 @@
+#pragma once
+#include "Image.h"
+#include <vector>
+
+// Builds mip chains and resizes images on the CPU. Filtering happens in linear light: sRGB
+// colour channels are decoded before downsampling and re-encoded afterwards, alpha stays
+// linear. HDR formats are already linear and are filtered as they are.
+class MipGenerator
+{
+public:
+	// Returns levels 1..N-1 (the source image is level 0 and is not copied).
+	static std::vector<ImageData> GenerateMips(const ImageData& source, MipFilter filter, bool srgb = true);
+	static int CountMipLevels(int width, int height);
+
+	// Separable resample to any size, keeping the format. Source rows are linearised one at
+	// a time, so only the horizontally filtered image is held as floats.
+	static ImageData Resize(const ImageData& source, int width, int height, ResizeFilter filter, bool srgb = true);
+
+private:
+	static void DecodeToLinear(const ImageData& image, bool srgb, std::vector<float>& pixels);
+	static void EncodeFromLinear(const float* pixels, int width, int height, int channels, bool srgb, ImageData& image);
+
+	static void DownsampleBox(const float* src, int srcWidth, int srcHeight, int channels, float* dst, int dstWidth, int dstHeight);
+	static void DownsampleKaiser(const float* src, int srcWidth, int srcHeight, int channels, float* dst, int dstWidth, int dstHeight);
+};
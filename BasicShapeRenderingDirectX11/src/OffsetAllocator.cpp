@@ -0,0 +1,256 @@
+#include "OffsetAllocator.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+const uint32_t OffsetAllocator::kNoSpace;
+const uint32_t OffsetAllocator::kNone;
+
+namespace {
+
+const uint32_t kMantissaBits = 3;
+const uint32_t kMantissaValue = 1 << kMantissaBits;
+const uint32_t kMantissaMask = kMantissaValue - 1;
+
+// v must be non-zero
+inline uint32_t LowestSetBit(uint32_t v)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, v);
+    return index;
+#else
+    return static_cast<uint32_t>(__builtin_ctz(v));
+#endif
+}
+
+inline uint32_t HighestSetBit(uint32_t v)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, v);
+    return index;
+#else
+    return 31u - static_cast<uint32_t>(__builtin_clz(v));
+#endif
+}
+
+} // namespace
+
+// Sizes below 8 get a bin each; above that the three bits under the leading one are the
+// mantissa and the leading bit's position the exponent, so bins grow by 1/8 per step.
+uint32_t OffsetAllocator::SizeToBinRoundUp(uint32_t size)
+{
+    if (size < kMantissaValue)
+        return size;
+    uint32_t mantissaStart = HighestSetBit(size) - kMantissaBits;
+    uint32_t exponent = mantissaStart + 1;
+    uint32_t mantissa = (size >> mantissaStart) & kMantissaMask;
+    // a carry out of the mantissa moves on to the next exponent, which is what we want
+    if (size & ((1u << mantissaStart) - 1))
+        ++mantissa;
+    return (exponent << kMantissaBits) + mantissa;
+}
+
+uint32_t OffsetAllocator::SizeToBinRoundDown(uint32_t size)
+{
+    if (size < kMantissaValue)
+        return size;
+    uint32_t mantissaStart = HighestSetBit(size) - kMantissaBits;
+    uint32_t exponent = mantissaStart + 1;
+    uint32_t mantissa = (size >> mantissaStart) & kMantissaMask;
+    return (exponent << kMantissaBits) | mantissa;
+}
+
+uint32_t OffsetAllocator::BinToSize(uint32_t bin)
+{
+    uint32_t exponent = bin >> kMantissaBits;
+    uint32_t mantissa = bin & kMantissaMask;
+    if (exponent == 0)
+        return mantissa;
+    return (mantissa | kMantissaValue) << (exponent - 1);
+}
+
+OffsetAllocator::OffsetAllocator(uint32_t size)
+    : mSize(size)
+{
+    for (uint32_t& head : mBinHeads)
+        head = kNone;
+    if (size > 0)
+        InsertIntoBin(size, 0);
+}
+
+uint32_t OffsetAllocator::FindFreeBin(uint32_t minBin) const
+{
+    uint32_t top = minBin / kLeafBins;
+    uint32_t leaf = minBin % kLeafBins;
+
+    // first try the rest of the same top bin, then any larger top bin
+    if (mUsedTopBins & (1u << top)) {
+        uint32_t leaves = mUsedLeafBins[top] & ~((1u << leaf) - 1);
+        if (leaves)
+            return top * kLeafBins + LowestSetBit(leaves);
+    }
+    if (top + 1 >= static_cast<uint32_t>(kTopBins))
+        return kNone;
+    uint32_t tops = mUsedTopBins & ~((1u << (top + 1)) - 1);
+    if (!tops)
+        return kNone;
+    top = LowestSetBit(tops);
+    return top * kLeafBins + LowestSetBit(mUsedLeafBins[top]);
+}
+
+OffsetAllocator::Allocation OffsetAllocator::Allocate(uint32_t size)
+{
+    Allocation allocation;
+    if (size == 0)
+        return allocation;
+
+    uint32_t nodeIndex = kNone;
+    uint32_t bin = FindFreeBin(SizeToBinRoundUp(size));
+    if (bin != kNone) {
+        nodeIndex = mBinHeads[bin];
+    } else {
+        // Rounding up skips the request's own bin, which may still hold a range that is
+        // big enough. Walking that one list keeps a nearly full buffer usable.
+        for (uint32_t node = mBinHeads[SizeToBinRoundDown(size)]; node != kNone; node = mNodes[node].binNext) {
+            if (mNodes[node].size >= size) {
+                nodeIndex = node;
+                break;
+            }
+        }
+        if (nodeIndex == kNone)
+            return allocation;
+    }
+
+    RemoveFromBin(nodeIndex);
+    Node& node = mNodes[nodeIndex];
+    uint32_t remainder = node.size - size;
+    node.size = size;
+    node.used = true;
+
+    // the tail goes back to the bins as a new free neighbour
+    if (remainder > 0) {
+        uint32_t rest = InsertIntoBin(remainder, mNodes[nodeIndex].offset + size);
+        Node& restNode = mNodes[rest];
+        Node& usedNode = mNodes[nodeIndex];
+        restNode.neighbourPrev = nodeIndex;
+        restNode.neighbourNext = usedNode.neighbourNext;
+        if (usedNode.neighbourNext != kNone)
+            mNodes[usedNode.neighbourNext].neighbourPrev = rest;
+        usedNode.neighbourNext = rest;
+    }
+
+    allocation.offset = mNodes[nodeIndex].offset;
+    allocation.node = nodeIndex;
+    return allocation;
+}
+
+void OffsetAllocator::Free(const Allocation& allocation)
+{
+    if (allocation.node == kNone)
+        return;
+
+    Node node = mNodes[allocation.node];
+    uint32_t offset = node.offset;
+    uint32_t size = node.size;
+    uint32_t prev = node.neighbourPrev;
+    uint32_t next = node.neighbourNext;
+    mFreeNodes.push_back(allocation.node);
+
+    // merge with free neighbours on either side
+    if (prev != kNone && !mNodes[prev].used) {
+        const Node& previous = mNodes[prev];
+        offset = previous.offset;
+        size += previous.size;
+        uint32_t before = previous.neighbourPrev;
+        RemoveFromBin(prev);
+        mFreeNodes.push_back(prev);
+        prev = before;
+    }
+    if (next != kNone && !mNodes[next].used) {
+        size += mNodes[next].size;
+        uint32_t after = mNodes[next].neighbourNext;
+        RemoveFromBin(next);
+        mFreeNodes.push_back(next);
+        next = after;
+    }
+
+    uint32_t merged = InsertIntoBin(size, offset);
+    mNodes[merged].neighbourPrev = prev;
+    mNodes[merged].neighbourNext = next;
+    if (prev != kNone)
+        mNodes[prev].neighbourNext = merged;
+    if (next != kNone)
+        mNodes[next].neighbourPrev = merged;
+}
+
+uint32_t OffsetAllocator::GetLargestFree() const
+{
+    if (!mUsedTopBins)
+        return 0;
+    uint32_t top = HighestSetBit(mUsedTopBins);
+    uint32_t bin = top * kLeafBins + HighestSetBit(mUsedLeafBins[top]);
+    // a bin holds sizes from its own up to the next one, so look at the actual ranges
+    uint32_t largest = 0;
+    for (uint32_t node = mBinHeads[bin]; node != kNone; node = mNodes[node].binNext) {
+        if (mNodes[node].size > largest)
+            largest = mNodes[node].size;
+    }
+    return largest;
+}
+
+uint32_t OffsetAllocator::InsertIntoBin(uint32_t size, uint32_t offset)
+{
+    uint32_t bin = SizeToBinRoundDown(size);
+    uint32_t top = bin / kLeafBins;
+    uint32_t leaf = bin % kLeafBins;
+    mUsedTopBins |= 1u << top;
+    mUsedLeafBins[top] |= static_cast<uint8_t>(1u << leaf);
+
+    uint32_t nodeIndex;
+    if (!mFreeNodes.empty()) {
+        nodeIndex = mFreeNodes.back();
+        mFreeNodes.pop_back();
+    } else {
+        nodeIndex = static_cast<uint32_t>(mNodes.size());
+        mNodes.emplace_back();
+    }
+
+    Node& node = mNodes[nodeIndex];
+    node = Node();
+    node.offset = offset;
+    node.size = size;
+    node.binNext = mBinHeads[bin];
+    if (node.binNext != kNone)
+        mNodes[node.binNext].binPrev = nodeIndex;
+    mBinHeads[bin] = nodeIndex;
+    mFreeStorage += size;
+    return nodeIndex;
+}
+
+void OffsetAllocator::RemoveFromBin(uint32_t nodeIndex)
+{
+    Node& node = mNodes[nodeIndex];
+    if (node.binPrev != kNone) {
+        mNodes[node.binPrev].binNext = node.binNext;
+        if (node.binNext != kNone)
+            mNodes[node.binNext].binPrev = node.binPrev;
+    } else {
+        uint32_t bin = SizeToBinRoundDown(node.size);
+        uint32_t top = bin / kLeafBins;
+        uint32_t leaf = bin % kLeafBins;
+        mBinHeads[bin] = node.binNext;
+        if (node.binNext != kNone)
+            mNodes[node.binNext].binPrev = kNone;
+        if (mBinHeads[bin] == kNone) {
+            mUsedLeafBins[top] &= static_cast<uint8_t>(~(1u << leaf));
+            if (!mUsedLeafBins[top])
+                mUsedTopBins &= ~(1u << top);
+        }
+    }
+    node.binPrev = kNone;
+    node.binNext = kNone;
+    mFreeStorage -= node.size;
+}
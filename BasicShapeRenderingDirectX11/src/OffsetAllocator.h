@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Two-level segregated fit (TLSF) allocator for ranges inside a buffer it never touches.
+// Free ranges are kept in 256 size bins, each a float with a 3-bit mantissa, so both
+// Allocate and Free are O(1): a couple of bit scans to find a bin, and merging with at
+// most two neighbours on free. Units are whatever the caller counts in (bytes, vertices).
+class OffsetAllocator
+{
+public:
+	static const uint32_t kNoSpace = 0xFFFFFFFF;
+
+	struct Allocation {
+		uint32_t offset = kNoSpace;
+		uint32_t node = kNoSpace;	// internal, identifies the range to Free
+	};
+
+	explicit OffsetAllocator(uint32_t size);
+
+	// offset == kNoSpace when no free range is big enough
+	Allocation Allocate(uint32_t size);
+	void Free(const Allocation& allocation);
+
+	uint32_t GetSize() const { return mSize; }
+	uint32_t GetFreeStorage() const { return mFreeStorage; }
+	// Biggest single allocation that would currently succeed
+	uint32_t GetLargestFree() const;
+
+	static uint32_t SizeToBinRoundUp(uint32_t size);
+	static uint32_t SizeToBinRoundDown(uint32_t size);
+	static uint32_t BinToSize(uint32_t bin);
+
+private:
+	static const int kTopBins = 32;
+	static const int kLeafBins = 8;
+	static const int kBinCount = kTopBins * kLeafBins;
+	static const uint32_t kNone = 0xFFFFFFFF;
+
+	struct Node {
+		uint32_t offset = 0;
+		uint32_t size = 0;
+		uint32_t binPrev = kNone;
+		uint32_t binNext = kNone;
+		uint32_t neighbourPrev = kNone;
+		uint32_t neighbourNext = kNone;
+		bool used = false;
+	};
+
+	uint32_t InsertIntoBin(uint32_t size, uint32_t offset);
+	void RemoveFromBin(uint32_t node);
+	uint32_t FindFreeBin(uint32_t minBin) const;
+
+private:
+	uint32_t mSize;
+	uint32_t mFreeStorage = 0;
+	uint32_t mUsedTopBins = 0;
+	uint8_t mUsedLeafBins[kTopBins] = {};
+	uint32_t mBinHeads[kBinCount];
+
+	std::vector<Node> mNodes;
+	std::vector<uint32_t> mFreeNodes;
+};
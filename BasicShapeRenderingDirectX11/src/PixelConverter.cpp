@@ -0,0 +1,342 @@
+#include "PixelConverter.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+struct ColourTables
+{
+    unsigned char srgbToLinear[256];
+    unsigned char linearToSrgb[256];
+
+    ColourTables()
+    {
+        for (int i = 0; i < 256; ++i) {
+            float c = i / 255.0f;
+            float linear = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            float srgb = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+            srgbToLinear[i] = (unsigned char)(linear * 255.0f + 0.5f);
+            linearToSrgb[i] = (unsigned char)(srgb * 255.0f + 0.5f);
+        }
+    }
+};
+
+const ColourTables& GetColourTables()
+{
+    static const ColourTables tables;
+    return tables;
+}
+
+// round(c * a / 255) without a divide
+inline unsigned char MultiplyAlpha(unsigned int c, unsigned int a)
+{
+    unsigned int x = c * a + 128;
+    return (unsigned char)((x + (x >> 8)) >> 8);
+}
+
+// Four pixels per iteration. A 16-byte load covers 5 and a third pixels, so the loop
+// stops while at least 6 remain.
+SIMD_TARGET_SSSE3 size_t ExpandRGBToRGBA_SSSE3(const unsigned char* rgb, unsigned char* rgba, size_t pixels)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+    size_t i = 0;
+    for (; i + 6 <= pixels; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(rgb + i * 3));
+        _mm_storeu_si128((__m128i*)(rgba + i * 4), _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alpha));
+    }
+    return i;
+}
+
+void ExpandGreyToRGBA(const unsigned char* grey, unsigned char* rgba, size_t pixels)
+{
+    const __m128i opaque = _mm_set1_epi8((char)0xFF);
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        __m128i g = _mm_loadu_si128((const __m128i*)(grey + i));
+        __m128i gg0 = _mm_unpacklo_epi8(g, g);
+        __m128i gg1 = _mm_unpackhi_epi8(g, g);
+        __m128i ga0 = _mm_unpacklo_epi8(g, opaque);
+        __m128i ga1 = _mm_unpackhi_epi8(g, opaque);
+        _mm_storeu_si128((__m128i*)(rgba + i * 4), _mm_unpacklo_epi16(gg0, ga0));
+        _mm_storeu_si128((__m128i*)(rgba + i * 4 + 16), _mm_unpackhi_epi16(gg0, ga0));
+        _mm_storeu_si128((__m128i*)(rgba + i * 4 + 32), _mm_unpacklo_epi16(gg1, ga1));
+        _mm_storeu_si128((__m128i*)(rgba + i * 4 + 48), _mm_unpackhi_epi16(gg1, ga1));
+    }
+    for (; i < pixels; ++i) {
+        rgba[i * 4 + 0] = rgba[i * 4 + 1] = rgba[i * 4 + 2] = grey[i];
+        rgba[i * 4 + 3] = 255;
+    }
+}
+
+void ExpandGreyAlphaToRGBA(const unsigned char* ga, unsigned char* rgba, size_t pixels)
+{
+    const __m128i lowByte = _mm_set1_epi16(0xFF);
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(ga + i * 2));
+        __m128i g = _mm_and_si128(v, lowByte);
+        __m128i gg = _mm_or_si128(g, _mm_slli_epi16(g, 8));
+        _mm_storeu_si128((__m128i*)(rgba + i * 4), _mm_unpacklo_epi16(gg, v));
+        _mm_storeu_si128((__m128i*)(rgba + i * 4 + 16), _mm_unpackhi_epi16(gg, v));
+    }
+    for (; i < pixels; ++i) {
+        rgba[i * 4 + 0] = rgba[i * 4 + 1] = rgba[i * 4 + 2] = ga[i * 2];
+        rgba[i * 4 + 3] = ga[i * 2 + 1];
+    }
+}
+
+} // namespace
+
+PixelFormat PixelConverter::ChooseFormat(int sourceChannels)
+{
+    switch (sourceChannels) {
+    case 1:
+        return PixelFormat::R8;
+    case 2:
+        return PixelFormat::RG8;
+    default:
+        return PixelFormat::RGBA8;
+    }
+}
+
+ImageData PixelConverter::Convert(const ImageData& image, PixelFormat format)
+{
+    if (IsBlockCompressed(image.format) || IsBlockCompressed(format) || IsFloatFormat(image.format) || IsFloatFormat(format)) {
+        throw std::runtime_error("Pixel conversion needs 8-bit uncompressed formats");
+    }
+
+    size_t pixels = static_cast<size_t>(image.width) * image.height;
+    int channels = GetBytesPerPixel(format);
+    ImageData result = { image.width, image.height, channels, PixelBuffer(pixels * channels), format };
+
+    if (image.format == format) {
+        std::memcpy(result.data.data(), image.data.data(), result.data.size());
+    }
+    else if (format == PixelFormat::RGBA8) {
+        if (image.format == PixelFormat::R8)
+            ExpandGreyToRGBA(image.data.data(), result.data.data(), pixels);
+        else
+            ExpandGreyAlphaToRGBA(image.data.data(), result.data.data(), pixels);
+    }
+    else if (image.format == PixelFormat::RGBA8) {
+        if (format == PixelFormat::R8)
+            ExtractChannel(image.data.data(), result.data.data(), pixels, 0);
+        else
+            ExtractChannelPair(image.data.data(), result.data.data(), pixels, 0, 3);
+    }
+    else {
+        // between R8 and RG8
+        const unsigned char* src = image.data.data();
+        unsigned char* dst = result.data.data();
+        for (size_t i = 0; i < pixels; ++i) {
+            if (format == PixelFormat::R8) {
+                dst[i] = src[i * 2];
+            }
+            else {
+                dst[i * 2] = src[i];
+                dst[i * 2 + 1] = 255;
+            }
+        }
+    }
+    return result;
+}
+
+ImageData PixelConverter::PackChannels(const ImageData* red, const ImageData* green, const ImageData* blue, const ImageData* alpha)
+{
+    const ImageData* sources[4] = { red, green, blue, alpha };
+    const ImageData* first = nullptr;
+    for (const ImageData* source : sources) {
+        if (!source)
+            continue;
+        if (!first)
+            first = source;
+        if (source->width != first->width || source->height != first->height) {
+            throw std::runtime_error("Packed channels must share one size");
+        }
+    }
+    if (!first) {
+        throw std::runtime_error("Channel packing needs at least one source");
+    }
+
+    size_t pixels = static_cast<size_t>(first->width) * first->height;
+    ImageData converted[4];
+    std::vector<unsigned char> fill[4];
+    const unsigned char* planes[4];
+    for (int c = 0; c < 4; ++c) {
+        if (!sources[c]) {
+            fill[c].assign(pixels, c == 3 ? 255 : 0);
+            planes[c] = fill[c].data();
+        }
+        else if (sources[c]->format != PixelFormat::R8) {
+            converted[c] = Convert(*sources[c], PixelFormat::R8);
+            planes[c] = converted[c].data.data();
+        }
+        else {
+            planes[c] = sources[c]->data.data();
+        }
+    }
+
+    ImageData result = { first->width, first->height, 4, PixelBuffer(pixels * 4), PixelFormat::RGBA8 };
+    InterleaveRGBA(planes[0], planes[1], planes[2], planes[3], result.data.data(), pixels);
+    return result;
+}
+
+void PixelConverter::PremultiplyAlpha(ImageData& image)
+{
+    size_t pixels = static_cast<size_t>(image.width) * image.height;
+    if (image.format == PixelFormat::RGBA8) {
+        PremultiplyAlpha(image.data.data(), pixels);
+    }
+    else if (image.format == PixelFormat::RG8) {
+        unsigned char* p = image.data.data();
+        for (size_t i = 0; i < pixels; ++i)
+            p[i * 2] = MultiplyAlpha(p[i * 2], p[i * 2 + 1]);
+    }
+    else if (image.format != PixelFormat::R8) {
+        throw std::runtime_error("Premultiplying needs an 8-bit uncompressed format");
+    }
+}
+
+void PixelConverter::SrgbToLinear(ImageData& image)
+{
+    ApplyColourTable(image, GetColourTables().srgbToLinear);
+}
+
+void PixelConverter::LinearToSrgb(ImageData& image)
+{
+    ApplyColourTable(image, GetColourTables().linearToSrgb);
+}
+
+void PixelConverter::ApplyColourTable(ImageData& image, const unsigned char table[256])
+{
+    if (IsBlockCompressed(image.format) || IsFloatFormat(image.format)) {
+        throw std::runtime_error("Colour conversion needs an 8-bit uncompressed format");
+    }
+
+    // byte lookups beat any shuffle-based SIMD table this small, so just keep alpha out of it
+    size_t pixels = static_cast<size_t>(image.width) * image.height;
+    unsigned char* p = image.data.data();
+    if (image.format == PixelFormat::RGBA8) {
+        for (size_t i = 0; i < pixels; ++i, p += 4) {
+            p[0] = table[p[0]];
+            p[1] = table[p[1]];
+            p[2] = table[p[2]];
+        }
+    }
+    else {
+        int stride = GetBytesPerPixel(image.format);
+        for (size_t i = 0; i < pixels; ++i, p += stride)
+            p[0] = table[p[0]];
+    }
+}
+
+void PixelConverter::ExpandRGBToRGBA(const unsigned char* rgb, unsigned char* rgba, size_t pixels)
+{
+    size_t i = CpuFeatures::Get().HasSSSE3() ? ExpandRGBToRGBA_SSSE3(rgb, rgba, pixels) : 0;
+    for (; i < pixels; ++i) {
+        rgba[i * 4 + 0] = rgb[i * 3 + 0];
+        rgba[i * 4 + 1] = rgb[i * 3 + 1];
+        rgba[i * 4 + 2] = rgb[i * 3 + 2];
+        rgba[i * 4 + 3] = 255;
+    }
+}
+
+void PixelConverter::ExtractChannel(const unsigned char* rgba, unsigned char* dst, size_t pixels, int channel)
+{
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+    const __m128i shift = _mm_cvtsi32_si128(channel * 8);
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        __m128i a = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i*)(rgba + i * 4)), shift), byteMask);
+        __m128i b = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i*)(rgba + i * 4 + 16)), shift), byteMask);
+        __m128i c = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i*)(rgba + i * 4 + 32)), shift), byteMask);
+        __m128i d = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i*)(rgba + i * 4 + 48)), shift), byteMask);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+    }
+    for (; i < pixels; ++i)
+        dst[i] = rgba[i * 4 + channel];
+}
+
+void PixelConverter::ExtractChannelPair(const unsigned char* rgba, unsigned char* dst, size_t pixels, int first, int second)
+{
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+    const __m128i firstShift = _mm_cvtsi32_si128(first * 8);
+    const __m128i secondShift = _mm_cvtsi32_si128(second * 8);
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        __m128i packed[2];
+        for (int half = 0; half < 2; ++half) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(rgba + i * 4 + half * 16));
+            __m128i lo = _mm_and_si128(_mm_srl_epi32(v, firstShift), byteMask);
+            __m128i hi = _mm_and_si128(_mm_srl_epi32(v, secondShift), byteMask);
+            // sign-extend the 16-bit pair so the saturating pack leaves it untouched
+            __m128i pair = _mm_or_si128(lo, _mm_slli_epi32(hi, 8));
+            packed[half] = _mm_srai_epi32(_mm_slli_epi32(pair, 16), 16);
+        }
+        _mm_storeu_si128((__m128i*)(dst + i * 2), _mm_packs_epi32(packed[0], packed[1]));
+    }
+    for (; i < pixels; ++i) {
+        dst[i * 2] = rgba[i * 4 + first];
+        dst[i * 2 + 1] = rgba[i * 4 + second];
+    }
+}
+
+void PixelConverter::InterleaveRGBA(const unsigned char* r, const unsigned char* g, const unsigned char* b, const unsigned char* a, unsigned char* rgba, size_t pixels)
+{
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        __m128i vr = _mm_loadu_si128((const __m128i*)(r + i));
+        __m128i vg = _mm_loadu_si128((const __m128i*)(g + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i rg0 = _mm_unpacklo_epi8(vr, vg);
+        __m128i rg1 = _mm_unpackhi_epi8(vr, vg);
+        __m128i ba0 = _mm_unpacklo_epi8(vb, va);
+        __m128i ba1 = _mm_unpackhi_epi8(vb, va);
+        _mm_storeu_si128((__m128i*)(rgba + i * 4), _mm_unpacklo_epi16(rg0, ba0));
+        _mm_storeu_si128((__m128i*)(rgba + i * 4 + 16), _mm_unpackhi_epi16(rg0, ba0));
+        _mm_storeu_si128((__m128i*)(rgba + i * 4 + 32), _mm_unpacklo_epi16(rg1, ba1));
+        _mm_storeu_si128((__m128i*)(rgba + i * 4 + 48), _mm_unpackhi_epi16(rg1, ba1));
+    }
+    for (; i < pixels; ++i) {
+        rgba[i * 4 + 0] = r[i];
+        rgba[i * 4 + 1] = g[i];
+        rgba[i * 4 + 2] = b[i];
+        rgba[i * 4 + 3] = a[i];
+    }
+}
+
+void PixelConverter::PremultiplyAlpha(unsigned char* rgba, size_t pixels)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+    const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(rgba + i * 4));
+        __m128i result[2];
+        for (int h = 0; h < 2; ++h) {
+            __m128i c = h == 0 ? _mm_unpacklo_epi8(v, zero) : _mm_unpackhi_epi8(v, zero);
+            __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, 0xFF), 0xFF);
+            __m128i x = _mm_add_epi16(_mm_mullo_epi16(c, a), half);
+            result[h] = _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+        }
+        __m128i packed = _mm_packus_epi16(result[0], result[1]);
+        packed = _mm_or_si128(_mm_andnot_si128(alphaMask, packed), _mm_and_si128(alphaMask, v));
+        _mm_storeu_si128((__m128i*)(rgba + i * 4), packed);
+    }
+    for (; i < pixels; ++i) {
+        unsigned char* p = rgba + i * 4;
+        p[0] = MultiplyAlpha(p[0], p[3]);
+        p[1] = MultiplyAlpha(p[1], p[3]);
+        p[2] = MultiplyAlpha(p[2], p[3]);
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "Image.h"
+
+// Conversions between the uncompressed 8-bit layouts (RGBA8, RG8, R8). The row kernels
+// work on tightly packed pixels and use SSE2, or SSSE3 shuffles where the CPU has them.
+class PixelConverter
+{
+public:
+	// Smallest format that holds an image decoded with this many channels. RGB has no
+	// 24-bit DXGI format, so it still needs RGBA8.
+	static PixelFormat ChooseFormat(int sourceChannels);
+
+	// R8 is grey and RG8 is grey+alpha, matching what stb_image reports for one and two
+	// channel files: converting up replicates grey into RGB, converting down keeps R (and A)
+	static ImageData Convert(const ImageData& image, PixelFormat format);
+
+	// Interleaves up to four single-channel masks into one RGBA8 image. Each source is
+	// R8 (other formats give up their first channel); a null source fills its channel
+	// with 0, or 255 for alpha.
+	static ImageData PackChannels(const ImageData* red, const ImageData* green, const ImageData* blue, const ImageData* alpha);
+
+	static void PremultiplyAlpha(ImageData& image);
+	// 8-bit table lookups on the colour channels, alpha is left alone
+	static void SrgbToLinear(ImageData& image);
+	static void LinearToSrgb(ImageData& image);
+
+	static void ExpandRGBToRGBA(const unsigned char* rgb, unsigned char* rgba, size_t pixels);
+	static void ExtractChannel(const unsigned char* rgba, unsigned char* dst, size_t pixels, int channel);
+	static void ExtractChannelPair(const unsigned char* rgba, unsigned char* dst, size_t pixels, int first, int second);
+	static void InterleaveRGBA(const unsigned char* r, const unsigned char* g, const unsigned char* b, const unsigned char* a, unsigned char* rgba, size_t pixels);
+	static void PremultiplyAlpha(unsigned char* rgba, size_t pixels);
+
+private:
+	static void ApplyColourTable(ImageData& image, const unsigned char table[256]);
+};
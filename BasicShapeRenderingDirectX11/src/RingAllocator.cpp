@@ -0,0 +1,116 @@
+#include "RingAllocator.h"
+
+#include <stdexcept>
+
+RingAllocator::RingAllocator(uint32_t size, uint32_t framesInFlight, uint32_t alignment)
+    : mSize(size), mAlignment(alignment > 0 ? alignment : 1), mFrames(framesInFlight > 0 ? framesInFlight : 1)
+{
+    if (mAlignment & (mAlignment - 1))
+        throw std::runtime_error("Ring alignment must be a power of two");
+    if (mSize == 0 || mSize % mAlignment != 0)
+        throw std::runtime_error("Ring size must be a non-zero multiple of its alignment");
+}
+
+void RingAllocator::BeginFrame(const std::function<bool(size_t frame, bool wait)>& signalled)
+{
+    // fences signal in submission order, so stop at the first frame still running
+    for (size_t i = 0; i < mFrames.size(); ++i) {
+        size_t index = (mFrameIndex + i) % mFrames.size();
+        Frame& frame = mFrames[index];
+        if (!frame.pending)
+            continue;
+        if (!signalled(index, false))
+            break;
+        Retire(frame);
+    }
+
+    // the oldest frame's slot is needed again, so the CPU has got framesInFlight ahead
+    Frame& current = mFrames[mFrameIndex];
+    if (current.pending) {
+        signalled(mFrameIndex, true);
+        Retire(current);
+    }
+}
+
+size_t RingAllocator::EndFrame()
+{
+    size_t index = mFrameIndex;
+    mFrames[index].bytes = mFrameBytes;
+    mFrames[index].pending = true;
+    mFrameBytes = 0;
+    mFrameIndex = (mFrameIndex + 1) % mFrames.size();
+    return index;
+}
+
+void RingAllocator::Reset()
+{
+    for (Frame& frame : mFrames)
+        frame = Frame();
+    mHead = 0;
+    mUsedBytes = 0;
+    mFrameBytes = 0;
+}
+
+RingAllocator::Allocation RingAllocator::Allocate(uint32_t size)
+{
+    if (size == 0 || size > mSize)
+        throw std::runtime_error("Allocation does not fit in the ring");
+    uint32_t alignedSize = (size + mAlignment - 1) & ~(mAlignment - 1);
+
+    Allocation allocation;
+    // an empty ring starts again from 0 rather than wasting its tail on a wrap
+    if (mUsedBytes == 0)
+        mHead = 0;
+    if (Reserve(alignedSize) > mSize - mUsedBytes) {
+        // only this frame's bytes come along to the renamed buffer
+        allocation.discard = true;
+        ++mDiscardCount;
+        for (Frame& frame : mFrames)
+            frame.bytes = 0;
+        mUsedBytes = mFrameBytes;
+        if (mUsedBytes == 0)
+            mHead = 0;
+        if (Reserve(alignedSize) > mSize - mUsedBytes) {
+            // this frame alone has filled the ring
+            ++mGeneration;
+            mHead = 0;
+            mUsedBytes = 0;
+            mFrameBytes = 0;
+        }
+    }
+
+    uint32_t reserved = Reserve(alignedSize);
+    allocation.offset = mHead + alignedSize > mSize ? 0 : mHead;
+    allocation.size = alignedSize;
+    allocation.generation = mGeneration;
+    mHead = allocation.offset + alignedSize;
+    mUsedBytes += reserved;
+    mFrameBytes += reserved;
+    return allocation;
+}
+
+void RingAllocator::Validate(uint32_t generation) const
+{
+    if (generation != mGeneration)
+        throw std::runtime_error("Ring allocation was overwritten before it was used");
+}
+
+uint32_t RingAllocator::GetFrameStart() const
+{
+    return (mHead + mSize - mFrameBytes % mSize) % mSize;
+}
+
+uint32_t RingAllocator::Reserve(uint32_t alignedSize) const
+{
+    // space left at the end is skipped rather than split
+    if (mHead + alignedSize > mSize)
+        return mSize - mHead + alignedSize;
+    return alignedSize;
+}
+
+void RingAllocator::Retire(Frame& frame)
+{
+    mUsedBytes -= frame.bytes;
+    frame.bytes = 0;
+    frame.pending = false;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Offset bookkeeping for a ring of per-frame data, independent of the buffer it describes.
+// Allocations run forwards from a head and each frame owns the bytes it took, space skipped
+// at a wrap included, until its fence is seen to signal. When the next allocation would
+// reach into bytes a frame still owns, the ring is full and the allocation asks for a
+// discard: the caller renames the buffer and copies the current frame's span into the new
+// copy, leaving the frames in flight with the old one. A single frame bigger than the ring
+// starts over from 0 instead, and bumps the generation so its earlier allocations fail
+// Validate.
+class RingAllocator
+{
+public:
+	struct Allocation {
+		uint32_t offset = 0;
+		uint32_t size = 0;			// rounded up to the alignment
+		uint32_t generation = 0;
+		bool discard = false;		// rename the buffer before writing this
+	};
+
+	RingAllocator(uint32_t size, uint32_t framesInFlight, uint32_t alignment);
+
+	// Retires finished frames, oldest first. signalled(frame, wait) reports whether the fence
+	// of the frame EndFrame returned as frame has signalled; with wait set it must block until
+	// it has. Waits only when all framesInFlight are still queued.
+	void BeginFrame(const std::function<bool(size_t frame, bool wait)>& signalled);
+	// Hands this frame's bytes to the frame slot it returns, whose fence the caller signals
+	size_t EndFrame();
+	// Forgets every frame, for callers that never keep data past the frame
+	void Reset();
+
+	Allocation Allocate(uint32_t size);
+	// Throws when an allocation of this generation was made before the ring last started over
+	void Validate(uint32_t generation) const;
+
+	// The current frame's allocations: bytes long, running forwards from start and possibly
+	// wrapping past the end. This is what a discard has to carry over.
+	uint32_t GetFrameStart() const;
+	uint32_t GetFrameBytes() const { return mFrameBytes; }
+
+	uint32_t GetSize() const { return mSize; }
+	uint32_t GetAlignment() const { return mAlignment; }
+	// Bytes still owned by frames the GPU may be reading, including this one
+	uint32_t GetUsedBytes() const { return mUsedBytes; }
+	uint32_t GetDiscardCount() const { return mDiscardCount; }
+	uint32_t GetGeneration() const { return mGeneration; }
+
+private:
+	struct Frame {
+		uint32_t bytes = 0;		// owned by the frame, wasted space at a wrap included
+		bool pending = false;
+	};
+
+	uint32_t Reserve(uint32_t alignedSize) const;
+	void Retire(Frame& frame);
+
+private:
+	uint32_t mSize;
+	uint32_t mAlignment;
+	uint32_t mHead = 0;
+	uint32_t mUsedBytes = 0;
+	uint32_t mFrameBytes = 0;
+	uint32_t mDiscardCount = 0;
+	uint32_t mGeneration = 0;
+
+	std::vector<Frame> mFrames;
+	size_t mFrameIndex = 0;
+};
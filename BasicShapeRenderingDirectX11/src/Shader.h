@@ -17,7 +17,6 @@ public:
 		//float padding[3];  // Padding to ensure the constant buffer is a multiple of 16 bytes
 	};
 	Shader(const char* vertexShaderSource, const char* pixelShaderSource, ID3D11Device* dev);
-	~Shader();
 	void Compile(const char* vertexShaderSource, const char* pixelShaderSource);
 
 	ID3D11VertexShader* GetVertexShader() const { return mVS; }
@@ -26,8 +25,6 @@ public:
 	ID3DBlob* GetVSBlob() const { return mVSBlob; }
 	ID3DBlob* GetPSBlob() const { return mPSBlob; }
 	ID3DBlob* GetErrorBlob() const { return mErrorBlob; }
-	ID3D11Buffer* GetPSConstantBuffer() const { return mPSConstantBuffer; }
-	ID3D11Buffer* GetVSConstantBuffer() const { return mVSConstantBuffer; }
 
 private:
 	ID3DBlob* mVSBlob = nullptr;
@@ -36,7 +33,4 @@ private:
 
 	ID3D11VertexShader* mVS;    // the vertex shader
 	ID3D11PixelShader* mPS;     // the pixel shader
-
-	ID3D11Buffer* mPSConstantBuffer;
-	ID3D11Buffer* mVSConstantBuffer;
 };
\ No newline at end of file
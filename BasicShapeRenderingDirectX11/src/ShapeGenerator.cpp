@@ -0,0 +1,462 @@
+#include "ShapeGenerator.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+namespace {
+
+const size_t kFloats = ShapeGenerator::kFloatsPerVertex;
+const float kPi = 3.14159265358979f;
+
+// vertex rows per ParallelFor task
+const int kBandRows = 8;
+
+//                      Position               UV            Normal                Tangent
+constexpr float kQuadVertices[] = {
+    -0.5f, -0.5f,  0.0f,    0.0f,  1.0f,    0.0f,  0.0f,  1.0f,    1.0f,  0.0f,  0.0f, -1.0f,
+    -0.5f,  0.5f,  0.0f,    0.0f,  0.0f,    0.0f,  0.0f,  1.0f,    1.0f,  0.0f,  0.0f, -1.0f,
+     0.5f,  0.5f,  0.0f,    1.0f,  0.0f,    0.0f,  0.0f,  1.0f,    1.0f,  0.0f,  0.0f, -1.0f,
+     0.5f, -0.5f,  0.0f,    1.0f,  1.0f,    0.0f,  0.0f,  1.0f,    1.0f,  0.0f,  0.0f, -1.0f,
+};
+
+constexpr unsigned int kQuadIndices[] = {
+    0, 1, 2,
+    2, 3, 0,
+};
+
+// Faces in +x, -x, +y, -y, +z, -z order, each from its top left corner seen from outside
+constexpr float kCubeVertices[] = {
+     0.5f,  0.5f,  0.5f,    0.0f,  0.0f,    1.0f,  0.0f,  0.0f,    0.0f,  0.0f, -1.0f, -1.0f,
+     0.5f,  0.5f, -0.5f,    1.0f,  0.0f,    1.0f,  0.0f,  0.0f,    0.0f,  0.0f, -1.0f, -1.0f,
+     0.5f, -0.5f, -0.5f,    1.0f,  1.0f,    1.0f,  0.0f,  0.0f,    0.0f,  0.0f, -1.0f, -1.0f,
+     0.5f, -0.5f,  0.5f,    0.0f,  1.0f,    1.0f,  0.0f,  0.0f,    0.0f,  0.0f, -1.0f, -1.0f,
+    -0.5f,  0.5f, -0.5f,    0.0f,  0.0f,   -1.0f,  0.0f,  0.0f,    0.0f,  0.0f,  1.0f, -1.0f,
+    -0.5f,  0.5f,  0.5f,    1.0f,  0.0f,   -1.0f,  0.0f,  0.0f,    0.0f,  0.0f,  1.0f, -1.0f,
+    -0.5f, -0.5f,  0.5f,    1.0f,  1.0f,   -1.0f,  0.0f,  0.0f,    0.0f,  0.0f,  1.0f, -1.0f,
+    -0.5f, -0.5f, -0.5f,    0.0f,  1.0f,   -1.0f,  0.0f,  0.0f,    0.0f,  0.0f,  1.0f, -1.0f,
+    -0.5f,  0.5f, -0.5f,    0.0f,  0.0f,    0.0f,  1.0f,  0.0f,    1.0f,  0.0f,  0.0f, -1.0f,
+     0.5f,  0.5f, -0.5f,    1.0f,  0.0f,    0.0f,  1.0f,  0.0f,    1.0f,  0.0f,  0.0f, -1.0f,
+     0.5f,  0.5f,  0.5f,    1.0f,  1.0f,    0.0f,  1.0f,  0.0f,    1.0f,  0.0f,  0.0f, -1.0f,
+    -0.5f,  0.5f,  0.5f,    0.0f,  1.0f,    0.0f,  1.0f,  0.0f,    1.0f,  0.0f,  0.0f, -1.0f,
+    -0.5f, -0.5f,  0.5f,    0.0f,  0.0f,    0.0f, -1.0f,  0.0f,    1.0f,  0.0f,  0.0f, -1.0f,
+     0.5f, -0.5f,  0.5f,    1.0f,  0.0f,    0.0f, -1.0f,  0.0f,    1.0f,  0.0f,  0.0f, -1.0f,
+     0.5f, -0.5f, -0.5f,    1.0f,  1.0f,    0.0f, -1.0f,  0.0f,    1.0f,  0.0f,  0.0f, -1.0f,
+    -0.5f, -0.5f, -0.5f,    0.0f,  1.0f,    0.0f, -1.0f,  0.0f,    1.0f,  0.0f,  0.0f, -1.0f,
+    -0.5f,  0.5f,  0.5f,    0.0f,  0.0f,    0.0f,  0.0f,  1.0f,    1.0f,  0.0f,  0.0f, -1.0f,
+     0.5f,  0.5f,  0.5f,    1.0f,  0.0f,    0.0f,  0.0f,  1.0f,    1.0f,  0.0f,  0.0f, -1.0f,
+     0.5f, -0.5f,  0.5f,    1.0f,  1.0f,    0.0f,  0.0f,  1.0f,    1.0f,  0.0f,  0.0f, -1.0f,
+    -0.5f, -0.5f,  0.5f,    0.0f,  1.0f,    0.0f,  0.0f,  1.0f,    1.0f,  0.0f,  0.0f, -1.0f,
+     0.5f,  0.5f, -0.5f,    0.0f,  0.0f,    0.0f,  0.0f, -1.0f,   -1.0f,  0.0f,  0.0f, -1.0f,
+    -0.5f,  0.5f, -0.5f,    1.0f,  0.0f,    0.0f,  0.0f, -1.0f,   -1.0f,  0.0f,  0.0f, -1.0f,
+    -0.5f, -0.5f, -0.5f,    1.0f,  1.0f,    0.0f,  0.0f, -1.0f,   -1.0f,  0.0f,  0.0f, -1.0f,
+     0.5f, -0.5f, -0.5f,    0.0f,  1.0f,    0.0f,  0.0f, -1.0f,   -1.0f,  0.0f,  0.0f, -1.0f,
+};
+
+constexpr unsigned int kCubeIndices[] = {
+     0,  1,  3,     3,  1,  2,
+     4,  5,  7,     7,  5,  6,
+     8,  9, 11,    11,  9, 10,
+    12, 13, 15,    15, 13, 14,
+    16, 17, 19,    19, 17, 18,
+    20, 21, 23,    23, 21, 22,
+};
+
+// Outward normal, then the directions U and V run in seen from outside, for Box
+constexpr float kBoxFaces[6][3][3] = {
+    { {  1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, -1.0f,  0.0f } },
+    { { -1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f,  1.0f }, { 0.0f, -1.0f,  0.0f } },
+    { { 0.0f,  1.0f, 0.0f }, { 1.0f, 0.0f,  0.0f }, { 0.0f,  0.0f,  1.0f } },
+    { { 0.0f, -1.0f, 0.0f }, { 1.0f, 0.0f,  0.0f }, { 0.0f,  0.0f, -1.0f } },
+    { { 0.0f, 0.0f,  1.0f }, {  1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f,  0.0f } },
+    { { 0.0f, 0.0f, -1.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f,  0.0f } },
+};
+
+template <size_t VertexFloats, size_t IndexCount>
+MeshData FromTable(const float (&vertices)[VertexFloats], const unsigned int (&indices)[IndexCount])
+{
+    static_assert(VertexFloats % ShapeGenerator::kFloatsPerVertex == 0, "Table holds a partial vertex");
+    MeshData mesh;
+    mesh.vertices.assign(vertices, vertices + VertexFloats);
+    mesh.indices.assign(indices, indices + IndexCount);
+    return mesh;
+}
+
+// Writes four vertices from their twelve components, one vertex per lane. Position + U,
+// V + normal and tangent each fill a quarter of a transpose.
+inline void StoreVertices(float* dst, __m128* c)
+{
+    for (int group = 0; group < 3; ++group) {
+        __m128* g = c + group * 4;
+        _MM_TRANSPOSE4_PS(g[0], g[1], g[2], g[3]);
+        for (int lane = 0; lane < 4; ++lane)
+            _mm_storeu_ps(dst + lane * kFloats + group * 4, g[lane]);
+    }
+}
+
+// Fills count vertices from kernel(column, components), which computes four columns at once
+template <typename Kernel>
+void WriteRow(float* dst, int count, const Kernel& kernel)
+{
+    __m128 c[kFloats];
+    int column = 0;
+    for (; column + 4 <= count; column += 4) {
+        kernel(column, c);
+        StoreVertices(dst + column * kFloats, c);
+    }
+    if (column < count) {
+        float tail[4 * kFloats];
+        kernel(column, c);
+        StoreVertices(tail, c);
+        std::memcpy(dst + column * kFloats, tail, (count - column) * kFloats * sizeof(float));
+    }
+}
+
+// A (rows + 1) x (columns + 1) grid of vertices with two triangles per cell. All of a
+// collapsed row's vertices sit on one point, such as a pole, so the triangle with an edge
+// along it has no area and is left out.
+struct Grid {
+    int rows = 1;
+    int columns = 1;
+    std::vector<char> collapsed;
+    bool flip = false;		// the cross product of the U and V edges points out
+};
+
+// Appends the grid to mesh; writeRow(row, dst) fills one row of vertices
+template <typename RowWriter>
+void AddGrid(MeshData& mesh, const Grid& grid, ThreadPool& pool, const RowWriter& writeRow)
+{
+    size_t rowVertices = grid.columns + 1;
+    size_t firstVertex = mesh.vertices.size() / kFloats;
+    size_t firstIndex = mesh.indices.size();
+    std::vector<size_t> rowStart(grid.rows + 1, 0);
+    for (int r = 0; r < grid.rows; ++r) {
+        size_t triangles = (grid.collapsed[r] ? 0 : 1) + (grid.collapsed[r + 1] ? 0 : 1);
+        rowStart[r + 1] = rowStart[r] + triangles * 3 * grid.columns;
+    }
+    mesh.vertices.resize((firstVertex + (grid.rows + 1) * rowVertices) * kFloats);
+    mesh.indices.resize(firstIndex + rowStart[grid.rows]);
+
+    // cell (r, s) has corners a and a + 1 on row r, b and b + 1 below them
+    int b1 = grid.flip ? 2 : 1;
+    int b2 = grid.flip ? 1 : 2;
+    size_t bands = (grid.rows + kBandRows) / kBandRows;
+    pool.ParallelFor(bands, [&](size_t band) {
+        int r0 = static_cast<int>(band) * kBandRows;
+        int r1 = std::min(r0 + kBandRows, grid.rows + 1);
+        for (int r = r0; r < r1; ++r) {
+            writeRow(r, &mesh.vertices[(firstVertex + r * rowVertices) * kFloats]);
+            if (r == grid.rows)
+                continue;
+            unsigned int* dst = &mesh.indices[firstIndex + rowStart[r]];
+            unsigned int a = static_cast<unsigned int>(firstVertex + r * rowVertices);
+            unsigned int b = static_cast<unsigned int>(a + rowVertices);
+            for (int s = 0; s < grid.columns; ++s, ++a, ++b) {
+                if (!grid.collapsed[r]) {
+                    dst[0] = a;
+                    dst[b1] = a + 1;
+                    dst[b2] = b;
+                    dst += 3;
+                }
+                if (!grid.collapsed[r + 1]) {
+                    dst[0] = b;
+                    dst[b1] = a + 1;
+                    dst[b2] = b + 1;
+                    dst += 3;
+                }
+            }
+        }
+    });
+}
+
+// Cosine and sine of the angle around y for each column, padded for four-wide loads. U = 0
+// is at the back (-z) and U = 0.5 faces +z; the last column repeats the first exactly.
+struct Columns {
+    std::vector<float> cosine, sine, u;
+
+    explicit Columns(int slices)
+        : cosine(slices + 4), sine(slices + 4), u(slices + 4)
+    {
+        for (int s = 0; s < slices; ++s) {
+            u[s] = static_cast<float>(s) / slices;
+            float angle = kPi * 0.5f + 2.0f * kPi * u[s];
+            cosine[s] = std::cos(angle);
+            sine[s] = std::sin(angle);
+        }
+        cosine[slices] = cosine[0];
+        sine[slices] = sine[0];
+        u[slices] = 1.0f;
+    }
+};
+
+// A curve in the plane through y, swept around it. Position (radius cos a, y, -radius sin a)
+// and its normal likewise from the radial and y parts.
+struct ProfileRow {
+    float radius;
+    float y;
+    float normalRadial;
+    float normalY;
+    float v;
+};
+
+// Sweeps profile around y. Rows run top to bottom for the U and V edges of a cell to wind
+// clockwise seen from outside; the other way round flips the triangles and the tangent sign.
+// A nonzero planarRadius maps UVs straight down onto the xz plane instead, for flat caps.
+void AddRevolution(MeshData& mesh, const std::vector<ProfileRow>& profile, const Columns& columns, int slices,
+    float planarRadius, ThreadPool& pool)
+{
+    Grid grid;
+    grid.rows = static_cast<int>(profile.size()) - 1;
+    grid.columns = slices;
+    grid.collapsed.resize(profile.size());
+    // triple product of the normal with the U and V directions, at the U = 0.25 column
+    float orientation = 0.0f;
+    for (int r = 0; r <= grid.rows; ++r) {
+        grid.collapsed[r] = profile[r].radius == 0.0f;
+        if (r < grid.rows) {
+            float dr = profile[r + 1].radius - profile[r].radius;
+            float dy = profile[r + 1].y - profile[r].y;
+            orientation += profile[r].normalRadial * dy - profile[r].normalY * dr;
+        }
+    }
+    grid.flip = orientation > 0.0f;
+
+    AddGrid(mesh, grid, pool, [&](int r, float* dst) {
+        const ProfileRow& row = profile[r];
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 radius = _mm_set1_ps(row.radius);
+        const __m128 normalRadial = _mm_set1_ps(row.normalRadial);
+        const __m128 y = _mm_set1_ps(row.y);
+        const __m128 v = _mm_set1_ps(row.v);
+        const __m128 normalY = _mm_set1_ps(row.normalY);
+        const __m128 sign = _mm_set1_ps(grid.flip ? 1.0f : -1.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        // planar UVs: U along +x and V along ny * z, so the bitangent points the same way
+        // relative to the normal as on the sides
+        const __m128 planarScale = _mm_set1_ps(planarRadius > 0.0f ? 0.5f / planarRadius : 0.0f);
+        const __m128 planarScaleV = _mm_set1_ps(planarRadius > 0.0f ? 0.5f * row.normalY / planarRadius : 0.0f);
+        WriteRow(dst, slices + 1, [&](int s, __m128* c) {
+            __m128 cosine = _mm_loadu_ps(&columns.cosine[s]);
+            __m128 sine = _mm_loadu_ps(&columns.sine[s]);
+            // adding zero turns the -0 of a pole into +0, so positions weld by their bits
+            c[0] = _mm_add_ps(_mm_mul_ps(radius, cosine), zero);
+            c[1] = y;
+            c[2] = _mm_sub_ps(zero, _mm_mul_ps(radius, sine));
+            c[5] = _mm_add_ps(_mm_mul_ps(normalRadial, cosine), zero);
+            c[6] = normalY;
+            c[7] = _mm_sub_ps(zero, _mm_mul_ps(normalRadial, sine));
+            c[10] = zero;
+            if (planarRadius > 0.0f) {
+                c[3] = _mm_add_ps(half, _mm_mul_ps(c[0], planarScale));
+                c[4] = _mm_add_ps(half, _mm_mul_ps(c[2], planarScaleV));
+                c[8] = _mm_set1_ps(1.0f);
+                c[9] = zero;
+                c[11] = _mm_set1_ps(-1.0f);
+            }
+            else {
+                // d/du of the position, along increasing angle
+                c[3] = _mm_loadu_ps(&columns.u[s]);
+                c[4] = v;
+                c[8] = _mm_sub_ps(zero, sine);
+                c[9] = zero;
+                c[11] = sign;
+                c[10] = _mm_sub_ps(zero, cosine);
+            }
+        });
+    });
+}
+
+// One face of a box, centred on normal * half and spanning half along u and v, which all lie
+// along axes. The grid is placed at (2i - segments) / segments of the half size so positions
+// on an edge come out bit for bit the same from both faces that share it.
+void AddBoxFace(MeshData& mesh, const float* normal, const float* u, const float* v, const float* half, int segments,
+    ThreadPool& pool)
+{
+    Grid grid;
+    grid.rows = segments;
+    grid.columns = segments;
+    grid.collapsed.assign(segments + 1, 0);
+    float nu[3] = {
+        normal[1] * u[2] - normal[2] * u[1],
+        normal[2] * u[0] - normal[0] * u[2],
+        normal[0] * u[1] - normal[1] * u[0]
+    };
+    grid.flip = nu[0] * v[0] + nu[1] * v[1] + nu[2] * v[2] > 0.0f;
+
+    std::vector<float> offsets(segments + 4), texcoords(segments + 4);
+    for (int s = 0; s <= segments; ++s) {
+        offsets[s] = static_cast<float>(2 * s - segments) / segments;
+        texcoords[s] = static_cast<float>(s) / segments;
+    }
+
+    AddGrid(mesh, grid, pool, [&](int r, float* dst) {
+        __m128 constants[kFloats];
+        __m128 uHalf[3];
+        for (int k = 0; k < 3; ++k) {
+            constants[k] = _mm_set1_ps(normal[k] * half[k] + v[k] * half[k] * offsets[r]);
+            constants[5 + k] = _mm_set1_ps(normal[k]);
+            constants[8 + k] = _mm_set1_ps(u[k]);
+            uHalf[k] = _mm_set1_ps(u[k] * half[k]);
+        }
+        constants[4] = _mm_set1_ps(texcoords[r]);
+        constants[11] = _mm_set1_ps(grid.flip ? 1.0f : -1.0f);
+        const __m128 zero = _mm_setzero_ps();
+        WriteRow(dst, segments + 1, [&](int s, __m128* c) {
+            __m128 offset = _mm_loadu_ps(&offsets[s]);
+            // adding zero turns a -0 into +0, so positions weld by their bits
+            for (int k = 0; k < 3; ++k)
+                c[k] = _mm_add_ps(_mm_add_ps(constants[k], _mm_mul_ps(uHalf[k], offset)), zero);
+            c[3] = _mm_loadu_ps(&texcoords[s]);
+            for (int k = 4; k < static_cast<int>(kFloats); ++k)
+                c[k] = constants[k];
+        });
+    });
+}
+
+// Hemisphere rows from angle start to end away from +y, placed at height y
+void AddSphereRows(std::vector<ProfileRow>& profile, float radius, float y, float start, float end, int stacks,
+    float arcStart, float arcLength, bool skipFirst)
+{
+    for (int i = skipFirst ? 1 : 0; i <= stacks; ++i) {
+        float angle = i == stacks ? end : start + (end - start) * i / stacks;
+        float sine = std::sin(angle);
+        float cosine = std::cos(angle);
+        // exact poles and equators, so the pole rows collapse and the joints match
+        if (angle == 0.0f || angle == kPi) {
+            sine = 0.0f;
+            cosine = angle == 0.0f ? 1.0f : -1.0f;
+        }
+        else if (angle == kPi * 0.5f) {
+            sine = 1.0f;
+            cosine = 0.0f;
+        }
+        float arc = arcStart + radius * std::fabs(angle - start);
+        profile.push_back({ radius * sine, y + radius * cosine, sine, cosine, arcLength > 0.0f ? arc / arcLength : 0.0f });
+    }
+}
+
+} // namespace
+
+const size_t ShapeGenerator::kFloatsPerVertex;
+
+MeshData ShapeGenerator::Quad()
+{
+    return FromTable(kQuadVertices, kQuadIndices);
+}
+
+MeshData ShapeGenerator::Cube()
+{
+    return FromTable(kCubeVertices, kCubeIndices);
+}
+
+MeshData ShapeGenerator::Box(float width, float height, float depth, int segments, ThreadPool& pool)
+{
+    segments = std::max(1, segments);
+    float half[3] = { width * 0.5f, height * 0.5f, depth * 0.5f };
+    MeshData mesh;
+    size_t faceVertices = (segments + 1) * (segments + 1);
+    mesh.vertices.reserve(6 * faceVertices * kFloats);
+    mesh.indices.reserve(6 * segments * segments * 6);
+    for (const auto& face : kBoxFaces)
+        AddBoxFace(mesh, face[0], face[1], face[2], half, segments, pool);
+    return mesh;
+}
+
+MeshData ShapeGenerator::Box(float width, float height, float depth, int segments)
+{
+    return Box(width, height, depth, segments, ThreadPool::Default());
+}
+
+MeshData ShapeGenerator::Sphere(float radius, int slices, int stacks, ThreadPool& pool)
+{
+    slices = std::max(3, slices);
+    stacks = std::max(2, stacks);
+    std::vector<ProfileRow> profile;
+    AddSphereRows(profile, radius, 0.0f, 0.0f, kPi, stacks, 0.0f, kPi * radius, false);
+    MeshData mesh;
+    AddRevolution(mesh, profile, Columns(slices), slices, 0.0f, pool);
+    return mesh;
+}
+
+MeshData ShapeGenerator::Sphere(float radius, int slices, int stacks)
+{
+    return Sphere(radius, slices, stacks, ThreadPool::Default());
+}
+
+MeshData ShapeGenerator::Cylinder(float radius, float height, int slices, int stacks, ThreadPool& pool)
+{
+    slices = std::max(3, slices);
+    stacks = std::max(1, stacks);
+    float top = height * 0.5f;
+    std::vector<ProfileRow> side;
+    for (int i = 0; i <= stacks; ++i) {
+        float t = static_cast<float>(i) / stacks;
+        side.push_back({ radius, top - height * t, 1.0f, 0.0f, t });
+    }
+    // the caps run centre to rim on top and rim to centre underneath, top to bottom
+    // seen from outside like the side
+    std::vector<ProfileRow> topCap = { { 0.0f, top, 0.0f, 1.0f, 0.0f }, { radius, top, 0.0f, 1.0f, 1.0f } };
+    std::vector<ProfileRow> bottomCap = { { radius, -top, 0.0f, -1.0f, 0.0f }, { 0.0f, -top, 0.0f, -1.0f, 1.0f } };
+
+    Columns columns(slices);
+    MeshData mesh;
+    mesh.vertices.reserve((stacks + 5) * (slices + 1) * kFloats);
+    mesh.indices.reserve((stacks + 1) * slices * 6);
+    AddRevolution(mesh, side, columns, slices, 0.0f, pool);
+    AddRevolution(mesh, topCap, columns, slices, radius, pool);
+    AddRevolution(mesh, bottomCap, columns, slices, radius, pool);
+    return mesh;
+}
+
+MeshData ShapeGenerator::Cylinder(float radius, float height, int slices, int stacks)
+{
+    return Cylinder(radius, height, slices, stacks, ThreadPool::Default());
+}
+
+MeshData ShapeGenerator::Torus(float majorRadius, float minorRadius, int slices, int sides, ThreadPool& pool)
+{
+    slices = std::max(3, slices);
+    sides = std::max(3, sides);
+    // from the outer equator downwards, round the inside and back over the top
+    std::vector<ProfileRow> profile;
+    for (int i = 0; i <= sides; ++i) {
+        float t = static_cast<float>(i) / sides;
+        float angle = 2.0f * kPi * t;
+        float cosine = i == sides ? 1.0f : std::cos(angle);
+        float sine = i == sides ? 0.0f : std::sin(angle);
+        profile.push_back({ majorRadius + minorRadius * cosine, -minorRadius * sine, cosine, -sine, t });
+    }
+    MeshData mesh;
+    AddRevolution(mesh, profile, Columns(slices), slices, 0.0f, pool);
+    return mesh;
+}
+
+MeshData ShapeGenerator::Torus(float majorRadius, float minorRadius, int slices, int sides)
+{
+    return Torus(majorRadius, minorRadius, slices, sides, ThreadPool::Default());
+}
+
+MeshData ShapeGenerator::Capsule(float radius, float height, int slices, int stacks, ThreadPool& pool)
+{
+    slices = std::max(3, slices);
+    stacks = std::max(1, stacks);
+    height = std::max(0.0f, height);
+    float top = height * 0.5f;
+    float quarter = kPi * 0.5f * radius;
+    float length = 2.0f * quarter + height;
+    // V follows the arc length, so the texture keeps its aspect from the cap down the body
+    std::vector<ProfileRow> profile;
+    AddSphereRows(profile, radius, top, 0.0f, kPi * 0.5f, stacks, 0.0f, length, false);
+    AddSphereRows(profile, radius, -top, kPi * 0.5f, kPi, stacks, quarter + height, length, height == 0.0f);
+    MeshData mesh;
+    AddRevolution(mesh, profile, Columns(slices), slices, 0.0f, pool);
+    return mesh;
+}
+
+MeshData ShapeGenerator::Capsule(float radius, float height, int slices, int stacks)
+{
+    return Capsule(radius, height, slices, stacks, ThreadPool::Default());
+}
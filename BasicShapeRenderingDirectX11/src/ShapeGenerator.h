@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+class ThreadPool;
+
+// Indexed triangle list with shared vertices. Each vertex is kFloatsPerVertex interleaved
+// floats: position, UV, normal and a tangent whose w is the sign of the bitangent, matching
+// the input layout InitGraphics creates. Front faces are wound clockwise seen from outside,
+// which is D3D's default rasterizer state.
+struct MeshData {
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+};
+
+// Parametric primitives at any tessellation, centred on the origin with y up. Bands of rows
+// are spread across a ThreadPool and each row is written four vertices at a time with SSE2;
+// sines and cosines are only taken once per row and once per column. Round shapes wrap
+// their U coordinate once around y, starting and ending at the back (-z), and repeat the
+// seam column so the texture does not wrap backwards across it.
+class ShapeGenerator
+{
+public:
+	static const size_t kFloatsPerVertex = 12;
+
+	// Fixed shapes, copied from constexpr tables
+	static MeshData Quad();		// unit square in the xy plane, facing +z
+	static MeshData Cube();		// unit cube, 4 vertices per face
+
+	// Each face split into segments x segments quads
+	static MeshData Box(float width, float height, float depth, int segments, ThreadPool& pool);
+	static MeshData Box(float width, float height, float depth, int segments);
+	static MeshData Sphere(float radius, int slices, int stacks, ThreadPool& pool);
+	static MeshData Sphere(float radius, int slices, int stacks);
+	// Open tube plus a flat cap at each end with planar UVs
+	static MeshData Cylinder(float radius, float height, int slices, int stacks, ThreadPool& pool);
+	static MeshData Cylinder(float radius, float height, int slices, int stacks);
+	// Ring around y: sides is the tessellation around the tube
+	static MeshData Torus(float majorRadius, float minorRadius, int slices, int sides, ThreadPool& pool);
+	static MeshData Torus(float majorRadius, float minorRadius, int slices, int sides);
+	// Cylinder of the given height between two hemispheres of stacks rows each, as one
+	// smooth surface; the total height is height + 2 * radius
+	static MeshData Capsule(float radius, float height, int slices, int stacks, ThreadPool& pool);
+	static MeshData Capsule(float radius, float height, int slices, int stacks);
+};
@@ -0,0 +1,62 @@
+#include "Simd.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+static void QueryCpuid(int leaf, int subleaf, int regs[4])
+{
+#if defined(_MSC_VER)
+    __cpuidex(regs, leaf, subleaf);
+#else
+    unsigned int a, b, c, d;
+    __cpuid_count(leaf, subleaf, a, b, c, d);
+    regs[0] = (int)a; regs[1] = (int)b; regs[2] = (int)c; regs[3] = (int)d;
+#endif
+}
+
+static unsigned long long ReadXCR0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+
+const CpuFeatures& CpuFeatures::Get()
+{
+    static const CpuFeatures features;
+    return features;
+}
+
+CpuFeatures::CpuFeatures()
+{
+    int regs[4];
+    QueryCpuid(0, 0, regs);
+    int maxLeaf = regs[0];
+
+    QueryCpuid(1, 0, regs);
+    mSSSE3 = (regs[2] & (1 << 9)) != 0;
+    mSSE41 = (regs[2] & (1 << 19)) != 0;
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx = (regs[2] & (1 << 28)) != 0;
+    bool fma = (regs[2] & (1 << 12)) != 0;
+    bool f16c = (regs[2] & (1 << 29)) != 0;
+
+    // AVX state is only usable when the OS saves the YMM registers on context switch
+    bool ymmEnabled = osxsave && (ReadXCR0() & 0x6) == 0x6;
+    mAVX = avx && ymmEnabled;
+    mFMA = fma && mAVX;
+    mF16C = f16c && mAVX;
+
+    if (maxLeaf >= 7) {
+        QueryCpuid(7, 0, regs);
+        mAVX2 = mAVX && (regs[1] & (1 << 5)) != 0;
+        mBMI2 = (regs[1] & (1 << 8)) != 0;
+    }
+}
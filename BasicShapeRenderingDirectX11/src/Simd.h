@@ -0,0 +1,39 @@
+#pragma once
+
+// MSVC lets any function use AVX intrinsics, GCC/Clang need them enabled per function.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SIMD_TARGET_SSSE3
+#define SIMD_TARGET_AVX2
+#define SIMD_TARGET_F16C
+#define SIMD_TARGET_BMI2
+#else
+#define SIMD_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define SIMD_TARGET_F16C __attribute__((target("avx,f16c")))
+#define SIMD_TARGET_BMI2 __attribute__((target("bmi2")))
+#endif
+
+class CpuFeatures
+{
+public:
+	static const CpuFeatures& Get();
+
+	bool HasSSSE3() const { return mSSSE3; }
+	bool HasSSE41() const { return mSSE41; }
+	bool HasAVX() const { return mAVX; }
+	bool HasAVX2() const { return mAVX2; }
+	bool HasF16C() const { return mF16C; }
+	bool HasFMA() const { return mFMA; }
+	bool HasBMI2() const { return mBMI2; }
+
+private:
+	CpuFeatures();
+
+	bool mSSSE3 = false;
+	bool mSSE41 = false;
+	bool mAVX = false;
+	bool mAVX2 = false;
+	bool mF16C = false;
+	bool mFMA = false;
+	bool mBMI2 = false;
+};
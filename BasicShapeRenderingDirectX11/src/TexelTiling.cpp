@@ -0,0 +1,340 @@
+#include "TexelTiling.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+#include <immintrin.h>
+#include <stdexcept>
+
+const int TexelTiling::kTileSize;
+
+namespace {
+
+const int kTileTexels = TexelTiling::kTileSize * TexelTiling::kTileSize;
+
+// A tile is walked as sixteen 4x2 blocks. Rows y and y+1 of a 4-wide block are two Z-order
+// quads, stored one after the other, so every block is a run of 8 texels in the tile.
+inline int BlockStart(int pair, int half)
+{
+    return 16 * half + 8 * (pair & 1) + 32 * (pair >> 1);
+}
+
+using TileFunction = void (*)(const unsigned char* src, size_t pitch, unsigned char* tile, int bpp);
+using UntileFunction = void (*)(const unsigned char* tile, unsigned char* dst, size_t pitch, int bpp);
+
+void TileGeneric(const unsigned char* src, size_t pitch, unsigned char* tile, int bpp)
+{
+    size_t pairBytes = static_cast<size_t>(bpp) * 2;
+    for (int pair = 0; pair < 4; ++pair) {
+        for (int half = 0; half < 2; ++half) {
+            const unsigned char* row0 = src + 2 * pair * pitch + 4 * half * bpp;
+            const unsigned char* row1 = row0 + pitch;
+            unsigned char* block = tile + static_cast<size_t>(BlockStart(pair, half)) * bpp;
+            std::memcpy(block, row0, pairBytes);
+            std::memcpy(block + pairBytes, row1, pairBytes);
+            std::memcpy(block + 2 * pairBytes, row0 + pairBytes, pairBytes);
+            std::memcpy(block + 3 * pairBytes, row1 + pairBytes, pairBytes);
+        }
+    }
+}
+
+void UntileGeneric(const unsigned char* tile, unsigned char* dst, size_t pitch, int bpp)
+{
+    size_t pairBytes = static_cast<size_t>(bpp) * 2;
+    for (int pair = 0; pair < 4; ++pair) {
+        for (int half = 0; half < 2; ++half) {
+            unsigned char* row0 = dst + 2 * pair * pitch + 4 * half * bpp;
+            unsigned char* row1 = row0 + pitch;
+            const unsigned char* block = tile + static_cast<size_t>(BlockStart(pair, half)) * bpp;
+            std::memcpy(row0, block, pairBytes);
+            std::memcpy(row1, block + pairBytes, pairBytes);
+            std::memcpy(row0 + pairBytes, block + 2 * pairBytes, pairBytes);
+            std::memcpy(row1 + pairBytes, block + 3 * pairBytes, pairBytes);
+        }
+    }
+}
+
+// 4-byte texels: two 64-bit unpacks turn four texels from each of two rows into two quads
+void Tile32_SSE2(const unsigned char* src, size_t pitch, unsigned char* tile, int)
+{
+    for (int pair = 0; pair < 4; ++pair) {
+        for (int half = 0; half < 2; ++half) {
+            const unsigned char* row0 = src + 2 * pair * pitch + 16 * half;
+            __m128i a = _mm_loadu_si128((const __m128i*)row0);
+            __m128i b = _mm_loadu_si128((const __m128i*)(row0 + pitch));
+            unsigned char* block = tile + BlockStart(pair, half) * 4;
+            _mm_storeu_si128((__m128i*)block, _mm_unpacklo_epi64(a, b));
+            _mm_storeu_si128((__m128i*)(block + 16), _mm_unpackhi_epi64(a, b));
+        }
+    }
+}
+
+void Untile32_SSE2(const unsigned char* tile, unsigned char* dst, size_t pitch, int)
+{
+    for (int pair = 0; pair < 4; ++pair) {
+        for (int half = 0; half < 2; ++half) {
+            const unsigned char* block = tile + BlockStart(pair, half) * 4;
+            __m128i lo = _mm_loadu_si128((const __m128i*)block);
+            __m128i hi = _mm_loadu_si128((const __m128i*)(block + 16));
+            unsigned char* row0 = dst + 2 * pair * pitch + 16 * half;
+            _mm_storeu_si128((__m128i*)row0, _mm_unpacklo_epi64(lo, hi));
+            _mm_storeu_si128((__m128i*)(row0 + pitch), _mm_unpackhi_epi64(lo, hi));
+        }
+    }
+}
+
+// Whole 8-texel rows: the in-lane unpacks give both halves at once, a lane swap puts
+// each half's quads together
+SIMD_TARGET_AVX2 void Tile32_AVX2(const unsigned char* src, size_t pitch, unsigned char* tile, int)
+{
+    for (int pair = 0; pair < 4; ++pair) {
+        const unsigned char* row0 = src + 2 * pair * pitch;
+        __m256i a = _mm256_loadu_si256((const __m256i*)row0);
+        __m256i b = _mm256_loadu_si256((const __m256i*)(row0 + pitch));
+        __m256i lo = _mm256_unpacklo_epi64(a, b);
+        __m256i hi = _mm256_unpackhi_epi64(a, b);
+        _mm256_storeu_si256((__m256i*)(tile + BlockStart(pair, 0) * 4), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(tile + BlockStart(pair, 1) * 4), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+}
+
+SIMD_TARGET_AVX2 void Untile32_AVX2(const unsigned char* tile, unsigned char* dst, size_t pitch, int)
+{
+    for (int pair = 0; pair < 4; ++pair) {
+        __m256i left = _mm256_loadu_si256((const __m256i*)(tile + BlockStart(pair, 0) * 4));
+        __m256i right = _mm256_loadu_si256((const __m256i*)(tile + BlockStart(pair, 1) * 4));
+        __m256i lo = _mm256_permute2x128_si256(left, right, 0x20);
+        __m256i hi = _mm256_permute2x128_si256(left, right, 0x31);
+        unsigned char* row0 = dst + 2 * pair * pitch;
+        _mm256_storeu_si256((__m256i*)row0, _mm256_unpacklo_epi64(lo, hi));
+        _mm256_storeu_si256((__m256i*)(row0 + pitch), _mm256_unpackhi_epi64(lo, hi));
+    }
+}
+
+void CheckTileable(const ImageData& image)
+{
+    if (IsBlockCompressed(image.format))
+        throw std::runtime_error("Block-compressed images are already stored in 4x4 blocks");
+}
+
+struct LinearAddress
+{
+    size_t pitch;
+
+    size_t Column(int x) const { return static_cast<size_t>(x) * 4; }
+    size_t Row(int y) const { return y * pitch; }
+};
+
+// Morton order interleaves x and y bits, so a texel's offset is still a column part plus a row part
+struct TiledAddress
+{
+    size_t tileRowBytes;
+    int columnBits[TexelTiling::kTileSize];
+    int rowBits[TexelTiling::kTileSize];
+
+    explicit TiledAddress(size_t tilesWide)
+        : tileRowBytes(tilesWide * kTileTexels * 4)
+    {
+        for (int i = 0; i < TexelTiling::kTileSize; ++i) {
+            columnBits[i] = TexelTiling::GetMortonIndex(i, 0) * 4;
+            rowBits[i] = TexelTiling::GetMortonIndex(0, i) * 4;
+        }
+    }
+
+    size_t Column(int x) const { return static_cast<size_t>(x >> 3) * (kTileTexels * 4) + columnBits[x & 7]; }
+    size_t Row(int y) const { return (y >> 3) * tileRowBytes + rowBits[y & 7]; }
+};
+
+inline __m128 LoadTexel(const unsigned char* p)
+{
+    int bits;
+    std::memcpy(&bits, p, 4);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), zero), zero);
+    return _mm_cvtepi32_ps(v);
+}
+
+// Texel coordinates and weights for four samples. Clamping the position to [-1, size]
+// first changes no result (both taps land on the same edge texel) but keeps it positive
+// after +1, so truncation is a floor.
+inline void ComputeTaps(__m128 u, __m128 v, __m128 size, __m128 maxCoord, int x0[4], int x1[4], int y0[4], int y1[4], float wx[4], float wy[4])
+{
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 sizeX = _mm_shuffle_ps(size, size, _MM_SHUFFLE(0, 0, 0, 0));
+    __m128 sizeY = _mm_shuffle_ps(size, size, _MM_SHUFFLE(1, 1, 1, 1));
+    __m128 maxX = _mm_shuffle_ps(maxCoord, maxCoord, _MM_SHUFFLE(0, 0, 0, 0));
+    __m128 maxY = _mm_shuffle_ps(maxCoord, maxCoord, _MM_SHUFFLE(1, 1, 1, 1));
+
+    __m128 fx = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_mul_ps(u, sizeX), half), _mm_set1_ps(-1.0f)), sizeX);
+    __m128 fy = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_mul_ps(v, sizeY), half), _mm_set1_ps(-1.0f)), sizeY);
+    __m128 floorX = _mm_sub_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_add_ps(fx, one))), one);
+    __m128 floorY = _mm_sub_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_add_ps(fy, one))), one);
+    _mm_storeu_ps(wx, _mm_sub_ps(fx, floorX));
+    _mm_storeu_ps(wy, _mm_sub_ps(fy, floorY));
+
+    _mm_storeu_si128((__m128i*)x0, _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(floorX, zero), maxX)));
+    _mm_storeu_si128((__m128i*)x1, _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(floorX, one), zero), maxX)));
+    _mm_storeu_si128((__m128i*)y0, _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(floorY, zero), maxY)));
+    _mm_storeu_si128((__m128i*)y1, _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(floorY, one), zero), maxY)));
+}
+
+template <class Address>
+void SampleBilinearRGBA8(const ImageData& image, const Address& address, const float* uv, size_t count, float* rgba)
+{
+    const unsigned char* base = image.data.data();
+    const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+    const __m128 size = _mm_setr_ps(static_cast<float>(image.width), static_cast<float>(image.height), 0.0f, 0.0f);
+    const __m128 maxCoord = _mm_setr_ps(static_cast<float>(image.width - 1), static_cast<float>(image.height - 1), 0.0f, 0.0f);
+
+    for (size_t i = 0; i < count; i += 4) {
+        size_t lanes = std::min<size_t>(4, count - i);
+        float pairs[8] = {};
+        std::memcpy(pairs, uv + 2 * i, lanes * 2 * sizeof(float));
+        __m128 first = _mm_loadu_ps(pairs);
+        __m128 second = _mm_loadu_ps(pairs + 4);
+        __m128 u = _mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 v = _mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1));
+
+        int x0[4], x1[4], y0[4], y1[4];
+        float wx[4], wy[4];
+        ComputeTaps(u, v, size, maxCoord, x0, x1, y0, y1, wx, wy);
+
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            size_t column0 = address.Column(x0[lane]), column1 = address.Column(x1[lane]);
+            const unsigned char* row0 = base + address.Row(y0[lane]);
+            const unsigned char* row1 = base + address.Row(y1[lane]);
+            __m128 t00 = LoadTexel(row0 + column0);
+            __m128 t10 = LoadTexel(row0 + column1);
+            __m128 t01 = LoadTexel(row1 + column0);
+            __m128 t11 = LoadTexel(row1 + column1);
+
+            __m128 weightX = _mm_set1_ps(wx[lane]);
+            __m128 weightY = _mm_set1_ps(wy[lane]);
+            __m128 top = _mm_add_ps(t00, _mm_mul_ps(_mm_sub_ps(t10, t00), weightX));
+            __m128 bottom = _mm_add_ps(t01, _mm_mul_ps(_mm_sub_ps(t11, t01), weightX));
+            __m128 result = _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), weightY));
+            _mm_storeu_ps(rgba + 4 * (i + lane), _mm_mul_ps(result, scale));
+        }
+    }
+}
+
+} // namespace
+
+size_t TexelTiling::GetTiledSize(PixelFormat format, int width, int height)
+{
+    size_t tilesWide = (static_cast<size_t>(width) + kTileSize - 1) / kTileSize;
+    size_t tilesHigh = (static_cast<size_t>(height) + kTileSize - 1) / kTileSize;
+    return tilesWide * tilesHigh * kTileTexels * GetBytesPerPixel(format);
+}
+
+ImageData TexelTiling::ToTiled(const ImageData& image)
+{
+    CheckTileable(image);
+    if (image.layout == TexelLayout::Tiled)
+        return image;
+
+    int bpp = GetBytesPerPixel(image.format);
+    size_t pitch = static_cast<size_t>(image.width) * bpp;
+    size_t tileBytes = static_cast<size_t>(kTileTexels) * bpp;
+    int tilesWide = (image.width + kTileSize - 1) / kTileSize;
+    int tilesHigh = (image.height + kTileSize - 1) / kTileSize;
+
+    ImageData result = { image.width, image.height, image.channels, PixelBuffer(GetTiledSize(image.format, image.width, image.height)), image.format, TexelLayout::Tiled };
+
+    TileFunction tile = TileGeneric;
+    if (bpp == 4)
+        tile = CpuFeatures::Get().HasAVX2() ? Tile32_AVX2 : Tile32_SSE2;
+
+    unsigned char padded[kTileTexels * 8];
+    size_t paddedPitch = static_cast<size_t>(kTileSize) * bpp;
+    unsigned char* out = result.data.data();
+    for (int ty = 0; ty < tilesHigh; ++ty) {
+        for (int tx = 0; tx < tilesWide; ++tx, out += tileBytes) {
+            int x0 = tx * kTileSize;
+            int y0 = ty * kTileSize;
+            const unsigned char* src = image.data.data() + y0 * pitch + static_cast<size_t>(x0) * bpp;
+            if (x0 + kTileSize <= image.width && y0 + kTileSize <= image.height) {
+                tile(src, pitch, out, bpp);
+                continue;
+            }
+            // edge tile: gather with the last row and column repeated
+            for (int y = 0; y < kTileSize; ++y) {
+                int sy = std::min(y0 + y, image.height - 1);
+                for (int x = 0; x < kTileSize; ++x) {
+                    int sx = std::min(x0 + x, image.width - 1);
+                    std::memcpy(padded + y * paddedPitch + x * bpp, image.data.data() + sy * pitch + static_cast<size_t>(sx) * bpp, bpp);
+                }
+            }
+            tile(padded, paddedPitch, out, bpp);
+        }
+    }
+    return result;
+}
+
+ImageData TexelTiling::ToLinear(const ImageData& image)
+{
+    CheckTileable(image);
+    if (image.layout == TexelLayout::Linear)
+        return image;
+
+    int bpp = GetBytesPerPixel(image.format);
+    size_t pitch = static_cast<size_t>(image.width) * bpp;
+    size_t tileBytes = static_cast<size_t>(kTileTexels) * bpp;
+    int tilesWide = (image.width + kTileSize - 1) / kTileSize;
+    int tilesHigh = (image.height + kTileSize - 1) / kTileSize;
+
+    ImageData result = { image.width, image.height, image.channels, PixelBuffer(GetImageSize(image.format, image.width, image.height)), image.format, TexelLayout::Linear };
+
+    UntileFunction untile = UntileGeneric;
+    if (bpp == 4)
+        untile = CpuFeatures::Get().HasAVX2() ? Untile32_AVX2 : Untile32_SSE2;
+
+    unsigned char padded[kTileTexels * 8];
+    size_t paddedPitch = static_cast<size_t>(kTileSize) * bpp;
+    const unsigned char* in = image.data.data();
+    for (int ty = 0; ty < tilesHigh; ++ty) {
+        for (int tx = 0; tx < tilesWide; ++tx, in += tileBytes) {
+            int x0 = tx * kTileSize;
+            int y0 = ty * kTileSize;
+            unsigned char* dst = result.data.data() + y0 * pitch + static_cast<size_t>(x0) * bpp;
+            if (x0 + kTileSize <= image.width && y0 + kTileSize <= image.height) {
+                untile(in, dst, pitch, bpp);
+                continue;
+            }
+            untile(in, padded, paddedPitch, bpp);
+            int rows = std::min(kTileSize, image.height - y0);
+            size_t rowBytes = static_cast<size_t>(std::min(kTileSize, image.width - x0)) * bpp;
+            for (int y = 0; y < rows; ++y)
+                std::memcpy(dst + y * pitch, padded + y * paddedPitch, rowBytes);
+        }
+    }
+    return result;
+}
+
+size_t TexelTiling::GetTexelOffset(const ImageData& image, int x, int y)
+{
+    int bpp = GetBytesPerPixel(image.format);
+    if (image.layout == TexelLayout::Linear)
+        return (static_cast<size_t>(y) * image.width + x) * bpp;
+    size_t tilesWide = (static_cast<size_t>(image.width) + kTileSize - 1) / kTileSize;
+    size_t tile = (y / kTileSize) * tilesWide + x / kTileSize;
+    return (tile * kTileTexels + GetMortonIndex(x % kTileSize, y % kTileSize)) * bpp;
+}
+
+void TexelTiling::SampleBilinear(const ImageData& image, const float* uv, size_t count, float* rgba)
+{
+    if (image.format != PixelFormat::RGBA8)
+        throw std::runtime_error("Bilinear sampling needs an RGBA8 image");
+
+    // resolve the layout once per batch rather than per texel
+    if (image.layout == TexelLayout::Linear) {
+        LinearAddress address = { static_cast<size_t>(image.width) * 4 };
+        SampleBilinearRGBA8(image, address, uv, count, rgba);
+    } else {
+        TiledAddress address((static_cast<size_t>(image.width) + kTileSize - 1) / kTileSize);
+        SampleBilinearRGBA8(image, address, uv, count, rgba);
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "Image.h"
+
+// Converts uncompressed images between TexelLayout::Linear and TexelLayout::Tiled, and
+// samples either layout on the CPU. In the tiled layout every 2x2 quad, 4x4 block and 8x8
+// tile is contiguous, so 2D walks (filtering, rotated or column-order sampling) touch a
+// few cache lines per tile instead of one per row.
+class TexelTiling
+{
+public:
+	static const int kTileSize = 8;
+
+	// Tiled images round both dimensions up to whole tiles; the padding repeats the edge
+	static size_t GetTiledSize(PixelFormat format, int width, int height);
+
+	static ImageData ToTiled(const ImageData& image);
+	static ImageData ToLinear(const ImageData& image);
+
+	// Byte offset of texel (x, y) in either layout
+	static size_t GetTexelOffset(const ImageData& image, int x, int y);
+
+	// Bilinear filtering of an RGBA8 image with clamp addressing. uv holds count (u, v)
+	// pairs in [0, 1]; rgba receives count * 4 floats in [0, 1].
+	static void SampleBilinear(const ImageData& image, const float* uv, size_t count, float* rgba);
+
+	// Z order of a texel inside its tile: x bits land on even bit positions, y bits on odd
+	static int GetMortonIndex(int x, int y)
+	{
+		return SpreadBits(x) | (SpreadBits(y) << 1);
+	}
+
+private:
+	static int SpreadBits(int v)
+	{
+		return (v & 1) | ((v & 2) << 1) | ((v & 4) << 2);
+	}
+};
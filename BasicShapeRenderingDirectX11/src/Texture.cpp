@@ -1,13 +1,44 @@
 #include "Texture.h"
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image/stb_image.h>
+#include "AsyncFileReader.h"
+#include "BlockCompressor.h"
+#include "ImageDecoder.h"
+#include "MappedFile.h"
+#include "MipGenerator.h"
+#include "PixelConverter.h"
+#include "TexelTiling.h"
+#include "TextureCache.h"
+#include "ThreadPool.h"
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <stdexcept>
 
-Texture::Texture(std::string& texturePath, ID3D11Device* dev)
+namespace {
+
+size_t GetChainSize(PixelFormat format, int width, int height, bool mipped)
+{
+    size_t bytes = 0;
+    for (;;) {
+        bytes += GetImageSize(format, width, height);
+        if (!mipped || (width == 1 && height == 1))
+            return bytes;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+}
+
+} // namespace
+
+Texture::Texture(const std::string& texturePath, ID3D11Device* dev, const TextureSettings& settings, TextureCache* cache)
+{
+    std::vector<ImageData> levels = cache ? cache->Load(texturePath, settings) : BuildLevels(LoadImageFromFile(texturePath, settings), settings);
+    CreateTextureFromImageData(levels, &mTexture, &mTextureView, dev);
+}
+
+Texture::Texture(const std::vector<ImageData>& levels, ID3D11Device* dev)
 {
-    ImageData imageData = LoadImageFromFile(texturePath);
-    CreateTextureFromImageData(imageData, &mTexture, &mTextureView, dev);
+    CreateTextureFromImageData(levels, &mTexture, &mTextureView, dev);
 }
 
 Texture::~Texture()
@@ -16,40 +47,176 @@ Texture::~Texture()
     mTextureView->Release();
 }
 
-Texture::ImageData Texture::LoadImageFromFile(std::string& filename)
+Texture::ImageData Texture::LoadImageFromFile(const std::string& filename, const TextureSettings& settings)
 {
-	int width, height, channels;
-	unsigned char* data = stbi_load(filename.c_str(), &width, &height, &channels, STBI_rgb_alpha);
-	if (!data) {
-		throw std::runtime_error("Failed to load image");
-	}
+    MappedFile file(filename);
+    return DecodeImage(file.GetData(), file.GetSize(), settings);
+}
 
-	std::vector<unsigned char> imageData(data, data + width * height * 4);
-	stbi_image_free(data);
+Texture::ImageData Texture::DecodeImage(const unsigned char* bytes, size_t size, const TextureSettings& settings)
+{
+    // a JPEG far over the size limit is decoded small rather than in full, staying at
+    // least maxDimension so the final resample still has detail to work with
+    int scaleDenom = std::max(1, settings.decodeScale);
+    int maxDimension = settings.quality.maxDimension;
+    int width, height;
+    if (maxDimension > 0 && ImageDecoder::ReadSize(bytes, size, width, height)) {
+        int longest = std::max(width, height);
+        while (scaleDenom < 8 && (longest + scaleDenom * 2 - 1) / (scaleDenom * 2) >= maxDimension)
+            scaleDenom *= 2;
+    }
+    return ImageDecoder::Decode(bytes, size, scaleDenom);
+}
 
-	return { width, height, 4, std::move(imageData) };
+void Texture::FitToQuality(const ImageData& image, const TextureSettings& settings, int& width, int& height)
+{
+    const TextureQuality& quality = settings.quality;
+    width = image.width;
+    height = image.height;
+    if (IsBlockCompressed(image.format))
+        return;
+
+    double scale = 1.0;
+    int longest = std::max(image.width, image.height);
+    if (quality.maxDimension > 0 && longest > quality.maxDimension)
+        scale = (double)quality.maxDimension / longest;
+
+    // the budget is checked against the format the levels will end up in
+    PixelFormat compressed = BlockCompressor::ChooseFormat(image, settings.compression);
+    bool mipped = settings.mipFilter != MipFilter::None;
+    for (;;) {
+        if (scale < 1.0) {
+            width = std::max(1, (int)(image.width * scale));
+            height = std::max(1, (int)(image.height * scale));
+            // a size we pick may as well keep block compression possible
+            if (IsBlockCompressed(compressed)) {
+                width = std::max(4, width & ~3);
+                height = std::max(4, height & ~3);
+            }
+        }
+        bool blockAligned = width % 4 == 0 && height % 4 == 0;
+        PixelFormat format = IsBlockCompressed(compressed) && blockAligned ? compressed : image.format;
+        size_t bytes = GetChainSize(format, width, height, mipped);
+        if (quality.maxBytes == 0 || bytes <= quality.maxBytes || std::max(width, height) <= 4)
+            return;
+        // bytes go with area, so one square-root step lands close, later passes only correct rounding
+        scale *= std::min(0.99, std::sqrt((double)quality.maxBytes / bytes));
+    }
 }
 
-void Texture::CreateTextureFromImageData(const ImageData& imageData, ID3D11Texture2D** texture, ID3D11ShaderResourceView** textureView, ID3D11Device* dev)
+std::vector<Texture::ImageData> Texture::BuildLevels(ImageData image, const TextureSettings& settings)
+{
+    if (image.layout == TexelLayout::Tiled)
+        image = TexelTiling::ToLinear(image);
+    bool grey = image.format == PixelFormat::R8 || image.format == PixelFormat::RG8;
+    if (settings.forceRGBA && grey)
+        image = PixelConverter::Convert(image, PixelFormat::RGBA8);
+    // before filtering, so mips average premultiplied colours
+    if (settings.premultiplyAlpha && !IsFloatFormat(image.format))
+        PixelConverter::PremultiplyAlpha(image);
+
+    int width, height;
+    FitToQuality(image, settings, width, height);
+    if (width != image.width || height != image.height)
+        image = MipGenerator::Resize(image, width, height, settings.quality.filter);
+
+    std::vector<ImageData> mips = MipGenerator::GenerateMips(image, settings.mipFilter);
+    std::vector<ImageData> levels;
+    levels.reserve(1 + mips.size());
+    levels.push_back(std::move(image));
+    for (ImageData& mip : mips)
+        levels.push_back(std::move(mip));
+
+    // D3D11 only accepts block-compressed textures whose top level is a multiple of 4
+    PixelFormat format = BlockCompressor::ChooseFormat(levels[0], settings.compression);
+    bool blockAligned = levels[0].width % 4 == 0 && levels[0].height % 4 == 0;
+    if (IsBlockCompressed(format) && blockAligned) {
+        for (ImageData& level : levels)
+            level = BlockCompressor::Compress(level, format, settings.compressionQuality);
+    }
+    return levels;
+}
+
+std::future<std::vector<Texture::ImageData>> Texture::LoadLevelsAsync(const std::string& path, const TextureSettings& settings, TextureCache* cache,
+    AsyncFileReader& reader, ThreadPool& pool)
+{
+    auto promise = std::make_shared<std::promise<std::vector<ImageData>>>();
+    std::future<std::vector<ImageData>> levels = promise->get_future();
+    // the callback runs on the reader's I/O thread, so the decode goes straight to the pool
+    reader.Read(path, [promise, path, settings, cache, &pool](std::vector<unsigned char> bytes, std::exception_ptr error) {
+        if (error) {
+            promise->set_exception(error);
+            return;
+        }
+        auto file = std::make_shared<std::vector<unsigned char>>(std::move(bytes));
+        pool.Submit([promise, path, settings, cache, file]() {
+            try {
+                if (cache)
+                    promise->set_value(cache->Load(path, file->data(), file->size(), settings));
+                else
+                    promise->set_value(BuildLevels(DecodeImage(file->data(), file->size(), settings), settings));
+            }
+            catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        });
+    });
+    return levels;
+}
+
+Texture::ImageData Texture::MakePlaceholder()
+{
+    return { 2, 2, 4, std::vector<unsigned char>(2 * 2 * 4, 128) };
+}
+
+DXGI_FORMAT Texture::GetDxgiFormat(PixelFormat format)
+{
+    switch (format) {
+    case PixelFormat::BC1:
+        return DXGI_FORMAT_BC1_UNORM;
+    case PixelFormat::BC3:
+        return DXGI_FORMAT_BC3_UNORM;
+    case PixelFormat::BC7:
+        return DXGI_FORMAT_BC7_UNORM;
+    case PixelFormat::R8:
+        return DXGI_FORMAT_R8_UNORM;
+    case PixelFormat::RG8:
+        return DXGI_FORMAT_R8G8_UNORM;
+    case PixelFormat::RGBA16F:
+        return DXGI_FORMAT_R16G16B16A16_FLOAT;
+    case PixelFormat::R11G11B10F:
+        return DXGI_FORMAT_R11G11B10_FLOAT;
+    default:
+        return DXGI_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+void Texture::CreateTextureFromImageData(const std::vector<ImageData>& levels, ID3D11Texture2D** texture, ID3D11ShaderResourceView** textureView, ID3D11Device* dev)
 {
     D3D11_TEXTURE2D_DESC desc;
     ZeroMemory(&desc, sizeof(desc));
-    desc.Width = imageData.width;
-    desc.Height = imageData.height;
-    desc.MipLevels = 1;
+    desc.Width = levels[0].width;
+    desc.Height = levels[0].height;
+    desc.MipLevels = static_cast<UINT>(levels.size());
     desc.ArraySize = 1;
-    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.Format = GetDxgiFormat(levels[0].format);
     desc.SampleDesc.Count = 1;
     desc.Usage = D3D11_USAGE_DEFAULT;
     desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
     desc.CPUAccessFlags = 0;
 
-    D3D11_SUBRESOURCE_DATA initData;
-    initData.pSysMem = imageData.data.data();
-    initData.SysMemPitch = static_cast<UINT>(imageData.width * 4);
-    initData.SysMemSlicePitch = 0;
+    // one entry per mip level
+    std::vector<D3D11_SUBRESOURCE_DATA> initData(desc.MipLevels);
+    for (size_t i = 0; i < levels.size(); ++i) {
+        if (levels[i].layout != TexelLayout::Linear) {
+            throw std::runtime_error("Texture levels must be in linear layout");
+        }
+        initData[i].pSysMem = levels[i].data.data();
+        initData[i].SysMemPitch = static_cast<UINT>(GetRowPitch(levels[i].format, levels[i].width));
+        initData[i].SysMemSlicePitch = 0;
+    }
 
-    HRESULT hr = dev->CreateTexture2D(&desc, &initData, texture);
+    HRESULT hr = dev->CreateTexture2D(&desc, initData.data(), texture);
     if (FAILED(hr)) {
         throw std::runtime_error("Failed to create texture");
     }
@@ -59,7 +226,7 @@ void Texture::CreateTextureFromImageData(const ImageData& imageData, ID3D11Textu
     srvDesc.Format = desc.Format;
     srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
     srvDesc.Texture2D.MostDetailedMip = 0;
-    srvDesc.Texture2D.MipLevels = 1;
+    srvDesc.Texture2D.MipLevels = desc.MipLevels;
 
     hr = dev->CreateShaderResourceView(*texture, &srvDesc, textureView);
     if (FAILED(hr)) {
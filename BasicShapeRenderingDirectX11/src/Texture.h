@@ -1,22 +1,42 @@
 #pragma once
 #include <d3d11.h>
+#include <future>
 #include <string>
 #include <vector>
+#include "Image.h"
+#include "TextureSettings.h"
+class AsyncFileReader;
+class TextureCache;
+class ThreadPool;
+
 class Texture
 {
 public:
-	struct ImageData {
-		int width;
-		int height;
-		int channels;
-		std::vector<unsigned char> data;
-	};
-	Texture(std::string& texturePath, ID3D11Device* dev);
+	using ImageData = ::ImageData;
+	// With a cache, a previously cooked copy is uploaded directly instead of decoding the source
+	Texture(const std::string& texturePath, ID3D11Device* dev, const TextureSettings& settings = TextureSettings(), TextureCache* cache = nullptr);
+	// Uploads levels that were already prepared elsewhere, most detailed first
+	Texture(const std::vector<ImageData>& levels, ID3D11Device* dev);
 	~Texture();
 	ID3D11ShaderResourceView* GetTextureView() const { return mTextureView; }
+
+	// Safe to call from worker threads, touches no D3D state
+	static ImageData LoadImageFromFile(const std::string& filename, const TextureSettings& settings = TextureSettings());
+	// See ImageDecoder. Only the decode scale and quality settings are used here.
+	static ImageData DecodeImage(const unsigned char* bytes, size_t size, const TextureSettings& settings = TextureSettings());
+	// Fits the quality limits, generates mips and applies block compression as requested, CPU only
+	static std::vector<ImageData> BuildLevels(ImageData image, const TextureSettings& settings);
+	// Reads the file through reader and decodes and builds its levels (or looks them up in
+	// the cache) on pool, with no thread blocked on the disk in between
+	static std::future<std::vector<ImageData>> LoadLevelsAsync(const std::string& path, const TextureSettings& settings, TextureCache* cache,
+		AsyncFileReader& reader, ThreadPool& pool);
+	// Size the top level gets under the settings' quality limits
+	static void FitToQuality(const ImageData& image, const TextureSettings& settings, int& width, int& height);
+	static DXGI_FORMAT GetDxgiFormat(PixelFormat format);
+	// 2x2 mid grey, bound while the real image is decoding (or if it failed to load)
+	static ImageData MakePlaceholder();
 private:
-	ImageData LoadImageFromFile(std::string& filename);
-	void CreateTextureFromImageData(const ImageData& imageData, ID3D11Texture2D** texture, ID3D11ShaderResourceView** textureView, ID3D11Device* dev);
+	void CreateTextureFromImageData(const std::vector<ImageData>& levels, ID3D11Texture2D** texture, ID3D11ShaderResourceView** textureView, ID3D11Device* dev);
 private:
 	ID3D11Texture2D* mTexture;
 	ID3D11ShaderResourceView* mTextureView;
@@ -0,0 +1,91 @@
+#include "TextureArray.h"
+#include "Texture.h"
+#include "TextureCache.h"
+#include "ThreadPool.h"
+
+#include <stdexcept>
+
+TextureArray::TextureArray(const std::vector<std::vector<ImageData>>& slices, ID3D11Device* dev)
+{
+    CreateTextureArray(slices, dev);
+}
+
+TextureArray::TextureArray(const std::vector<std::string>& paths, ID3D11Device* dev, const TextureSettings& settings, TextureCache* cache)
+{
+    std::vector<std::vector<ImageData>> slices(paths.size());
+    ThreadPool::Default().ParallelFor(paths.size(), [&](size_t i) {
+        slices[i] = cache ? cache->Load(paths[i], settings) : Texture::BuildLevels(Texture::LoadImageFromFile(paths[i], settings), settings);
+    });
+    CreateTextureArray(slices, dev);
+}
+
+TextureArray::~TextureArray()
+{
+    if (mTextureView)
+        mTextureView->Release();
+    if (mTexture)
+        mTexture->Release();
+}
+
+void TextureArray::CreateTextureArray(const std::vector<std::vector<ImageData>>& slices, ID3D11Device* dev)
+{
+    if (slices.empty() || slices[0].empty()) {
+        throw std::runtime_error("Texture array needs at least one slice");
+    }
+
+    const std::vector<ImageData>& first = slices[0];
+    for (const std::vector<ImageData>& slice : slices) {
+        if (slice.size() != first.size() || slice[0].width != first[0].width ||
+            slice[0].height != first[0].height || slice[0].format != first[0].format) {
+            throw std::runtime_error("Texture array slices must share size, mip count and format");
+        }
+        for (const ImageData& level : slice) {
+            if (level.layout != TexelLayout::Linear)
+                throw std::runtime_error("Texture array levels must be in linear layout");
+        }
+    }
+
+    D3D11_TEXTURE2D_DESC desc;
+    ZeroMemory(&desc, sizeof(desc));
+    desc.Width = first[0].width;
+    desc.Height = first[0].height;
+    desc.MipLevels = static_cast<UINT>(first.size());
+    desc.ArraySize = static_cast<UINT>(slices.size());
+    desc.Format = Texture::GetDxgiFormat(first[0].format);
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.CPUAccessFlags = 0;
+
+    // subresource index is slice * MipLevels + mip
+    std::vector<D3D11_SUBRESOURCE_DATA> initData(desc.MipLevels * desc.ArraySize);
+    for (size_t slice = 0; slice < slices.size(); ++slice) {
+        for (size_t mip = 0; mip < first.size(); ++mip) {
+            const ImageData& level = slices[slice][mip];
+            D3D11_SUBRESOURCE_DATA& data = initData[slice * desc.MipLevels + mip];
+            data.pSysMem = level.data.data();
+            data.SysMemPitch = static_cast<UINT>(GetRowPitch(level.format, level.width));
+            data.SysMemSlicePitch = 0;
+        }
+    }
+
+    HRESULT hr = dev->CreateTexture2D(&desc, initData.data(), &mTexture);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to create texture array");
+    }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+    ZeroMemory(&srvDesc, sizeof(srvDesc));
+    srvDesc.Format = desc.Format;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+    srvDesc.Texture2DArray.MostDetailedMip = 0;
+    srvDesc.Texture2DArray.MipLevels = desc.MipLevels;
+    srvDesc.Texture2DArray.FirstArraySlice = 0;
+    srvDesc.Texture2DArray.ArraySize = desc.ArraySize;
+
+    hr = dev->CreateShaderResourceView(mTexture, &srvDesc, &mTextureView);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to create shader resource view");
+    }
+    mSliceCount = desc.ArraySize;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <d3d11.h>
+#include <string>
+#include <vector>
+#include "Image.h"
+#include "TextureSettings.h"
+
+class TextureCache;
+
+// Same-sized textures packed into one Texture2DArray so they can all be bound with a
+// single SRV. Materials address a texture by its slice index. The contents are fixed;
+// TextureStreamer::LoadArray streams and hot-reloads arrays instead.
+class TextureArray
+{
+public:
+	// slices[i] is the full level chain of slice i; every slice must match the first in
+	// size, level count and pixel format
+	TextureArray(const std::vector<std::vector<ImageData>>& slices, ID3D11Device* dev);
+	// Decodes (or reads from the cache) every file in parallel, slice i is paths[i]
+	TextureArray(const std::vector<std::string>& paths, ID3D11Device* dev, const TextureSettings& settings = TextureSettings(), TextureCache* cache = nullptr);
+	~TextureArray();
+
+	TextureArray(const TextureArray&) = delete;
+	TextureArray& operator=(const TextureArray&) = delete;
+
+	ID3D11ShaderResourceView* GetTextureView() const { return mTextureView; }
+	UINT GetSliceCount() const { return mSliceCount; }
+
+private:
+	void CreateTextureArray(const std::vector<std::vector<ImageData>>& slices, ID3D11Device* dev);
+
+private:
+	ID3D11Texture2D* mTexture = nullptr;
+	ID3D11ShaderResourceView* mTextureView = nullptr;
+	UINT mSliceCount = 0;
+};
@@ -0,0 +1,89 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+bool AtlasPacker::Pack(const std::vector<ImageData>& images, int padding, int maxSize, TextureAtlas& atlas)
+{
+    for (const ImageData& image : images) {
+        if (image.format != PixelFormat::RGBA8) {
+            throw std::runtime_error("Atlas packing needs RGBA8 images");
+        }
+    }
+
+    // tallest first keeps the shelves tight
+    std::vector<size_t> order(images.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return images[a].height > images[b].height;
+    });
+
+    // grow a power-of-two square until every padded image fits on a shelf
+    int size = 1;
+    std::vector<int> xs(images.size()), ys(images.size());
+    for (;;) {
+        int shelfX = 0, shelfY = 0, shelfHeight = 0;
+        bool fits = true;
+        for (size_t i : order) {
+            int w = images[i].width + padding * 2;
+            int h = images[i].height + padding * 2;
+            if (shelfX + w > size) {
+                shelfY += shelfHeight;
+                shelfX = 0;
+                shelfHeight = 0;
+            }
+            if (w > size || shelfY + h > size) {
+                fits = false;
+                break;
+            }
+            xs[i] = shelfX + padding;
+            ys[i] = shelfY + padding;
+            shelfX += w;
+            shelfHeight = std::max(shelfHeight, h);
+        }
+        if (fits)
+            break;
+        if (size >= maxSize)
+            return false;
+        size = std::min(size * 2, maxSize);
+    }
+
+    atlas.image.width = size;
+    atlas.image.height = size;
+    atlas.image.channels = 4;
+    atlas.image.format = PixelFormat::RGBA8;
+    atlas.image.data = PixelBuffer(static_cast<size_t>(size) * size * 4);
+    std::memset(atlas.image.data.data(), 0, atlas.image.data.size());
+
+    atlas.regions.resize(images.size());
+    for (size_t i = 0; i < images.size(); ++i) {
+        Blit(images[i], xs[i], ys[i], padding, atlas.image);
+
+        AtlasRegion& region = atlas.regions[i];
+        region.uOffset = static_cast<float>(xs[i]) / size;
+        region.vOffset = static_cast<float>(ys[i]) / size;
+        region.uScale = static_cast<float>(images[i].width) / size;
+        region.vScale = static_cast<float>(images[i].height) / size;
+    }
+    return true;
+}
+
+void AtlasPacker::Blit(const ImageData& image, int x, int y, int padding, ImageData& atlas)
+{
+    size_t atlasPitch = static_cast<size_t>(atlas.width) * 4;
+    size_t rowBytes = static_cast<size_t>(image.width) * 4;
+
+    for (int row = -padding; row < image.height + padding; ++row) {
+        int srcRow = std::min(std::max(row, 0), image.height - 1);
+        const unsigned char* src = image.data.data() + srcRow * rowBytes;
+        unsigned char* dst = atlas.data.data() + (y + row) * atlasPitch + static_cast<size_t>(x) * 4;
+
+        std::memcpy(dst, src, rowBytes);
+        for (int i = 1; i <= padding; ++i) {
+            std::memcpy(dst - i * 4, src, 4);
+            std::memcpy(dst + rowBytes + (i - 1) * 4, src + rowBytes - 4, 4);
+        }
+    }
+}
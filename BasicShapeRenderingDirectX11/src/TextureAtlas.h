@@ -0,0 +1,33 @@
+#pragma once
+#include "Image.h"
+#include <vector>
+
+// Where an image ended up inside an atlas. A shader maps the image's own UVs with
+// uv * scale + offset.
+struct AtlasRegion
+{
+	float uOffset;
+	float vOffset;
+	float uScale;
+	float vScale;
+};
+
+struct TextureAtlas
+{
+	ImageData image;
+	// regions[i] belongs to the i-th input image
+	std::vector<AtlasRegion> regions;
+};
+
+// Packs RGBA8 images of any size into one atlas with a shelf packer. Every image gets a
+// border of replicated edge texels so bilinear filtering and the first few mips do not
+// bleed neighbouring images in.
+class AtlasPacker
+{
+public:
+	// Returns false if the images do not fit in maxSize x maxSize
+	static bool Pack(const std::vector<ImageData>& images, int padding, int maxSize, TextureAtlas& atlas);
+
+private:
+	static void Blit(const ImageData& image, int x, int y, int padding, ImageData& atlas);
+};
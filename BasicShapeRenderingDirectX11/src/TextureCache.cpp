@@ -0,0 +1,200 @@
+#include "TextureCache.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include "Texture.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+const uint32_t kMagic = 0x58455443; // "CTEX"
+// bump whenever the cook pipeline changes its output
+const uint32_t kVersion = 3;
+// level data offsets are aligned so every level starts on a cache line
+const uint64_t kAlignment = 64;
+
+struct CookedHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t channels;
+    uint32_t levelCount;
+    uint32_t reserved;
+};
+
+struct CookedLevel {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t width;
+    uint32_t height;
+};
+
+uint64_t AlignUp(uint64_t value)
+{
+    return (value + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+} // namespace
+
+TextureCache::TextureCache(const std::string& directory)
+    : mDirectory(directory)
+{
+#if defined(_WIN32)
+    int result = _mkdir(directory.c_str());
+#else
+    int result = mkdir(directory.c_str(), 0755);
+#endif
+    if (result != 0 && errno != EEXIST)
+        throw std::runtime_error("Failed to create texture cache directory " + directory);
+}
+
+uint64_t TextureCache::ComputeKey(const unsigned char* source, size_t size, const TextureSettings& settings)
+{
+    uint64_t seed = kVersion;
+    seed = HashCombine(seed, static_cast<uint64_t>(settings.mipFilter));
+    seed = HashCombine(seed, static_cast<uint64_t>(settings.compression));
+    seed = HashCombine(seed, static_cast<uint64_t>(settings.compressionQuality));
+    seed = HashCombine(seed, static_cast<uint64_t>(settings.forceRGBA));
+    seed = HashCombine(seed, static_cast<uint64_t>(settings.premultiplyAlpha));
+    seed = HashCombine(seed, static_cast<uint64_t>(settings.decodeScale));
+    seed = HashCombine(seed, static_cast<uint64_t>(settings.quality.maxDimension));
+    seed = HashCombine(seed, static_cast<uint64_t>(settings.quality.maxBytes));
+    seed = HashCombine(seed, static_cast<uint64_t>(settings.quality.filter));
+    return HashBytes(source, size, seed);
+}
+
+std::string TextureCache::GetEntryPath(uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.ctex", static_cast<unsigned long long>(key));
+    return mDirectory + "/" + name;
+}
+
+std::vector<ImageData> TextureCache::Load(const std::string& sourcePath, const TextureSettings& settings)
+{
+    // the source has to be read for its hash anyway, a miss decodes from the same mapping
+    MappedFile source(sourcePath);
+    return Load(sourcePath, source.GetData(), source.GetSize(), settings);
+}
+
+std::vector<ImageData> TextureCache::Load(const std::string& sourcePath, const unsigned char* source, size_t size, const TextureSettings& settings)
+{
+    uint64_t key = ComputeKey(source, size, settings);
+
+    std::vector<ImageData> levels;
+    if (TryLoad(key, levels))
+        return levels;
+
+    levels = Texture::BuildLevels(Texture::DecodeImage(source, size, settings), settings);
+    if (!Store(key, levels))
+        std::cerr << "Failed to write texture cache entry for " << sourcePath << std::endl;
+    return levels;
+}
+
+bool TextureCache::TryLoad(uint64_t key, std::vector<ImageData>& levels) const
+{
+    std::shared_ptr<MappedFile> file;
+    try {
+        file = std::make_shared<MappedFile>(GetEntryPath(key));
+    }
+    catch (const std::runtime_error&) {
+        return false;
+    }
+
+    const unsigned char* base = file->GetData();
+    size_t fileSize = file->GetSize();
+    if (fileSize < sizeof(CookedHeader))
+        return false;
+
+    CookedHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (header.magic != kMagic || header.version != kVersion || header.key != key || header.levelCount == 0)
+        return false;
+    if (sizeof(CookedHeader) + sizeof(CookedLevel) * static_cast<size_t>(header.levelCount) > fileSize)
+        return false;
+
+    PixelFormat format = static_cast<PixelFormat>(header.format);
+    std::vector<ImageData> mapped;
+    mapped.reserve(header.levelCount);
+    for (uint32_t i = 0; i < header.levelCount; ++i) {
+        CookedLevel level;
+        std::memcpy(&level, base + sizeof(CookedHeader) + i * sizeof(CookedLevel), sizeof(level));
+        if (level.offset > fileSize || level.size > fileSize - level.offset ||
+            level.size != GetImageSize(format, static_cast<int>(level.width), static_cast<int>(level.height)))
+            return false;
+
+        // the levels alias the read-only mapping and keep it alive until the last one is released
+        unsigned char* pixels = const_cast<unsigned char*>(base + level.offset);
+        PixelBuffer buffer(pixels, static_cast<size_t>(level.size), [file](unsigned char*) {});
+        mapped.push_back({ static_cast<int>(level.width), static_cast<int>(level.height), static_cast<int>(header.channels), std::move(buffer), format });
+    }
+
+    levels = std::move(mapped);
+    return true;
+}
+
+bool TextureCache::Store(uint64_t key, const std::vector<ImageData>& levels)
+{
+    if (levels.empty())
+        return false;
+
+    CookedHeader header = {};
+    header.magic = kMagic;
+    header.version = kVersion;
+    header.key = key;
+    header.format = static_cast<uint32_t>(levels[0].format);
+    header.channels = static_cast<uint32_t>(levels[0].channels);
+    header.levelCount = static_cast<uint32_t>(levels.size());
+
+    std::vector<CookedLevel> table(levels.size());
+    uint64_t offset = AlignUp(sizeof(CookedHeader) + sizeof(CookedLevel) * levels.size());
+    for (size_t i = 0; i < levels.size(); ++i) {
+        table[i].offset = offset;
+        table[i].size = levels[i].data.size();
+        table[i].width = static_cast<uint32_t>(levels[i].width);
+        table[i].height = static_cast<uint32_t>(levels[i].height);
+        offset = AlignUp(offset + table[i].size);
+    }
+
+    // write under a unique name and rename, so readers never map a partial entry
+    std::string path = GetEntryPath(key);
+    std::string tempPath = path + ".tmp" + std::to_string(mTempCounter.fetch_add(1));
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+
+        static const char padding[kAlignment] = {};
+        uint64_t written = 0;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(table.data()), sizeof(CookedLevel) * table.size());
+        written = sizeof(header) + sizeof(CookedLevel) * table.size();
+        for (size_t i = 0; i < levels.size(); ++i) {
+            out.write(padding, static_cast<std::streamsize>(table[i].offset - written));
+            out.write(reinterpret_cast<const char*>(levels[i].data.data()), static_cast<std::streamsize>(table[i].size));
+            written = table[i].offset + table[i].size;
+        }
+        if (!out)
+            return false;
+    }
+
+    std::remove(path.c_str());
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
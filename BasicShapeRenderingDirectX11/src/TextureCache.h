@@ -0,0 +1,34 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Image.h"
+#include "TextureSettings.h"
+
+// On-disk cache of cooked textures. Each entry is one file holding the final pixel
+// format and every mip level, keyed by a hash of the source bytes and the cook
+// settings. Hits are memory-mapped and the returned levels point straight into the
+// mapping, so nothing is decoded or copied before upload.
+class TextureCache
+{
+public:
+	explicit TextureCache(const std::string& directory);
+
+	// Cooked levels for sourcePath, cooking and storing them on a miss. Thread-safe.
+	std::vector<ImageData> Load(const std::string& sourcePath, const TextureSettings& settings);
+	// Same, for source bytes that were already read; sourcePath is only used in messages
+	std::vector<ImageData> Load(const std::string& sourcePath, const unsigned char* source, size_t size, const TextureSettings& settings);
+
+	bool TryLoad(uint64_t key, std::vector<ImageData>& levels) const;
+	bool Store(uint64_t key, const std::vector<ImageData>& levels);
+
+	static uint64_t ComputeKey(const unsigned char* source, size_t size, const TextureSettings& settings);
+
+private:
+	std::string GetEntryPath(uint64_t key) const;
+
+private:
+	std::string mDirectory;
+	std::atomic<unsigned int> mTempCounter{ 0 };
+};
@@ -0,0 +1,410 @@
+#include "TextureGenerator.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+using Colour = TextureGenerator::Colour;
+
+// rows per ParallelFor task, enough to amortise the task without starving small images
+const int kBandRows = 8;
+
+// Each generator describes a row as two fields: mix picks between its two colours (0 is the
+// first) and shade scales the result. Rows are padded to a multiple of 4 texels.
+using RowFunction = std::function<void(int y, float* mix, float* shade)>;
+
+// Four-lane integer hash built from adds, shifts and xors only, since SSE2 has no 32-bit multiply
+inline __m128i Hash(__m128i x, __m128i y, __m128i seed)
+{
+    __m128i h = _mm_add_epi32(seed, x);
+    h = _mm_add_epi32(h, _mm_slli_epi32(h, 10));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 6));
+    h = _mm_add_epi32(h, y);
+    h = _mm_add_epi32(h, _mm_slli_epi32(h, 10));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 6));
+    h = _mm_add_epi32(h, _mm_slli_epi32(h, 3));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 11));
+    h = _mm_add_epi32(h, _mm_slli_epi32(h, 15));
+    return h;
+}
+
+// Top 24 bits as a float in [0, 1)
+inline __m128 HashToUnit(__m128i h)
+{
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(h, 8)), _mm_set1_ps(1.0f / 16777216.0f));
+}
+
+inline __m128 Clamp01(__m128 v)
+{
+    return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+}
+
+inline __m128 Lerp(__m128 a, __m128 b, __m128 t)
+{
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+}
+
+inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Texel centres x .. x+3
+inline __m128 Columns(int x)
+{
+    return _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f));
+}
+
+// 6t^5 - 15t^4 + 10t^3
+inline __m128 Fade(__m128 t)
+{
+    __m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+    return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+}
+
+// One of eight gradients (+-1, +-2) and (+-2, +-1) picked by the low three hash bits, dotted with (x, y)
+inline __m128 Gradient(__m128i h, __m128 x, __m128 y)
+{
+    __m128 xFirst = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h, _mm_set1_epi32(4)), _mm_setzero_si128()));
+    __m128 u = Select(xFirst, x, y);
+    __m128 v = Select(xFirst, y, x);
+    __m128 signU = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+    __m128 signV = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+    return _mm_add_ps(_mm_xor_ps(u, signU), _mm_xor_ps(_mm_add_ps(v, v), signV));
+}
+
+// x holds four non-negative lattice coordinates, y is shared. Results are in about [-1, 1].
+inline __m128 ValueNoise(__m128 x, float y, int period, __m128i seed)
+{
+    __m128i xi = _mm_cvttps_epi32(x);
+    int yi = static_cast<int>(y);
+    __m128 xf = _mm_sub_ps(x, _mm_cvtepi32_ps(xi));
+    float yf = y - yi;
+
+    __m128i xi1 = _mm_add_epi32(xi, _mm_set1_epi32(1));
+    xi1 = _mm_andnot_si128(_mm_cmpeq_epi32(xi1, _mm_set1_epi32(period)), xi1);
+    __m128i y0 = _mm_set1_epi32(yi);
+    __m128i y1 = _mm_set1_epi32(yi + 1 == period ? 0 : yi + 1);
+
+    // cubic smoothstep, value noise has no gradient to keep continuous
+    __m128 u = _mm_mul_ps(_mm_mul_ps(xf, xf), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_add_ps(xf, xf)));
+    __m128 v = _mm_set1_ps(yf * yf * (3.0f - 2.0f * yf));
+    __m128 top = Lerp(HashToUnit(Hash(xi, y0, seed)), HashToUnit(Hash(xi1, y0, seed)), u);
+    __m128 bottom = Lerp(HashToUnit(Hash(xi, y1, seed)), HashToUnit(Hash(xi1, y1, seed)), u);
+    return _mm_sub_ps(_mm_mul_ps(Lerp(top, bottom, v), _mm_set1_ps(2.0f)), _mm_set1_ps(1.0f));
+}
+
+inline __m128 PerlinNoise(__m128 x, float y, int period, __m128i seed)
+{
+    __m128i xi = _mm_cvttps_epi32(x);
+    int yi = static_cast<int>(y);
+    __m128 xf = _mm_sub_ps(x, _mm_cvtepi32_ps(xi));
+    __m128 yf = _mm_set1_ps(y - yi);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    __m128i xi1 = _mm_add_epi32(xi, _mm_set1_epi32(1));
+    xi1 = _mm_andnot_si128(_mm_cmpeq_epi32(xi1, _mm_set1_epi32(period)), xi1);
+    __m128i y0 = _mm_set1_epi32(yi);
+    __m128i y1 = _mm_set1_epi32(yi + 1 == period ? 0 : yi + 1);
+
+    __m128 g00 = Gradient(Hash(xi, y0, seed), xf, yf);
+    __m128 g10 = Gradient(Hash(xi1, y0, seed), _mm_sub_ps(xf, one), yf);
+    __m128 g01 = Gradient(Hash(xi, y1, seed), xf, _mm_sub_ps(yf, one));
+    __m128 g11 = Gradient(Hash(xi1, y1, seed), _mm_sub_ps(xf, one), _mm_sub_ps(yf, one));
+
+    __m128 u = Fade(xf);
+    __m128 v = Fade(yf);
+    // a cell peaks at sqrt(0.5) times the gradient length of sqrt(5)
+    return _mm_mul_ps(Lerp(Lerp(g00, g10, u), Lerp(g01, g11, u), v), _mm_set1_ps(0.632455532f));
+}
+
+// Contribution of one simplex corner: (0.5 - d^2)^4 * gradient, zero outside the radius
+inline __m128 SimplexCorner(__m128i h, __m128 x, __m128 y)
+{
+    __m128 t = _mm_sub_ps(_mm_set1_ps(0.5f), _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+    t = _mm_max_ps(t, _mm_setzero_ps());
+    t = _mm_mul_ps(t, t);
+    return _mm_mul_ps(_mm_mul_ps(t, t), Gradient(h, x, y));
+}
+
+// 2D simplex noise after Gustavson. The skewed lattice does not wrap, so this one does not tile.
+inline __m128 SimplexNoise(__m128 x, float y, __m128i seed)
+{
+    const float F2 = 0.36602540378f;	// (sqrt(3) - 1) / 2
+    const float G2 = 0.21132486540f;	// (3 - sqrt(3)) / 6
+    __m128 yv = _mm_set1_ps(y);
+
+    __m128 s = _mm_mul_ps(_mm_add_ps(x, yv), _mm_set1_ps(F2));
+    __m128i i = _mm_cvttps_epi32(_mm_add_ps(x, s));
+    __m128i j = _mm_cvttps_epi32(_mm_add_ps(yv, s));
+    __m128 fi = _mm_cvtepi32_ps(i);
+    __m128 fj = _mm_cvtepi32_ps(j);
+    __m128 t = _mm_mul_ps(_mm_add_ps(fi, fj), _mm_set1_ps(G2));
+    __m128 x0 = _mm_sub_ps(x, _mm_sub_ps(fi, t));
+    __m128 y0 = _mm_sub_ps(yv, _mm_sub_ps(fj, t));
+
+    // lower or upper triangle of the skewed cell
+    __m128 lower = _mm_cmpgt_ps(x0, y0);
+    __m128 i1 = _mm_and_ps(lower, _mm_set1_ps(1.0f));
+    __m128 j1 = _mm_sub_ps(_mm_set1_ps(1.0f), i1);
+    __m128i i1i = _mm_cvttps_epi32(i1);
+    __m128i j1i = _mm_cvttps_epi32(j1);
+
+    __m128 g2 = _mm_set1_ps(G2);
+    __m128 x1 = _mm_add_ps(_mm_sub_ps(x0, i1), g2);
+    __m128 y1 = _mm_add_ps(_mm_sub_ps(y0, j1), g2);
+    __m128 x2 = _mm_add_ps(_mm_sub_ps(x0, _mm_set1_ps(1.0f)), _mm_add_ps(g2, g2));
+    __m128 y2 = _mm_add_ps(_mm_sub_ps(y0, _mm_set1_ps(1.0f)), _mm_add_ps(g2, g2));
+
+    const __m128i oneI = _mm_set1_epi32(1);
+    __m128 n = SimplexCorner(Hash(i, j, seed), x0, y0);
+    n = _mm_add_ps(n, SimplexCorner(Hash(_mm_add_epi32(i, i1i), _mm_add_epi32(j, j1i), seed), x1, y1));
+    n = _mm_add_ps(n, SimplexCorner(Hash(_mm_add_epi32(i, oneI), _mm_add_epi32(j, oneI), seed), x2, y2));
+    return _mm_mul_ps(n, _mm_set1_ps(40.0f));
+}
+
+// mix and shade to RGBA8 for four texels: colour = (from + (to - from) * mix) * shade, where
+// shade leaves alpha alone
+inline __m128i ShadeTexels(__m128 mix, __m128 shade, const __m128 from[4], const __m128 delta[4])
+{
+    __m128i channels[4];
+    for (int c = 0; c < 3; ++c)
+        channels[c] = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(from[c], _mm_mul_ps(delta[c], mix)), shade));
+    channels[3] = _mm_cvtps_epi32(_mm_add_ps(from[3], _mm_mul_ps(delta[3], mix)));
+    // R0-3 B0-3 G0-3 A0-3, then two interleaves put every texel's bytes together
+    __m128i planar = _mm_packus_epi16(_mm_packs_epi32(channels[0], channels[2]), _mm_packs_epi32(channels[1], channels[3]));
+    __m128i pairs = _mm_unpacklo_epi8(planar, _mm_srli_si128(planar, 8));
+    return _mm_unpacklo_epi16(pairs, _mm_srli_si128(pairs, 8));
+}
+
+ImageData Generate(int width, int height, Colour from, Colour to, ThreadPool& pool, const RowFunction& row)
+{
+    if (width <= 0 || height <= 0)
+        throw std::runtime_error("Generated textures need a positive size");
+
+    ImageData result = { width, height, 4, PixelBuffer(static_cast<size_t>(width) * height * 4), PixelFormat::RGBA8 };
+    int paddedWidth = (width + 3) & ~3;
+    const unsigned char fromBytes[4] = { from.r, from.g, from.b, from.a };
+    const unsigned char toBytes[4] = { to.r, to.g, to.b, to.a };
+    __m128 fromColour[4], deltaColour[4];
+    for (int c = 0; c < 4; ++c) {
+        fromColour[c] = _mm_set1_ps(fromBytes[c]);
+        deltaColour[c] = _mm_set1_ps(static_cast<float>(toBytes[c] - fromBytes[c]));
+    }
+
+    size_t bands = static_cast<size_t>((height + kBandRows - 1) / kBandRows);
+    pool.ParallelFor(bands, [&](size_t band) {
+        std::vector<float> mix(paddedWidth), shade(paddedWidth);
+        int y0 = static_cast<int>(band) * kBandRows;
+        int y1 = std::min(y0 + kBandRows, height);
+        for (int y = y0; y < y1; ++y) {
+            row(y, mix.data(), shade.data());
+            unsigned char* dst = result.data.data() + static_cast<size_t>(y) * width * 4;
+            int x = 0;
+            for (; x + 4 <= width; x += 4)
+                _mm_storeu_si128((__m128i*)(dst + x * 4), ShadeTexels(_mm_loadu_ps(&mix[x]), _mm_loadu_ps(&shade[x]), fromColour, deltaColour));
+            if (x < width) {
+                unsigned char tail[16];
+                _mm_storeu_si128((__m128i*)tail, ShadeTexels(_mm_loadu_ps(&mix[x]), _mm_loadu_ps(&shade[x]), fromColour, deltaColour));
+                std::memcpy(dst + x * 4, tail, static_cast<size_t>(width - x) * 4);
+            }
+        }
+    });
+    return result;
+}
+
+// Coverage of a shape edge d texels inside it (negative outside), antialiased over one texel
+inline __m128 Coverage(__m128 inside, __m128 texelSize)
+{
+    return Clamp01(_mm_add_ps(_mm_div_ps(inside, texelSize), _mm_set1_ps(0.5f)));
+}
+
+inline __m128i SeedVector(unsigned int seed)
+{
+    return _mm_set1_epi32(static_cast<int>(seed));
+}
+
+} // namespace
+
+ImageData TextureGenerator::Tiles(int width, int height, const TileParams& params, ThreadPool& pool)
+{
+    int tilesX = std::max(1, params.tilesX);
+    int tilesY = std::max(1, params.tilesY);
+    float scaleX = static_cast<float>(tilesX) / width;
+    float scaleY = static_cast<float>(tilesY) / height;
+    float halfGrout = params.groutWidth * 0.5f;
+
+    return Generate(width, height, params.tile, params.grout, pool, [&](int y, float* mix, float* shade) {
+        float v = (y + 0.5f) * scaleY;
+        int tileRow = static_cast<int>(v);
+        float fy = v - tileRow;
+        float insideY = std::min(fy, 1.0f - fy) - halfGrout;
+        float offset = params.staggered && (tileRow & 1) ? 0.5f : 0.0f;
+
+        const __m128 texelSize = _mm_set1_ps(std::max(scaleX, scaleY));
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128i seed = SeedVector(params.seed);
+        const __m128i rowIndex = _mm_set1_epi32(tileRow);
+        for (int x = 0; x < width; x += 4) {
+            __m128 u = _mm_add_ps(_mm_mul_ps(Columns(x), _mm_set1_ps(scaleX)), _mm_set1_ps(offset));
+            __m128i column = _mm_cvttps_epi32(u);
+            __m128 fx = _mm_sub_ps(u, _mm_cvtepi32_ps(column));
+            // the staggered half tile past the right edge is the first tile again
+            column = _mm_sub_epi32(column, _mm_and_si128(_mm_cmpgt_epi32(column, _mm_set1_epi32(tilesX - 1)), _mm_set1_epi32(tilesX)));
+
+            __m128 insideX = _mm_sub_ps(_mm_min_ps(fx, _mm_sub_ps(one, fx)), _mm_set1_ps(halfGrout));
+            __m128 tile = Coverage(_mm_min_ps(insideX, _mm_set1_ps(insideY)), texelSize);
+            __m128 jitter = _mm_sub_ps(HashToUnit(Hash(column, rowIndex, seed)), _mm_set1_ps(0.5f));
+            __m128 tileShade = _mm_add_ps(one, _mm_mul_ps(jitter, _mm_set1_ps(2.0f * params.variation)));
+
+            _mm_storeu_ps(mix + x, _mm_sub_ps(one, tile));
+            _mm_storeu_ps(shade + x, Lerp(one, tileShade, tile));
+        }
+    });
+}
+
+ImageData TextureGenerator::Tiles(int width, int height, const TileParams& params)
+{
+    return Tiles(width, height, params, ThreadPool::Default());
+}
+
+ImageData TextureGenerator::Grill(int width, int height, const GrillParams& params, ThreadPool& pool)
+{
+    float scaleX = static_cast<float>(std::max(1, params.barsX)) / width;
+    float scaleY = static_cast<float>(std::max(1, params.barsY)) / height;
+    float halfWidth = std::max(params.barWidth * 0.5f, 1e-3f);
+
+    return Generate(width, height, params.background, params.bar, pool, [&](int y, float* mix, float* shade) {
+        float v = (y + 0.5f) * scaleY;
+        float dy = std::fabs(v - std::floor(v) - 0.5f);
+        float across = std::min(dy / halfWidth, 1.0f);
+
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 barHalfWidth = _mm_set1_ps(halfWidth);
+        const __m128 texelSize = _mm_set1_ps(std::max(scaleX, scaleY));
+        const __m128i seed = SeedVector(params.seed);
+        const __m128i rowIndex = _mm_set1_epi32(y);
+        // bars are lit like cylinders, brightest along their centre line
+        const __m128 horizontalCoverage = Coverage(_mm_set1_ps(halfWidth - dy), texelSize);
+        const __m128 horizontalLight = _mm_set1_ps(std::sqrt(1.0f - across * across));
+
+        for (int x = 0; x < width; x += 4) {
+            __m128 columns = Columns(x);
+            __m128 u = _mm_mul_ps(columns, _mm_set1_ps(scaleX));
+            __m128 fx = _mm_sub_ps(u, _mm_cvtepi32_ps(_mm_cvttps_epi32(u)));
+            __m128 dx = _mm_sub_ps(fx, half);
+            dx = _mm_max_ps(dx, _mm_sub_ps(_mm_setzero_ps(), dx));
+            __m128 verticalCoverage = Coverage(_mm_sub_ps(barHalfWidth, dx), texelSize);
+            __m128 p = _mm_min_ps(_mm_div_ps(dx, barHalfWidth), one);
+            __m128 verticalLight = _mm_sqrt_ps(_mm_sub_ps(one, _mm_mul_ps(p, p)));
+
+            __m128 bar = _mm_max_ps(verticalCoverage, horizontalCoverage);
+            // where the bars cross, the one lit more brightly is taken to be on top
+            __m128 light = _mm_max_ps(_mm_mul_ps(verticalLight, verticalCoverage), _mm_mul_ps(horizontalLight, horizontalCoverage));
+            __m128 speckle = _mm_sub_ps(HashToUnit(Hash(_mm_cvttps_epi32(columns), rowIndex, seed)), half);
+            __m128 barShade = _mm_mul_ps(_mm_add_ps(_mm_set1_ps(0.35f), _mm_mul_ps(light, _mm_set1_ps(0.65f))),
+                _mm_add_ps(one, _mm_mul_ps(speckle, _mm_set1_ps(2.0f * params.roughness))));
+
+            _mm_storeu_ps(mix + x, bar);
+            _mm_storeu_ps(shade + x, Lerp(one, barShade, bar));
+        }
+    });
+}
+
+ImageData TextureGenerator::Grill(int width, int height, const GrillParams& params)
+{
+    return Grill(width, height, params, ThreadPool::Default());
+}
+
+ImageData TextureGenerator::Noise(int width, int height, const NoiseParams& params, ThreadPool& pool)
+{
+    int frequency = std::max(1, params.frequency);
+    int octaves = std::max(1, std::min(params.octaves, 16));
+    float totalAmplitude = 0.0f;
+    for (int octave = 0; octave < octaves; ++octave)
+        totalAmplitude += std::pow(params.gain, static_cast<float>(octave));
+    float normalise = 1.0f / totalAmplitude;
+
+    return Generate(width, height, params.low, params.high, pool, [&](int y, float* mix, float* shade) {
+        const __m128 one = _mm_set1_ps(1.0f);
+        for (int x = 0; x < width; x += 4) {
+            __m128 columns = Columns(x);
+            __m128 sum = _mm_setzero_ps();
+            float amplitude = 1.0f;
+            int period = frequency;
+            for (int octave = 0; octave < octaves; ++octave, period *= 2, amplitude *= params.gain) {
+                __m128 nx = _mm_mul_ps(columns, _mm_set1_ps(static_cast<float>(period) / width));
+                float ny = (y + 0.5f) * period / height;
+                // a different lattice per octave, so octaves do not line up
+                __m128i seed = SeedVector(params.seed + octave * 0x9E3779B9u);
+                __m128 n;
+                switch (params.type) {
+                case NoiseType::Value:
+                    n = ValueNoise(nx, ny, period, seed);
+                    break;
+                case NoiseType::Simplex:
+                    n = SimplexNoise(nx, ny, seed);
+                    break;
+                default:
+                    n = PerlinNoise(nx, ny, period, seed);
+                    break;
+                }
+                sum = _mm_add_ps(sum, _mm_mul_ps(n, _mm_set1_ps(amplitude)));
+            }
+            __m128 t = _mm_add_ps(_mm_mul_ps(sum, _mm_set1_ps(0.5f * normalise)), _mm_set1_ps(0.5f));
+            _mm_storeu_ps(mix + x, Clamp01(t));
+            _mm_storeu_ps(shade + x, one);
+        }
+    });
+}
+
+ImageData TextureGenerator::Noise(int width, int height, const NoiseParams& params)
+{
+    return Noise(width, height, params, ThreadPool::Default());
+}
+
+ImageData TextureGenerator::Gradient(int width, int height, const GradientParams& params, ThreadPool& pool)
+{
+    float radians = params.angleDegrees * 3.14159265f / 180.0f;
+    float dirX = std::cos(radians);
+    float dirY = std::sin(radians);
+    // stretch the projection so the ramp runs exactly corner to corner
+    float low = std::min(0.0f, dirX) + std::min(0.0f, dirY);
+    float high = std::max(0.0f, dirX) + std::max(0.0f, dirY);
+    float range = std::max(high - low, 1e-6f);
+
+    return Generate(width, height, params.from, params.to, pool, [&](int y, float* mix, float* shade) {
+        float v = (y + 0.5f) / height;
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 invWidth = _mm_set1_ps(1.0f / width);
+        for (int x = 0; x < width; x += 4) {
+            __m128 u = _mm_mul_ps(Columns(x), invWidth);
+            __m128 t;
+            if (params.type == GradientType::Radial) {
+                // 0 in the centre, 1 in the corners
+                __m128 du = _mm_sub_ps(u, _mm_set1_ps(0.5f));
+                float dv = v - 0.5f;
+                __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(du, du), _mm_set1_ps(dv * dv)));
+                t = _mm_mul_ps(distance, _mm_set1_ps(1.41421356f));
+            } else {
+                __m128 projection = _mm_add_ps(_mm_mul_ps(u, _mm_set1_ps(dirX)), _mm_set1_ps(v * dirY));
+                t = _mm_mul_ps(_mm_sub_ps(projection, _mm_set1_ps(low)), _mm_set1_ps(1.0f / range));
+            }
+            _mm_storeu_ps(mix + x, Clamp01(t));
+            _mm_storeu_ps(shade + x, one);
+        }
+    });
+}
+
+ImageData TextureGenerator::Gradient(int width, int height, const GradientParams& params)
+{
+    return Gradient(width, height, params, ThreadPool::Default());
+}
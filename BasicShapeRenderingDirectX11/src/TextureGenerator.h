@@ -0,0 +1,80 @@
+#pragma once
+#include "Image.h"
+
+class ThreadPool;
+
+// Procedural RGBA8 textures computed on the CPU instead of loaded from disk. Bands of rows
+// are spread across a ThreadPool and each row is evaluated four texels at a time with SSE2.
+// Output depends only on the parameters (seed included), never on the thread count, so a
+// scene can regenerate exactly the same texture set on any machine.
+class TextureGenerator
+{
+public:
+	struct Colour {
+		unsigned char r, g, b, a;
+	};
+
+	struct TileParams {
+		int tilesX = 8;
+		int tilesY = 8;
+		float groutWidth = 0.06f;	// fraction of a tile
+		float variation = 0.2f;		// random brightness spread between tiles
+		bool staggered = false;		// offset every other row by half a tile, like bricks
+		Colour tile = { 176, 122, 74, 255 };
+		Colour grout = { 60, 52, 46, 255 };
+		unsigned int seed = 0;
+	};
+
+	// Round bars crossing at right angles; the gaps take the background colour, so a zero
+	// background alpha leaves see-through holes
+	struct GrillParams {
+		int barsX = 16;
+		int barsY = 16;
+		float barWidth = 0.35f;		// fraction of the spacing between bars
+		float roughness = 0.15f;	// random brightness speckle on the metal
+		Colour bar = { 150, 156, 164, 255 };
+		Colour background = { 20, 20, 22, 255 };
+		unsigned int seed = 0;
+	};
+
+	enum class NoiseType
+	{
+		Value,
+		Perlin,
+		Simplex
+	};
+
+	// Fractal sum of octaves, each at twice the frequency of the last. Value and Perlin noise
+	// wrap at the image edges, so they tile seamlessly under a WRAP sampler.
+	struct NoiseParams {
+		NoiseType type = NoiseType::Perlin;
+		int frequency = 8;			// lattice cells across the image in the first octave
+		int octaves = 4;
+		float gain = 0.5f;			// amplitude of each octave relative to the one before
+		Colour low = { 0, 0, 0, 255 };
+		Colour high = { 255, 255, 255, 255 };
+		unsigned int seed = 0;
+	};
+
+	enum class GradientType
+	{
+		Linear,
+		Radial
+	};
+
+	struct GradientParams {
+		GradientType type = GradientType::Linear;
+		float angleDegrees = 90.0f;		// linear only, 0 runs left to right, 90 top to bottom
+		Colour from = { 0, 0, 0, 255 };
+		Colour to = { 255, 255, 255, 255 };
+	};
+
+	static ImageData Tiles(int width, int height, const TileParams& params, ThreadPool& pool);
+	static ImageData Tiles(int width, int height, const TileParams& params);
+	static ImageData Grill(int width, int height, const GrillParams& params, ThreadPool& pool);
+	static ImageData Grill(int width, int height, const GrillParams& params);
+	static ImageData Noise(int width, int height, const NoiseParams& params, ThreadPool& pool);
+	static ImageData Noise(int width, int height, const NoiseParams& params);
+	static ImageData Gradient(int width, int height, const GradientParams& params, ThreadPool& pool);
+	static ImageData Gradient(int width, int height, const GradientParams& params);
+};
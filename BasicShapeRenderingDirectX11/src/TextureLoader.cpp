@@ -0,0 +1,108 @@
+#include "TextureLoader.h"
+#include "AsyncFileReader.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <exception>
+#include <iostream>
+
+struct TextureHandle::Entry {
+    std::string path;
+    TextureSettings settings;
+    ID3D11ShaderResourceView* placeholder = nullptr;
+    std::unique_ptr<Texture> texture;
+    std::future<std::vector<ImageData>> decode;
+    bool failed = false;
+};
+
+ID3D11ShaderResourceView* TextureHandle::GetTextureView() const
+{
+    if (!mEntry)
+        return nullptr;
+    return mEntry->texture ? mEntry->texture->GetTextureView() : mEntry->placeholder;
+}
+
+bool TextureHandle::IsReady() const
+{
+    return mEntry && mEntry->texture != nullptr;
+}
+
+TextureLoader::TextureLoader(ID3D11Device* dev, ThreadPool& pool, AsyncFileReader& reader)
+    : mDevice(dev), mPool(pool), mReader(reader)
+{
+    mPlaceholder.reset(new Texture(std::vector<ImageData>{ Texture::MakePlaceholder() }, dev));
+}
+
+TextureLoader::TextureLoader(ID3D11Device* dev, ThreadPool& pool)
+    : TextureLoader(dev, pool, AsyncFileReader::Default())
+{
+}
+
+TextureLoader::TextureLoader(ID3D11Device* dev)
+    : TextureLoader(dev, ThreadPool::Default())
+{
+}
+
+TextureLoader::~TextureLoader()
+{
+    // outstanding decodes reference nothing owned by the loader, but wait so
+    // no worker is still running once the device goes away
+    for (auto& entry : mPending)
+        entry->decode.wait();
+}
+
+TextureHandle TextureLoader::LoadAsync(const std::string& path, const TextureSettings& settings)
+{
+    auto entry = std::make_shared<TextureHandle::Entry>();
+    entry->path = path;
+    entry->settings = settings;
+    entry->placeholder = mPlaceholder->GetTextureView();
+    StartDecode(*entry);
+
+    mPending.push_back(entry);
+    return TextureHandle(entry);
+}
+
+void TextureLoader::StartDecode(TextureHandle::Entry& entry)
+{
+    entry.decode = Texture::LoadLevelsAsync(entry.path, entry.settings, mCache, mReader, mPool);
+}
+
+size_t TextureLoader::FlushUploads()
+{
+    size_t uploaded = 0;
+    for (size_t i = 0; i < mPending.size();) {
+        TextureHandle::Entry& entry = *mPending[i];
+        if (entry.decode.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++i;
+            continue;
+        }
+
+        Upload(entry);
+        ++uploaded;
+        mPending[i] = std::move(mPending.back());
+        mPending.pop_back();
+    }
+    return uploaded;
+}
+
+void TextureLoader::WaitAll()
+{
+    for (auto& entry : mPending)
+        entry->decode.wait();
+    FlushUploads();
+}
+
+void TextureLoader::Upload(TextureHandle::Entry& entry)
+{
+    try {
+        std::vector<ImageData> levels = entry.decode.get();
+        entry.texture.reset(new Texture(levels, mDevice));
+        entry.failed = false;
+    }
+    catch (const std::exception& e) {
+        // keep showing the placeholder rather than taking the whole frame down
+        std::cerr << "Failed to load texture " << entry.path << ": " << e.what() << std::endl;
+        entry.failed = true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+#include <d3d11.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Texture.h"
+
+class AsyncFileReader;
+class TextureCache;
+class ThreadPool;
+
+// Shared view of a texture that may still be decoding. Until the loader has uploaded it,
+// GetTextureView() returns the loader's placeholder so it can be bound unconditionally.
+class TextureHandle
+{
+public:
+	TextureHandle() = default;
+
+	ID3D11ShaderResourceView* GetTextureView() const;
+	bool IsReady() const;
+
+private:
+	friend class TextureLoader;
+	struct Entry;
+	explicit TextureHandle(std::shared_ptr<Entry> entry) : mEntry(std::move(entry)) {}
+
+	std::shared_ptr<Entry> mEntry;
+};
+
+// Reads files through an AsyncFileReader, decodes them on worker threads as each read
+// completes and creates their GPU resources in batches on the render thread, so disk
+// latency overlaps decoding instead of adding to it. LoadAsync() may be called from
+// anywhere, FlushUploads() only from the thread that owns the device context.
+class TextureLoader
+{
+public:
+	TextureLoader(ID3D11Device* dev, ThreadPool& pool, AsyncFileReader& reader);
+	TextureLoader(ID3D11Device* dev, ThreadPool& pool);
+	explicit TextureLoader(ID3D11Device* dev);
+	~TextureLoader();
+
+	// Loads go through the cooked texture cache when one is set. Hot reload is
+	// TextureStreamer's job; textures that need it should be streamed.
+	void SetCache(TextureCache* cache) { mCache = cache; }
+
+	TextureHandle LoadAsync(const std::string& path, const TextureSettings& settings = TextureSettings());
+
+	// Uploads every decode that has finished since the last call; returns how many were uploaded
+	size_t FlushUploads();
+	// Blocks until all outstanding loads are decoded and uploaded
+	void WaitAll();
+	size_t GetPendingCount() const { return mPending.size(); }
+
+private:
+	void StartDecode(TextureHandle::Entry& entry);
+	void Upload(TextureHandle::Entry& entry);
+
+private:
+	ID3D11Device* mDevice;
+	ThreadPool& mPool;
+	AsyncFileReader& mReader;
+	TextureCache* mCache = nullptr;
+	std::unique_ptr<Texture> mPlaceholder;
+	std::vector<std::shared_ptr<TextureHandle::Entry>> mPending;
+};
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "TextureRegistry.h"
+#include "MappedFile.h"
+#include "TextureCache.h"
+
+#include <iostream>
+
+struct TextureRef::Entry {
+    uint64_t contentKey = 0;
+    size_t bytes = 0;
+    std::unique_ptr<Texture> texture;
+};
+
+ID3D11ShaderResourceView* TextureRef::GetTextureView() const
+{
+    return mEntry ? mEntry->texture->GetTextureView() : nullptr;
+}
+
+uint64_t TextureRef::GetContentKey() const
+{
+    return mEntry ? mEntry->contentKey : 0;
+}
+
+TextureRegistry::TextureRegistry(ID3D11Device* dev, TextureCache* cache)
+    : mDevice(dev), mCache(cache)
+{
+}
+
+uint64_t TextureRegistry::GetPathKey(TextureId id, const TextureSettings& settings)
+{
+    // the same file cooked with different settings is a different texture
+    return HashCombine(id, TextureCache::ComputeKey(nullptr, 0, settings));
+}
+
+TextureRef TextureRegistry::Find(TextureId id, const TextureSettings& settings) const
+{
+    auto path = mPaths.find(GetPathKey(id, settings));
+    if (path == mPaths.end())
+        return TextureRef();
+    auto content = mContents.find(path->second);
+    if (content == mContents.end())
+        return TextureRef();
+    return TextureRef(content->second.lock());
+}
+
+TextureRef TextureRegistry::Acquire(const std::string& path, const TextureSettings& settings)
+{
+    TextureId id = HashPath(path.c_str());
+    TextureRef resident = Find(id, settings);
+    if (resident)
+        return resident;
+
+    // the content hash needs the bytes anyway, a miss decodes from the same mapping
+    MappedFile file(path);
+    uint64_t contentKey = TextureCache::ComputeKey(file.GetData(), file.GetSize(), settings);
+    mPaths[GetPathKey(id, settings)] = contentKey;
+
+    std::weak_ptr<TextureRef::Entry>& slot = mContents[contentKey];
+    if (std::shared_ptr<TextureRef::Entry> shared = slot.lock())
+        return TextureRef(shared);
+
+    std::vector<ImageData> levels;
+    if (!mCache || !mCache->TryLoad(contentKey, levels)) {
+        levels = Texture::BuildLevels(Texture::DecodeImage(file.GetData(), file.GetSize(), settings), settings);
+        if (mCache && !mCache->Store(contentKey, levels))
+            std::cerr << "Failed to write texture cache entry for " << path << std::endl;
+    }
+
+    auto entry = std::make_shared<TextureRef::Entry>();
+    entry->contentKey = contentKey;
+    for (const ImageData& level : levels)
+        entry->bytes += level.data.size();
+    entry->texture.reset(new Texture(levels, mDevice));
+    slot = entry;
+    return TextureRef(entry);
+}
+
+void TextureRegistry::Collect()
+{
+    for (auto it = mContents.begin(); it != mContents.end();) {
+        if (it->second.expired())
+            it = mContents.erase(it);
+        else
+            ++it;
+    }
+    for (auto it = mPaths.begin(); it != mPaths.end();) {
+        if (mContents.find(it->second) == mContents.end())
+            it = mPaths.erase(it);
+        else
+            ++it;
+    }
+}
+
+size_t TextureRegistry::GetResidentCount() const
+{
+    size_t count = 0;
+    for (const auto& content : mContents) {
+        if (!content.second.expired())
+            ++count;
+    }
+    return count;
+}
+
+size_t TextureRegistry::GetResidentBytes() const
+{
+    size_t bytes = 0;
+    for (const auto& content : mContents) {
+        if (std::shared_ptr<TextureRef::Entry> entry = content.second.lock())
+            bytes += entry->bytes;
+    }
+    return bytes;
+}
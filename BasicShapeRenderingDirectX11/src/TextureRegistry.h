@@ -0,0 +1,64 @@
+#pragma once
+#include <d3d11.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "Hash.h"
+#include "Texture.h"
+
+class TextureCache;
+
+// Interned path id, see HashPath
+using TextureId = uint64_t;
+
+// Counted reference to a texture owned by a TextureRegistry. The GPU resources are
+// released when the last reference to them goes away.
+class TextureRef
+{
+public:
+	TextureRef() = default;
+
+	ID3D11ShaderResourceView* GetTextureView() const;
+	// Hash of the source bytes and settings, equal for every path with the same content
+	uint64_t GetContentKey() const;
+	long GetRefCount() const { return mEntry.use_count(); }
+	explicit operator bool() const { return mEntry != nullptr; }
+
+private:
+	friend class TextureRegistry;
+	struct Entry;
+	explicit TextureRef(std::shared_ptr<Entry> entry) : mEntry(std::move(entry)) {}
+
+	std::shared_ptr<Entry> mEntry;
+};
+
+// Hands out one GPU texture per distinct content. Repeat requests for a path return the
+// resident texture without touching the file; a new path whose bytes and settings match
+// a resident texture shares it. Use from the render thread.
+class TextureRegistry
+{
+public:
+	explicit TextureRegistry(ID3D11Device* dev, TextureCache* cache = nullptr);
+
+	TextureRef Acquire(const std::string& path, const TextureSettings& settings = TextureSettings());
+	// Resident texture for an id from MakeId, or an empty reference
+	TextureRef Find(TextureId id, const TextureSettings& settings = TextureSettings()) const;
+
+	static constexpr TextureId MakeId(const char* path) { return HashPath(path); }
+
+	// Forgets paths and contents whose textures are no longer referenced
+	void Collect();
+	size_t GetResidentCount() const;
+	size_t GetResidentBytes() const;
+
+private:
+	static uint64_t GetPathKey(TextureId id, const TextureSettings& settings);
+
+private:
+	ID3D11Device* mDevice;
+	TextureCache* mCache;
+	// path id (with settings) -> content key
+	std::unordered_map<uint64_t, uint64_t> mPaths;
+	std::unordered_map<uint64_t, std::weak_ptr<TextureRef::Entry>> mContents;
+};
@@ -0,0 +1,75 @@
+#pragma once
+#include "Image.h"
+
+enum class TextureCompression
+{
+	None,
+	Auto,	// BC1 for opaque images, BC3 when any texel has alpha
+	BC1,
+	BC3,
+	BC7
+};
+
+enum class CompressionQuality
+{
+	Fast,	// bounding-box endpoints
+	High	// PCA endpoints plus least-squares refinement
+};
+
+// Texture memory limits for a deployment profile
+enum class TextureQualityTier
+{
+	Full,
+	High,
+	Medium,
+	Low
+};
+
+// Images over either limit are resampled down before mips are built, so the memory a
+// texture takes is known from the profile rather than from the source asset. 0 means no limit.
+struct TextureQuality {
+	int maxDimension = 0;	// longest side of the top level
+	size_t maxBytes = 0;	// whole uploaded mip chain, after block compression
+	ResizeFilter filter = ResizeFilter::Lanczos3;
+
+	// Byte budgets fit an RGBA8 texture of maxDimension with a full mip chain
+	static TextureQuality FromTier(TextureQualityTier tier)
+	{
+		TextureQuality quality;
+		switch (tier) {
+		case TextureQualityTier::High:
+			quality.maxDimension = 2048;
+			quality.maxBytes = 22u << 20;
+			break;
+		case TextureQualityTier::Medium:
+			quality.maxDimension = 1024;
+			quality.maxBytes = 6u << 20;
+			break;
+		case TextureQualityTier::Low:
+			quality.maxDimension = 512;
+			quality.maxBytes = 1536u << 10;
+			break;
+		default:
+			break;
+		}
+		return quality;
+	}
+};
+
+// How a source image is turned into the levels that get uploaded
+struct TextureSettings {
+	MipFilter mipFilter = MipFilter::Box;
+	TextureCompression compression = TextureCompression::None;
+	CompressionQuality compressionQuality = CompressionQuality::Fast;
+	// Grey and grey+alpha files load as R8 and RG8, so shaders read them from .r and .rg.
+	// Set this to expand them to RGBA8 instead.
+	bool forceRGBA = false;
+	bool premultiplyAlpha = false;
+	// 2, 4 or 8 loads JPEGs at that fraction of their size, for low quality tiers and
+	// distant LODs. The reduced IDCT skips most of the decode work rather than throwing
+	// pixels away afterwards. Other formats ignore it.
+	int decodeScale = 1;
+	// Applies per texture, and per slice for texture arrays. JPEGs larger than twice
+	// maxDimension also pick a decodeScale automatically.
+	TextureQuality quality;
+};
@@ -0,0 +1,450 @@
+#include "TextureStreamer.h"
+#include "AsyncFileReader.h"
+#include "Camera.h"
+#include "FileWatcher.h"
+#include "Texture.h"
+#include "TextureArray.h"
+#include "TextureCache.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// levels at or below this size are uploaded as soon as a texture is decoded and never evicted
+const int kTailSize = 64;
+
+bool SameShape(const std::vector<ImageData>& a, const std::vector<ImageData>& b)
+{
+    return a.size() == b.size() && a[0].width == b[0].width && a[0].height == b[0].height && a[0].format == b[0].format;
+}
+
+} // namespace
+
+StreamedTexture::~StreamedTexture()
+{
+    if (mTextureView)
+        mTextureView->Release();
+    if (mTexture)
+        mTexture->Release();
+}
+
+ID3D11ShaderResourceView* StreamedTexture::GetTextureView() const
+{
+    return mTextureView ? mTextureView : mPlaceholder;
+}
+
+void StreamedTexture::SetBounds(const glm::vec3& center, float radius)
+{
+    mCenter = center;
+    mRadius = radius;
+}
+
+size_t StreamedTexture::GetResidentBytes() const
+{
+    return mTexture ? GetBytesFrom(mResidentMip) : 0;
+}
+
+size_t StreamedTexture::GetBytesFrom(int mip) const
+{
+    size_t bytes = 0;
+    for (int i = mip; i < GetLevelCount(); ++i)
+        bytes += GetLevelBytes(i);
+    return bytes;
+}
+
+size_t StreamedTexture::GetLevelBytes(int mip) const
+{
+    size_t bytes = 0;
+    for (const std::vector<ImageData>& slice : mSlices)
+        bytes += slice[mip].data.size();
+    return bytes;
+}
+
+TextureStreamer::TextureStreamer(ID3D11Device* dev, size_t budgetBytes, ThreadPool& pool, AsyncFileReader& reader)
+    : mDevice(dev), mPool(pool), mReader(reader), mBudgetBytes(budgetBytes)
+{
+    ImageData placeholder = Texture::MakePlaceholder();
+    mPlaceholder.reset(new Texture(std::vector<ImageData>{ placeholder }, dev));
+    // slices past the first clamp to it, so one slice serves arrays of any size
+    mPlaceholderArray.reset(new TextureArray(std::vector<std::vector<ImageData>>{ { placeholder } }, dev));
+}
+
+TextureStreamer::TextureStreamer(ID3D11Device* dev, size_t budgetBytes, ThreadPool& pool)
+    : TextureStreamer(dev, budgetBytes, pool, AsyncFileReader::Default())
+{
+}
+
+TextureStreamer::TextureStreamer(ID3D11Device* dev, size_t budgetBytes)
+    : TextureStreamer(dev, budgetBytes, ThreadPool::Default())
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    for (auto& texture : mTextures) {
+        for (auto& decode : texture->mDecodes) {
+            if (decode.valid())
+                decode.wait();
+        }
+    }
+}
+
+std::shared_ptr<StreamedTexture> TextureStreamer::Load(const std::string& path, const TextureSettings& settings, TextureCache* cache)
+{
+    return Add({ path }, false, settings, cache);
+}
+
+std::shared_ptr<StreamedTexture> TextureStreamer::LoadArray(const std::vector<std::string>& paths, const TextureSettings& settings, TextureCache* cache)
+{
+    if (paths.empty())
+        throw std::runtime_error("Texture array needs at least one slice");
+    return Add(paths, true, settings, cache);
+}
+
+void TextureStreamer::EnableHotReload()
+{
+    if (mWatcher)
+        return;
+    mWatcher.reset(new FileWatcher());
+    for (const auto& texture : mTextures)
+        Watch(*texture);
+}
+
+std::shared_ptr<StreamedTexture> TextureStreamer::Add(const std::vector<std::string>& paths, bool array, const TextureSettings& settings, TextureCache* cache)
+{
+    auto texture = std::make_shared<StreamedTexture>();
+    texture->mPaths = paths;
+    texture->mArray = array;
+    texture->mSettings = settings;
+    texture->mCache = cache;
+    texture->mPlaceholder = array ? mPlaceholderArray->GetTextureView() : mPlaceholder->GetTextureView();
+    texture->mDecodes.resize(paths.size());
+    for (size_t slice = 0; slice < paths.size(); ++slice)
+        Decode(*texture, slice);
+
+    if (mWatcher)
+        Watch(*texture);
+    mTextures.push_back(texture);
+    return texture;
+}
+
+void TextureStreamer::Decode(StreamedTexture& texture, size_t slice)
+{
+    // all slices are read as one batch, each decodes on its own worker as its read completes
+    texture.mDecodes[slice] = Texture::LoadLevelsAsync(texture.mPaths[slice], texture.mSettings, texture.mCache, mReader, mPool);
+}
+
+void TextureStreamer::Watch(const StreamedTexture& texture)
+{
+    for (const std::string& path : texture.mPaths) {
+        try {
+            mWatcher->Watch(path);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Cannot watch " << path << " for changes: " << e.what() << std::endl;
+        }
+    }
+}
+
+void TextureStreamer::ReloadChanged()
+{
+    for (const std::string& path : mWatcher->PollChanges()) {
+        for (auto& texture : mTextures) {
+            for (size_t slice = 0; slice < texture->mPaths.size(); ++slice) {
+                if (texture->mPaths[slice] == path && !texture->mDecodes[slice].valid())
+                    Decode(*texture, slice);
+            }
+        }
+    }
+}
+
+size_t TextureStreamer::GetResidentBytes() const
+{
+    size_t bytes = 0;
+    for (const auto& texture : mTextures)
+        bytes += texture->GetResidentBytes();
+    return bytes;
+}
+
+void TextureStreamer::Update(ID3D11DeviceContext* devcon, const Camera& camera, float viewportHeight)
+{
+    glm::mat4 view = camera.GetCameraView();
+    glm::mat4 projection = camera.GetCameraProjection();
+
+    // frustum planes (inward facing) from the combined clip matrix
+    glm::mat4 clip = projection * view;
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; ++i)
+        rows[i] = glm::vec4(clip[0][i], clip[1][i], clip[2][i], clip[3][i]);
+    glm::vec4 planes[6] = {
+        rows[3] + rows[0], rows[3] - rows[0],
+        rows[3] + rows[1], rows[3] - rows[1],
+        rows[3] + rows[2], rows[3] - rows[2]
+    };
+    for (glm::vec4& plane : planes)
+        plane /= glm::length(glm::vec3(plane));
+
+    if (mWatcher)
+        ReloadChanged();
+
+    for (auto& texture : mTextures) {
+        // an array waits for all of its slices
+        bool decoding = false, ready = true;
+        for (auto& decode : texture->mDecodes) {
+            if (!decode.valid())
+                continue;
+            decoding = true;
+            ready = ready && decode.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }
+        if (decoding && ready)
+            FinishLoad(*texture);
+        if (texture->mTexture)
+            ComputeDesiredMip(*texture, view, projection, planes, viewportHeight);
+    }
+
+    EnforceBudget();
+
+    // evictions are free, loads are limited to one level per texture and mUploadLimit bytes per frame
+    size_t uploaded = 0;
+    for (auto& texture : mTextures) {
+        if (!texture->mTexture)
+            continue;
+        if (texture->mDesiredMip > texture->mResidentMip) {
+            MakeResident(devcon, *texture, texture->mDesiredMip);
+        }
+        else if (texture->mDesiredMip < texture->mResidentMip) {
+            size_t levelBytes = texture->GetLevelBytes(texture->mResidentMip - 1);
+            if (uploaded > 0 && uploaded + levelBytes > mUploadLimit)
+                continue;
+            MakeResident(devcon, *texture, texture->mResidentMip - 1);
+            uploaded += levelBytes;
+        }
+    }
+}
+
+void TextureStreamer::FinishLoad(StreamedTexture& texture)
+{
+    // take every finished slice before touching the old levels, so a failed reload keeps them
+    std::vector<std::vector<ImageData>> decoded(texture.mDecodes.size());
+    bool failed = false;
+    for (size_t slice = 0; slice < decoded.size(); ++slice) {
+        if (!texture.mDecodes[slice].valid())
+            continue;
+        try {
+            decoded[slice] = texture.mDecodes[slice].get();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Failed to load texture " << texture.mPaths[slice] << ": " << e.what() << std::endl;
+            failed = true;
+        }
+    }
+    if (failed)
+        return;
+
+    // slices that were not decoded again keep their levels, and all have to match the first
+    auto levelsOf = [&](size_t slice) -> const std::vector<ImageData>& {
+        return decoded[slice].empty() ? texture.mSlices[slice] : decoded[slice];
+    };
+    for (size_t slice = 1; slice < decoded.size(); ++slice) {
+        if (!SameShape(levelsOf(slice), levelsOf(0))) {
+            std::cerr << "Texture array slice " << texture.mPaths[slice] << " does not match the size, mip count and format of "
+                << texture.mPaths[0] << std::endl;
+            return;
+        }
+    }
+    texture.mSlices.resize(decoded.size());
+    for (size_t slice = 0; slice < decoded.size(); ++slice) {
+        if (!decoded[slice].empty())
+            texture.mSlices[slice] = std::move(decoded[slice]);
+    }
+
+    // the tail is the first level that fits kTailSize; block-compressed tops must stay 4-aligned
+    bool compressed = IsBlockCompressed(texture.GetLevel(0).format);
+    int tail = 0;
+    for (int i = 0; i < texture.GetLevelCount(); ++i) {
+        const ImageData& level = texture.GetLevel(i);
+        if (compressed && (level.width % 4 != 0 || level.height % 4 != 0))
+            break;
+        tail = i;
+        if (std::max(level.width, level.height) <= kTailSize)
+            break;
+    }
+
+    // subresource index is slice * MipLevels + mip
+    UINT mipLevels = static_cast<UINT>(texture.GetLevelCount() - tail);
+    std::vector<D3D11_SUBRESOURCE_DATA> initData(mipLevels * texture.mSlices.size());
+    for (size_t slice = 0; slice < texture.mSlices.size(); ++slice) {
+        for (UINT i = 0; i < mipLevels; ++i) {
+            const ImageData& level = texture.mSlices[slice][tail + i];
+            D3D11_SUBRESOURCE_DATA& data = initData[slice * mipLevels + i];
+            data.pSysMem = level.data.data();
+            data.SysMemPitch = static_cast<UINT>(GetRowPitch(level.format, level.width));
+            data.SysMemSlicePitch = 0;
+        }
+    }
+
+    D3D11_TEXTURE2D_DESC desc;
+    ZeroMemory(&desc, sizeof(desc));
+    desc.Width = texture.GetLevel(tail).width;
+    desc.Height = texture.GetLevel(tail).height;
+    desc.MipLevels = mipLevels;
+    desc.ArraySize = static_cast<UINT>(texture.mSlices.size());
+    desc.Format = Texture::GetDxgiFormat(texture.GetLevel(0).format);
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    ID3D11Texture2D* resource = nullptr;
+    HRESULT hr = mDevice->CreateTexture2D(&desc, initData.data(), &resource);
+    if (FAILED(hr)) {
+        throw std::runtime_error("Failed to create texture");
+    }
+    ID3D11ShaderResourceView* view = nullptr;
+    if (!CreateView(texture, resource, &view)) {
+        resource->Release();
+        throw std::runtime_error("Failed to create shader resource view");
+    }
+
+    // a reload starts again from the tail, the old texture is drawn until now
+    if (texture.mTextureView)
+        texture.mTextureView->Release();
+    if (texture.mTexture)
+        texture.mTexture->Release();
+    texture.mTexture = resource;
+    texture.mTextureView = view;
+    texture.mTailMip = tail;
+    texture.mDesiredMip = tail;
+    texture.mResidentMip = tail;
+}
+
+bool TextureStreamer::CreateView(StreamedTexture& texture, ID3D11Texture2D* resource, ID3D11ShaderResourceView** view)
+{
+    if (!texture.mArray)
+        return SUCCEEDED(mDevice->CreateShaderResourceView(resource, nullptr, view));
+
+    D3D11_TEXTURE2D_DESC desc;
+    resource->GetDesc(&desc);
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+    ZeroMemory(&srvDesc, sizeof(srvDesc));
+    srvDesc.Format = desc.Format;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+    srvDesc.Texture2DArray.MostDetailedMip = 0;
+    srvDesc.Texture2DArray.MipLevels = desc.MipLevels;
+    srvDesc.Texture2DArray.FirstArraySlice = 0;
+    srvDesc.Texture2DArray.ArraySize = desc.ArraySize;
+    return SUCCEEDED(mDevice->CreateShaderResourceView(resource, &srvDesc, view));
+}
+
+void TextureStreamer::ComputeDesiredMip(StreamedTexture& texture, const glm::mat4& view, const glm::mat4& projection, const glm::vec4 planes[6], float viewportHeight)
+{
+    bool visible = true;
+    for (int i = 0; i < 6; ++i) {
+        if (glm::dot(glm::vec3(planes[i]), texture.mCenter) + planes[i].w < -texture.mRadius) {
+            visible = false;
+            break;
+        }
+    }
+
+    glm::vec3 viewCenter = glm::vec3(view * glm::vec4(texture.mCenter, 1.0f));
+    float distance = std::max(-viewCenter.z - texture.mRadius, 1e-3f);
+
+    // projected diameter in pixels, assuming the texture spans the bounds once
+    float pixels = texture.mRadius * projection[1][1] / distance * viewportHeight;
+    texture.mScreenCoverage = visible ? pixels : 0.0f;
+
+    if (!visible) {
+        texture.mDesiredMip = texture.mTailMip;
+        return;
+    }
+    float texels = static_cast<float>(std::max(texture.GetLevel(0).width, texture.GetLevel(0).height));
+    int mip = pixels > 0.0f ? static_cast<int>(std::floor(std::log2(texels / pixels))) : texture.mTailMip;
+    texture.mDesiredMip = std::min(texture.mTailMip, std::max(0, mip));
+}
+
+void TextureStreamer::EnforceBudget()
+{
+    size_t total = 0;
+    for (const auto& texture : mTextures) {
+        if (texture->mTexture)
+            total += texture->GetBytesFrom(texture->mDesiredMip);
+    }
+
+    // drop one top level at a time from whichever texture covers the fewest pixels per texel
+    while (total > mBudgetBytes) {
+        StreamedTexture* victim = nullptr;
+        float lowestPriority = 0.0f;
+        for (auto& texture : mTextures) {
+            if (!texture->mTexture || texture->mDesiredMip >= texture->mTailMip)
+                continue;
+            const ImageData& top = texture->GetLevel(texture->mDesiredMip);
+            float priority = texture->mScreenCoverage / static_cast<float>(std::max(top.width, top.height));
+            if (!victim || priority < lowestPriority) {
+                victim = texture.get();
+                lowestPriority = priority;
+            }
+        }
+        if (!victim)
+            break;
+
+        total -= victim->GetLevelBytes(victim->mDesiredMip);
+        ++victim->mDesiredMip;
+    }
+}
+
+void TextureStreamer::MakeResident(ID3D11DeviceContext* devcon, StreamedTexture& texture, int firstMip)
+{
+    const ImageData& top = texture.GetLevel(firstMip);
+
+    D3D11_TEXTURE2D_DESC desc;
+    ZeroMemory(&desc, sizeof(desc));
+    desc.Width = top.width;
+    desc.Height = top.height;
+    desc.MipLevels = static_cast<UINT>(texture.GetLevelCount() - firstMip);
+    desc.ArraySize = static_cast<UINT>(texture.mSlices.size());
+    desc.Format = Texture::GetDxgiFormat(top.format);
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    ID3D11Texture2D* resized = nullptr;
+    HRESULT hr = mDevice->CreateTexture2D(&desc, nullptr, &resized);
+    if (FAILED(hr)) {
+        std::cerr << "Failed to resize streamed texture " << texture.mPaths[0] << std::endl;
+        return;
+    }
+
+    // levels that are already on the GPU are copied there, only new ones come from the CPU
+    UINT residentLevels = static_cast<UINT>(texture.GetLevelCount() - texture.mResidentMip);
+    for (size_t slice = 0; slice < texture.mSlices.size(); ++slice) {
+        for (int mip = firstMip; mip < texture.GetLevelCount(); ++mip) {
+            UINT subresource = static_cast<UINT>(slice * desc.MipLevels + mip - firstMip);
+            if (mip >= texture.mResidentMip) {
+                UINT source = static_cast<UINT>(slice * residentLevels + mip - texture.mResidentMip);
+                devcon->CopySubresourceRegion(resized, subresource, 0, 0, 0, texture.mTexture, source, nullptr);
+            }
+            else {
+                const ImageData& level = texture.mSlices[slice][mip];
+                devcon->UpdateSubresource(resized, subresource, nullptr, level.data.data(), static_cast<UINT>(GetRowPitch(level.format, level.width)), 0);
+            }
+        }
+    }
+
+    ID3D11ShaderResourceView* view = nullptr;
+    if (!CreateView(texture, resized, &view)) {
+        resized->Release();
+        std::cerr << "Failed to create view for streamed texture " << texture.mPaths[0] << std::endl;
+        return;
+    }
+
+    texture.mTextureView->Release();
+    texture.mTexture->Release();
+    texture.mTexture = resized;
+    texture.mTextureView = view;
+    texture.mResidentMip = firstMip;
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <d3d11.h>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Image.h"
+#include "TextureSettings.h"
+
+class AsyncFileReader;
+class Camera;
+class FileWatcher;
+class Texture;
+class TextureArray;
+class TextureCache;
+class ThreadPool;
+
+// A texture whose GPU copy holds only a suffix of its mip chain. The CPU levels stay
+// available (from the cooked cache they are just mapped pages), so levels can be
+// dropped and brought back without decoding again. An array texture streams all its
+// slices together, sharing one resident mip.
+class StreamedTexture
+{
+public:
+	~StreamedTexture();
+
+	// Placeholder view until the first mips are resident
+	ID3D11ShaderResourceView* GetTextureView() const;
+
+	// World-space bounding sphere of what this texture is drawn on, used for screen coverage
+	void SetBounds(const glm::vec3& center, float radius);
+
+	bool IsLoaded() const { return !mSlices.empty(); }
+	int GetLevelCount() const { return mSlices.empty() ? 0 : static_cast<int>(mSlices[0].size()); }
+	int GetSliceCount() const { return static_cast<int>(mPaths.size()); }
+	int GetResidentMip() const { return mResidentMip; }
+	size_t GetResidentBytes() const;
+
+private:
+	friend class TextureStreamer;
+
+	size_t GetBytesFrom(int mip) const;
+	// the given level of every slice
+	size_t GetLevelBytes(int mip) const;
+	const ImageData& GetLevel(int mip) const { return mSlices[0][mip]; }
+
+	std::vector<std::string> mPaths;	// one per slice
+	bool mArray = false;
+	TextureSettings mSettings;
+	TextureCache* mCache = nullptr;
+	ID3D11ShaderResourceView* mPlaceholder = nullptr;
+	// one entry per slice, valid while that slice is being decoded
+	std::vector<std::future<std::vector<ImageData>>> mDecodes;
+	std::vector<std::vector<ImageData>> mSlices;
+
+	ID3D11Texture2D* mTexture = nullptr;
+	ID3D11ShaderResourceView* mTextureView = nullptr;
+	int mResidentMip = 0;
+	// coarsest level that may become the top of the GPU texture
+	int mTailMip = 0;
+	int mDesiredMip = 0;
+	float mScreenCoverage = 0.0f;
+
+	glm::vec3 mCenter = glm::vec3(0.0f);
+	float mRadius = 1.0f;
+};
+
+// Streams mip levels in and out of GPU memory. New textures show their small tail mips
+// as soon as they are decoded, then gain one level per frame until they reach the level
+// their projected screen size calls for. When the total goes over the budget, the top
+// levels of the least visible textures are evicted first.
+class TextureStreamer
+{
+public:
+	TextureStreamer(ID3D11Device* dev, size_t budgetBytes, ThreadPool& pool, AsyncFileReader& reader);
+	TextureStreamer(ID3D11Device* dev, size_t budgetBytes, ThreadPool& pool);
+	TextureStreamer(ID3D11Device* dev, size_t budgetBytes);
+	~TextureStreamer();
+
+	std::shared_ptr<StreamedTexture> Load(const std::string& path, const TextureSettings& settings = TextureSettings(), TextureCache* cache = nullptr);
+	// Slice i is paths[i]; every file must decode to the same size, level count and format.
+	// Bound as a Texture2DArray, the placeholder included.
+	std::shared_ptr<StreamedTexture> LoadArray(const std::vector<std::string>& paths, const TextureSettings& settings = TextureSettings(), TextureCache* cache = nullptr);
+
+	// A changed file is decoded again on the pool; its texture drops back to the tail mips
+	// once the new levels are in and then streams up as usual. A failed reload keeps the
+	// old levels.
+	void EnableHotReload();
+
+	// Call once per frame on the render thread
+	void Update(ID3D11DeviceContext* devcon, const Camera& camera, float viewportHeight);
+
+	void SetBudget(size_t budgetBytes) { mBudgetBytes = budgetBytes; }
+	// Caps the bytes uploaded per frame so streaming in never causes a hitch
+	void SetUploadLimit(size_t bytesPerFrame) { mUploadLimit = bytesPerFrame; }
+	size_t GetResidentBytes() const;
+
+private:
+	std::shared_ptr<StreamedTexture> Add(const std::vector<std::string>& paths, bool array, const TextureSettings& settings, TextureCache* cache);
+	void Decode(StreamedTexture& texture, size_t slice);
+	void Watch(const StreamedTexture& texture);
+	void ReloadChanged();
+	void FinishLoad(StreamedTexture& texture);
+	bool CreateView(StreamedTexture& texture, ID3D11Texture2D* resource, ID3D11ShaderResourceView** view);
+	void ComputeDesiredMip(StreamedTexture& texture, const glm::mat4& view, const glm::mat4& projection, const glm::vec4 planes[6], float viewportHeight);
+	void EnforceBudget();
+	void MakeResident(ID3D11DeviceContext* devcon, StreamedTexture& texture, int firstMip);
+
+private:
+	ID3D11Device* mDevice;
+	ThreadPool& mPool;
+	AsyncFileReader& mReader;
+	size_t mBudgetBytes;
+	size_t mUploadLimit = 8 * 1024 * 1024;
+	std::unique_ptr<Texture> mPlaceholder;
+	std::unique_ptr<TextureArray> mPlaceholderArray;
+	std::unique_ptr<FileWatcher> mWatcher;
+	std::vector<std::shared_ptr<StreamedTexture>> mTextures;
+};
@@ -0,0 +1,107 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    mWorkers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+        mWorkers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mCondition.notify_all();
+    for (std::thread& worker : mWorkers)
+        worker.join();
+}
+
+ThreadPool& ThreadPool::Default()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& body)
+{
+    if (count == 0)
+        return;
+
+    struct State {
+        std::atomic<size_t> next{ 0 };
+        size_t done = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto state = std::make_shared<State>();
+
+    // Helpers that start after all indices are claimed return without touching body,
+    // so the caller only waits for work that is actually running.
+    auto work = [state, &body, count]() {
+        for (;;) {
+            size_t i = state->next.fetch_add(1);
+            if (i >= count)
+                return;
+
+            std::exception_ptr error;
+            try {
+                body(i);
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (error && !state->error)
+                state->error = error;
+            if (++state->done == count)
+                state->finished.notify_all();
+        }
+    };
+
+    size_t helpers = std::min(mWorkers.size(), count - 1);
+    for (size_t i = 0; i < helpers; ++i)
+        Enqueue(work);
+    work();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&]() { return state->done == count; });
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
+
+void ThreadPool::Enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTasks.push(std::move(task));
+    }
+    mCondition.notify_one();
+}
+
+void ThreadPool::WorkerLoop()
+{
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this]() { return mStopping || !mTasks.empty(); });
+            // drain the queue before exiting so no future is left without a value
+            if (mTasks.empty())
+                return;
+            task = std::move(mTasks.front());
+            mTasks.pop();
+        }
+        task();
+    }
+}
\ No newline at end of file
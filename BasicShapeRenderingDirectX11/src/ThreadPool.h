@@ -0,0 +1,50 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+	// threadCount == 0 uses one worker per hardware thread
+	explicit ThreadPool(size_t threadCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	template <typename F>
+	auto Submit(F&& task) -> std::future<decltype(task())>
+	{
+		using Result = decltype(task());
+		auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+		std::future<Result> result = packaged->get_future();
+		Enqueue([packaged]() { (*packaged)(); });
+		return result;
+	}
+
+	// Runs body(i) for every i in [0, count) and returns once all are done. The calling
+	// thread takes part, so this is safe to use from inside another pool task.
+	void ParallelFor(size_t count, const std::function<void(size_t)>& body);
+
+	size_t GetThreadCount() const { return mWorkers.size(); }
+
+	// Process-wide pool shared by the asset pipeline
+	static ThreadPool& Default();
+
+private:
+	void Enqueue(std::function<void()> task);
+	void WorkerLoop();
+
+private:
+	std::vector<std::thread> mWorkers;
+	std::queue<std::function<void()>> mTasks;
+	std::mutex mMutex;
+	std::condition_variable mCondition;
+	bool mStopping = false;
+};
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include "UploadRing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+const UINT UploadRing::kAlignment;
+
+namespace {
+
+// the most a single constant buffer binding can see
+const UINT kMaxBindBytes = D3D11_REQ_CONSTANT_BUFFER_ELEMENT_COUNT * 16;
+
+UINT RingSize(UINT sizeBytes)
+{
+    UINT size = (sizeBytes + UploadRing::kAlignment - 1) & ~(UploadRing::kAlignment - 1);
+    return std::max(size, kMaxBindBytes);
+}
+
+} // namespace
+
+UploadRing::UploadRing(ID3D11Device* dev, ID3D11DeviceContext* devcon, UINT sizeBytes, UINT framesInFlight)
+    : mDevice(dev), mContext(devcon), mRing(RingSize(sizeBytes), framesInFlight, kAlignment),
+      mFences(framesInFlight > 0 ? framesInFlight : 1, nullptr)
+{
+    // offsets and no-overwrite maps on constant buffers both arrived with Direct3D 11.1
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+    HRESULT hr = dev->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
+    if (SUCCEEDED(hr) && options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer) {
+        if (FAILED(devcon->QueryInterface(__uuidof(ID3D11DeviceContext1), reinterpret_cast<void**>(&mContext1))))
+            mContext1 = nullptr;
+    }
+
+    mShadow.resize(mRing.GetSize());
+    if (!mContext1) {
+        mNeedsDiscard = false;
+        return;
+    }
+
+    D3D11_BUFFER_DESC desc = {};
+    desc.ByteWidth = mRing.GetSize();
+    desc.Usage = D3D11_USAGE_DYNAMIC;
+    desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    hr = dev->CreateBuffer(&desc, nullptr, &mBuffer);
+    if (FAILED(hr)) {
+        mContext1->Release();
+        throw std::runtime_error("Failed to create upload ring buffer");
+    }
+
+    D3D11_QUERY_DESC queryDesc = {};
+    queryDesc.Query = D3D11_QUERY_EVENT;
+    for (ID3D11Query*& fence : mFences) {
+        hr = dev->CreateQuery(&queryDesc, &fence);
+        if (FAILED(hr)) {
+            for (ID3D11Query* created : mFences) {
+                if (created)
+                    created->Release();
+            }
+            mBuffer->Release();
+            mContext1->Release();
+            throw std::runtime_error("Failed to create upload ring fence");
+        }
+    }
+}
+
+UploadRing::~UploadRing()
+{
+    for (ID3D11Query* fence : mFences) {
+        if (fence)
+            fence->Release();
+    }
+    for (auto& buffers : mSlotBuffers) {
+        for (ID3D11Buffer* buffer : buffers) {
+            if (buffer)
+                buffer->Release();
+        }
+    }
+    if (mBuffer)
+        mBuffer->Release();
+    if (mContext1)
+        mContext1->Release();
+}
+
+void UploadRing::BeginFrame()
+{
+    // staged uploads are copied out when bound, so nothing outlives the frame
+    if (!mContext1) {
+        mRing.Reset();
+        return;
+    }
+
+    mRing.BeginFrame([this](size_t frame, bool wait) {
+        BOOL done = FALSE;
+        if (!wait)
+            return mContext->GetData(mFences[frame], &done, sizeof(done), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+        // the GPU is a frame or more behind, give the core back while it catches up
+        while (mContext->GetData(mFences[frame], &done, sizeof(done), 0) != S_OK)
+            std::this_thread::yield();
+        return true;
+    });
+}
+
+void UploadRing::EndFrame()
+{
+    if (!mContext1)
+        return;
+
+    mContext->End(mFences[mRing.EndFrame()]);
+}
+
+UploadRing::Allocation UploadRing::Upload(const void* data, UINT size)
+{
+    UINT alignedSize = (size + kAlignment - 1) & ~(kAlignment - 1);
+    if (size == 0 || alignedSize > kMaxBindBytes)
+        throw std::runtime_error("Upload does not fit in a constant buffer binding");
+
+    RingAllocator::Allocation reserved = mRing.Allocate(size);
+    Allocation allocation;
+    allocation.buffer = mBuffer;
+    allocation.offset = reserved.offset;
+    allocation.size = reserved.size;
+    allocation.generation = reserved.generation;
+    std::memcpy(mShadow.data() + allocation.offset, data, size);
+    if (!mContext1)
+        return allocation;
+
+    // The GPU still owns the space we need, so rename the buffer instead of waiting. Older
+    // frames keep reading the old copy; this frame's uploads are carried over from the
+    // shadow so its allocations stay valid.
+    D3D11_MAP mapType = reserved.discard || mNeedsDiscard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+    mNeedsDiscard = false;
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    HRESULT hr = mContext->Map(mBuffer, 0, mapType, 0, &mapped);
+    if (FAILED(hr))
+        throw std::runtime_error("Failed to map upload ring buffer");
+    unsigned char* dest = static_cast<unsigned char*>(mapped.pData);
+    if (mapType == D3D11_MAP_WRITE_DISCARD) {
+        // the frame's span may wrap past the end
+        UINT start = mRing.GetFrameStart();
+        UINT frameBytes = mRing.GetFrameBytes();
+        UINT firstPart = std::min(frameBytes, mRing.GetSize() - start);
+        std::memcpy(dest + start, mShadow.data() + start, firstPart);
+        std::memcpy(dest, mShadow.data(), frameBytes - firstPart);
+    } else {
+        std::memcpy(dest + allocation.offset, data, size);
+    }
+    mContext->Unmap(mBuffer, 0);
+    return allocation;
+}
+
+void UploadRing::BindVS(UINT slot, const Allocation& allocation)
+{
+    Bind(false, slot, allocation);
+}
+
+void UploadRing::BindPS(UINT slot, const Allocation& allocation)
+{
+    Bind(true, slot, allocation);
+}
+
+void UploadRing::Bind(bool pixelStage, UINT slot, const Allocation& allocation)
+{
+    mRing.Validate(allocation.generation);
+
+    if (mContext1) {
+        UINT firstConstant = allocation.offset / 16;
+        UINT numConstants = allocation.size / 16;
+        if (pixelStage)
+            mContext1->PSSetConstantBuffers1(slot, 1, &mBuffer, &firstConstant, &numConstants);
+        else
+            mContext1->VSSetConstantBuffers1(slot, 1, &mBuffer, &firstConstant, &numConstants);
+        return;
+    }
+
+    std::vector<ID3D11Buffer*>& buffers = mSlotBuffers[pixelStage];
+    std::vector<UINT>& sizes = mSlotSizes[pixelStage];
+    if (slot >= buffers.size()) {
+        buffers.resize(slot + 1, nullptr);
+        sizes.resize(slot + 1, 0);
+    }
+    if (sizes[slot] < allocation.size) {
+        if (buffers[slot])
+            buffers[slot]->Release();
+        buffers[slot] = nullptr;
+        sizes[slot] = 0;
+
+        D3D11_BUFFER_DESC desc = {};
+        desc.ByteWidth = allocation.size;
+        desc.Usage = D3D11_USAGE_DYNAMIC;
+        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        HRESULT hr = mDevice->CreateBuffer(&desc, nullptr, &buffers[slot]);
+        if (FAILED(hr))
+            throw std::runtime_error("Failed to create constant buffer");
+        sizes[slot] = allocation.size;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    HRESULT hr = mContext->Map(buffers[slot], 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+    if (FAILED(hr))
+        throw std::runtime_error("Failed to map constant buffer");
+    std::memcpy(mapped.pData, mShadow.data() + allocation.offset, allocation.size);
+    mContext->Unmap(buffers[slot], 0);
+
+    if (pixelStage)
+        mContext->PSSetConstantBuffers(slot, 1, &buffers[slot]);
+    else
+        mContext->VSSetConstantBuffers(slot, 1, &buffers[slot]);
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <d3d11_1.h>
+#include <vector>
+#include "RingAllocator.h"
+
+// Linear allocator over one large dynamic constant buffer for data that lives a single frame.
+// Every upload is a Map(NO_OVERWRITE) into space the GPU is done with, and draws bind their
+// slice with VSSetConstantBuffers1 offsets, so per-object constants cost no buffer renames.
+// Each frame ends with an event query; once it signals, that frame's space is handed out
+// again. When the ring is too full for an upload it maps with DISCARD, letting the driver
+// keep the old contents alive for the frames still reading them, and rewrites the current
+// frame's uploads from a CPU shadow so they stay valid. Only a single frame that outgrows
+// the ring starts over from 0; allocations made before that throw when bound. The offset
+// bookkeeping is a RingAllocator, which bench/RingAllocatorTest.cpp exercises on its own.
+//
+// Without Direct3D 11.1 constant buffer offsetting the uploads stay in the shadow and each
+// bind is copied into a small per-slot buffer with DISCARD, which is the old behaviour.
+// Use from the render thread.
+class UploadRing
+{
+public:
+	// Constant buffer offsets are counted in 16 constants of 16 bytes
+	static const UINT kAlignment = 256;
+
+	struct Allocation {
+		ID3D11Buffer* buffer = nullptr;
+		UINT offset = 0;	// bytes, a multiple of kAlignment
+		UINT size = 0;		// bytes, rounded up to kAlignment
+		UINT generation = 0;	// ring restarts before this upload
+	};
+
+	UploadRing(ID3D11Device* dev, ID3D11DeviceContext* devcon, UINT sizeBytes = 1u << 20, UINT framesInFlight = 3);
+	~UploadRing();
+
+	UploadRing(const UploadRing&) = delete;
+	UploadRing& operator=(const UploadRing&) = delete;
+
+	// Retires frames the GPU has finished. Waits when all framesInFlight are still queued.
+	void BeginFrame();
+	// Marks everything uploaded since BeginFrame as belonging to this frame
+	void EndFrame();
+
+	Allocation Upload(const void* data, UINT size);
+	template <typename T>
+	Allocation Upload(const T& constants)
+	{
+		return Upload(&constants, sizeof(T));
+	}
+
+	void BindVS(UINT slot, const Allocation& allocation);
+	void BindPS(UINT slot, const Allocation& allocation);
+
+	bool UsesOffsets() const { return mContext1 != nullptr; }
+	UINT GetSize() const { return mRing.GetSize(); }
+	// Bytes still reserved by frames the GPU may be reading, including this one
+	UINT GetUsedBytes() const { return mRing.GetUsedBytes(); }
+	UINT GetDiscardCount() const { return mRing.GetDiscardCount(); }
+
+private:
+	void Bind(bool pixelStage, UINT slot, const Allocation& allocation);
+
+private:
+	ID3D11Device* mDevice;
+	ID3D11DeviceContext* mContext;
+	ID3D11DeviceContext1* mContext1 = nullptr;
+	ID3D11Buffer* mBuffer = nullptr;
+
+	RingAllocator mRing;
+	bool mNeedsDiscard = true;	// a new buffer's first map
+	std::vector<ID3D11Query*> mFences;	// one per frame slot of mRing
+
+	// CPU copy of the ring; the fallback path binds straight from it
+	std::vector<unsigned char> mShadow;
+	std::vector<ID3D11Buffer*> mSlotBuffers[2];
+	std::vector<UINT> mSlotSizes[2];
+};
@@ -1,4 +1,6 @@
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <vector>
 #include <GLFW/glfw3.h>
 #define GLFW_EXPOSE_NATIVE_WIN32
@@ -9,8 +11,16 @@
 #include <DirectXMath.h>
 #include <dxgi.h>
 #include "Shader.h"
-#include "Buffer.h"
+#include "BufferManager.h"
+#include "ClusterCuller.h"
+#include "LodSelector.h"
+#include "ShapeGenerator.h"
 #include "Texture.h"
+#include "TextureCache.h"
+#include "TextureArray.h"
+#include "TextureStreamer.h"
+#include "TextureGenerator.h"
+#include "UploadRing.h"
 #include "Camera.h"
 
 // define the screen resolution
@@ -49,6 +59,20 @@ DirectX::XMMATRIX ConvertMat4ToXMMATRIX(const glm::mat4& mat)
     return DirectX::XMLoadFloat4x4(&xmFloat4x4);
 }
 
+// Stand-ins for the two texture assets, built on the CPU with no disk I/O
+std::vector<std::vector<ImageData>> GenerateTextures(const TextureSettings& settings)
+{
+    TextureGenerator::TileParams tiles;
+    tiles.staggered = true;
+    TextureGenerator::GrillParams grill;
+    grill.background = { 0, 0, 0, 0 };
+
+    std::vector<std::vector<ImageData>> slices;
+    slices.push_back(Texture::BuildLevels(TextureGenerator::Tiles(1024, 1024, tiles), settings));
+    slices.push_back(Texture::BuildLevels(TextureGenerator::Grill(1024, 1024, grill), settings));
+    return slices;
+}
+
 // Forward declarations
 void InitD3D(HWND hWnd);
 void CleanUpDirectX();
@@ -73,6 +97,8 @@ struct VS_INPUT
 {
     float3 Pos : POSITION;
     float2 Tex : TEXCOORD0;
+    float3 Normal : NORMAL;
+    float4 Tangent : TANGENT;   // w is the bitangent sign
 };
 
 struct PS_INPUT
@@ -102,14 +128,13 @@ struct PS_INPUT
     float4 Pos : SV_POSITION;
     float2 Tex : TEXCOORD0;
 };
-Texture2D shaderTexture;
-Texture2D shaderTexture2;
+Texture2DArray shaderTextures;
 SamplerState SampleType;
 
 float4 main(PS_INPUT input) : SV_Target
 {
-    float4 color1 = shaderTexture.Sample(SampleType, input.Tex);
-    float4 color2 = shaderTexture2.Sample(SampleType, input.Tex);
+    float4 color1 = shaderTextures.Sample(SampleType, float3(input.Tex, 0));
+    float4 color2 = shaderTextures.Sample(SampleType, float3(input.Tex, 1));
     //return lerp(color1, color2, 0.5) * color; // Blend two textures
     return lerp(color1, color2, 0.5);
 }
@@ -144,28 +169,75 @@ int main() {
     Shader* shader = new Shader(vertexShaderSource, pixelShaderSource, dev);
     InitGraphics(shader);
 
-    // create a triangle using the VERTEX struct
-    std::vector<float> vertices = {
-        // Position             // Texture Coords
-        -0.5f, -0.5f, 0.0f,     0.0f, 1.0f,
-        -0.5f,  0.5f, 0.0f,     0.0f, 0.0f,
-         0.5f,  0.5f, 0.0f,     1.0f, 0.0f,
-         0.5f, -0.5f, 0.0f,     1.0f, 1.0f
+    // meshes are sub-allocated from shared vertex and index buffers
+    std::unique_ptr<BufferManager> buffers(new BufferManager(dev, devcon));
+    std::unique_ptr<UploadRing> uploadRing(new UploadRing(dev, devcon));
+
+    const size_t floatsPerVertex = ShapeGenerator::kFloatsPerVertex;
+    const UINT vertexStride = static_cast<UINT>(sizeof(float) * floatsPerVertex);
+    MeshData quadData = ShapeGenerator::Quad();
+
+    // the index buffer holds the triangles meshlet by meshlet, so visible clusters draw as ranges of it
+    MeshletMesh quadMeshlets = MeshletBuilder::Build(quadData.vertices, floatsPerVertex, quadData.indices);
+    std::vector<unsigned int> meshletIndices = MeshletBuilder::FlattenIndices(quadMeshlets);
+    Mesh quad = buffers->CreateMesh(quadData.vertices.data(), static_cast<UINT>(quadData.vertices.size() / floatsPerVertex), vertexStride,
+        meshletIndices.data(), static_cast<UINT>(meshletIndices.size()));
+    std::vector<ClusterCuller::Range> visibleRanges;
+
+    // a row of generated shapes below the quad, each with every level of detail in one index range
+    struct Shape {
+        LodChain lods;
+        Mesh mesh;
+        glm::vec3 position;
     };
+    std::vector<MeshData> shapeData;
+    shapeData.push_back(ShapeGenerator::Box(1.0f, 1.0f, 1.0f, 8));
+    shapeData.push_back(ShapeGenerator::Sphere(0.6f, 64, 32));
+    shapeData.push_back(ShapeGenerator::Cylinder(0.5f, 1.0f, 64, 8));
+    shapeData.push_back(ShapeGenerator::Torus(0.45f, 0.18f, 64, 32));
+    shapeData.push_back(ShapeGenerator::Capsule(0.35f, 0.6f, 64, 16));
+    std::vector<Shape> shapes;
+    for (size_t i = 0; i < shapeData.size(); ++i) {
+        Shape shape;
+        shape.lods = MeshSimplifier::BuildLodChain(shapeData[i].vertices, floatsPerVertex, shapeData[i].indices, 0.02f);
+        shape.mesh = buffers->CreateMesh(shapeData[i].vertices.data(), static_cast<UINT>(shapeData[i].vertices.size() / floatsPerVertex), vertexStride,
+            shape.lods.indices.data(), static_cast<UINT>(shape.lods.indices.size()));
+        shape.position = glm::vec3(static_cast<float>(i) - 2.0f, -1.1f, -1.5f);
+        shapes.push_back(shape);
+    }
 
-    VertexBuffer* vertexBuffer = new VertexBuffer(vertices, dev);
-
-    std::vector<unsigned int> indices = {
-        0, 1, 2,
-        2, 3, 0
-    };
-
-    IndexBuffer* indexBuffer = new IndexBuffer(indices, dev);
-
-    std::string woodTileTexture = "Assets/Wood_Tiles.jpg";
-    std::string metalGrillTexture = "Assets/Metal_Grill.jpg";
-    Texture texture = Texture(woodTileTexture, dev);
-    Texture texture2 = Texture(metalGrillTexture, dev);
+    TextureSettings textureSettings;
+    textureSettings.compression = TextureCompression::Auto;
+
+    // cooked copies of the assets, so warm starts skip JPEG decoding entirely
+    TextureCache textureCache("TextureCache");
+
+    // both textures share one array, slice 0 and slice 1, so a single bind covers every draw
+    std::vector<std::string> texturePaths = { "Assets/Wood_Tiles.jpg", "Assets/Metal_Grill.jpg" };
+    bool assetsPresent = true;
+    for (const std::string& path : texturePaths)
+        assetsPresent = assetsPresent && std::ifstream(path).good();
+
+    TextureStreamer textureStreamer(dev, 64 * 1024 * 1024);
+    std::shared_ptr<StreamedTexture> streamedTextures;
+    std::unique_ptr<TextureArray> generatedTextures;
+    if (assetsPresent) {
+        // decoded in parallel, the placeholder is drawn until their first mips are resident
+        streamedTextures = textureStreamer.LoadArray(texturePaths, textureSettings, &textureCache);
+        // drawn on the unit quad at the origin
+        streamedTextures->SetBounds(glm::vec3(0.0f), 0.71f);
+        // saving either image in an editor shows up in the running app
+        try {
+            textureStreamer.EnableHotReload();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Texture hot reload unavailable: " << e.what() << std::endl;
+        }
+    }
+    else {
+        std::cerr << "Texture assets not found, using generated textures" << std::endl;
+        generatedTextures.reset(new TextureArray(GenerateTextures(textureSettings), dev));
+    }
 
     D3D11_SAMPLER_DESC sampDesc;
     ZeroMemory(&sampDesc, sizeof(sampDesc));
@@ -193,6 +265,10 @@ int main() {
         processInput(window);
         glfwPollEvents();
 
+        // upload finished decodes, pick up textures edited on disk and move mip residency
+        // towards what the camera needs
+        textureStreamer.Update(devcon, camera, (float)SCREEN_HEIGHT);
+
         // render
         // ------
         // Clear the screen
@@ -202,44 +278,39 @@ int main() {
 
         float redValue = sin(currentFrame) / 2.0f + 0.5f;
 
-        // Update constant buffer with current time
-        D3D11_MAPPED_SUBRESOURCE psMappedResource, vsMappedResource;
+        // per-frame constants are sub-allocated from the upload ring rather than renaming a buffer per draw
+        uploadRing->BeginFrame();
 
         // Vertex Shader
-        devcon->Map(shader->GetVSConstantBuffer(), 0, D3D11_MAP_WRITE_DISCARD, 0, &vsMappedResource);
-
-        Shader::VSConstantBuffer* vsCb = (Shader::VSConstantBuffer*)vsMappedResource.pData;
+        Shader::VSConstantBuffer vsCb;
 
-       // vsCb->projection = camera.GetCameraProjection();
+       // vsCb.projection = camera.GetCameraProjection();
         DirectX::XMMATRIX dxMatrix = ConvertMat4ToXMMATRIX(camera.GetCameraProjection());
-        vsCb->projection = dxMatrix;
+        vsCb.projection = dxMatrix;
         dxMatrix = ConvertMat4ToXMMATRIX(camera.GetCameraView());
-        //vsCb->view = camera.GetCameraView();
-        vsCb->view = dxMatrix;
+        //vsCb.view = camera.GetCameraView();
+        vsCb.view = dxMatrix;
 
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
         model = glm::rotate(model, glm::radians(0.0f), glm::vec3(1.0f, 0.3f, 0.5f));
 
         dxMatrix = ConvertMat4ToXMMATRIX(model);
-        vsCb->model = dxMatrix;
+        vsCb.model = dxMatrix;
 
-        devcon->Unmap(shader->GetVSConstantBuffer(), 0);
+        // cull the quad's clusters against the camera, seen from the quad's own space
+        glm::vec3 localCamera = glm::vec3(glm::inverse(model) * glm::vec4(camera.GetCameraPosition(), 1.0f));
+        ClusterCuller::View cullView(camera.GetCameraProjection() * camera.GetCameraView() * model, localCamera);
+        ClusterCuller::CullRanges(quadMeshlets, cullView, visibleRanges);
+
+        UploadRing::Allocation vsConstants = uploadRing->Upload(vsCb);
 
         // Pixel Shader
-        devcon->Map(shader->GetPSConstantBuffer(), 0, D3D11_MAP_WRITE_DISCARD, 0, &psMappedResource);
-        Shader::PSConstantBuffer* psCb = (Shader::PSConstantBuffer*)psMappedResource.pData;
-        psCb->color = { redValue, 0.0f, 0.0f, 1.0f };
-        devcon->Unmap(shader->GetPSConstantBuffer(), 0);
+        Shader::PSConstantBuffer psCb;
+        psCb.color = { redValue, 0.0f, 0.0f, 1.0f };
+        UploadRing::Allocation psConstants = uploadRing->Upload(psCb);
 
         // do 3D rendering on the back buffer here
-        // Set vertex buffer
-        UINT stride = sizeof(float) * 5;
-        UINT offset = 0;
-        ID3D11Buffer* pVBuffer = vertexBuffer->GetVertexBuffer();
-        devcon->IASetVertexBuffers(0, 1, &pVBuffer, &stride, &offset);
-        devcon->IASetIndexBuffer(indexBuffer->GetIndexBuffer(), DXGI_FORMAT_R32_UINT, 0);
-
         // Set primitive topology
         devcon->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
@@ -247,28 +318,45 @@ int main() {
         devcon->VSSetShader(shader->GetVertexShader(), nullptr, 0);
         devcon->PSSetShader(shader->GetPixelShader(), nullptr, 0);
 
-        ID3D11ShaderResourceView* textureView = texture.GetTextureView();
+        ID3D11ShaderResourceView* textureView = streamedTextures ? streamedTextures->GetTextureView() : generatedTextures->GetTextureView();
         devcon->PSSetShaderResources(0, 1, &textureView);
-        ID3D11ShaderResourceView* textureView2 = texture2.GetTextureView();
-        devcon->PSSetShaderResources(1, 1, &textureView2);
 
         devcon->PSSetSamplers(0, 1, &samplerState);
 
-        // Set VS constant buffer
-        ID3D11Buffer* vsCBuffer = shader->GetVSConstantBuffer();
-        devcon->VSSetConstantBuffers(0, 1, &vsCBuffer);
-
-        // Set PS constant buffer
-        ID3D11Buffer* psCBuffer = shader->GetPSConstantBuffer();
-        devcon->PSSetConstantBuffers(0, 1, &psCBuffer);
+        // Set VS and PS constant buffers
+        uploadRing->BindVS(0, vsConstants);
+        uploadRing->BindPS(0, psConstants);
+
+        // binds the shared vertex and index buffers if needed and draws the visible clusters
+        for (const ClusterCuller::Range& range : visibleRanges)
+            buffers->DrawRange(quad, range.firstIndex, range.indexCount);
+
+        // each shape draws the coarsest level that stays within a pixel of the full mesh
+        float projectionScale = LodSelector::GetProjectionScale(camera.GetCameraProjection(), static_cast<float>(SCREEN_HEIGHT));
+        for (const Shape& shape : shapes) {
+            glm::mat4 shapeModel = glm::translate(glm::mat4(1.0f), shape.position);
+            shapeModel = glm::rotate(shapeModel, currentFrame * 0.5f, glm::vec3(0.3f, 1.0f, 0.0f));
+            shapeModel = glm::scale(shapeModel, glm::vec3(0.4f));
+            glm::vec3 shapeCamera = glm::vec3(glm::inverse(shapeModel) * glm::vec4(camera.GetCameraPosition(), 1.0f));
+            const LodLevel& level = shape.lods.levels[LodSelector::SelectLevel(shape.lods, shapeCamera, projectionScale)];
+
+            vsCb.model = ConvertMat4ToXMMATRIX(shapeModel);
+            uploadRing->BindVS(0, uploadRing->Upload(vsCb));
+            buffers->DrawRange(shape.mesh, level.firstIndex, level.indexCount);
+        }
 
-        devcon->DrawIndexed(indexBuffer->GetIndicesSize(), 0, 0);
+        uploadRing->EndFrame();
 
         // switch the back buffer and the front buffer
         swapchain->Present(0, 0);
     }
 
     // Clean up DirectX
+    buffers->FreeMesh(quad);
+    for (Shape& shape : shapes)
+        buffers->FreeMesh(shape.mesh);
+    buffers.reset();
+    uploadRing.reset();
     shader->GetVertexShader()->Release();
     shader->GetPixelShader()->Release();
     CleanUpDirectX();
@@ -372,7 +460,9 @@ void InitGraphics(Shader* shader)
     // Define the input layout
     D3D11_INPUT_ELEMENT_DESC layout[] = {
         { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, sizeof(float) * 3, D3D11_INPUT_PER_VERTEX_DATA, 0}
+        { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, sizeof(float) * 3, D3D11_INPUT_PER_VERTEX_DATA, 0},
+        { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, sizeof(float) * 5, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "TANGENT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, sizeof(float) * 8, D3D11_INPUT_PER_VERTEX_DATA, 0 }
     };
 
     HRESULT hr = dev->CreateInputLayout(layout, ARRAYSIZE(layout), shader->GetVSBlob()->GetBufferPointer(), shader->GetVSBlob()->GetBufferSize(), &pLayout);